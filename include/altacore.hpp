@@ -12,6 +12,13 @@
 #include "altacore/errors.hpp"
 #include "altacore/timing.hpp"
 #include "altacore/logging.hpp"
+#include "altacore/visitor.hpp"
+#include "altacore/serialization.hpp"
+#include "altacore/ast-cache.hpp"
+#include "altacore/det-snapshot.hpp"
+#include "altacore/memory.hpp"
+#include "altacore/import-graph.hpp"
+#include "altacore/concurrency.hpp"
 
 namespace AltaCore {
   void registerGlobalAttributes();
@@ -0,0 +1,92 @@
+#ifndef ALTACORE_AST_CACHE_HPP
+#define ALTACORE_AST_CACHE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cinttypes>
+#include "fs.hpp"
+#include "simple-map.hpp"
+#include "serialization.hpp"
+
+namespace AltaCore {
+  namespace AST {
+    class RootNode;
+  };
+  namespace Parser {
+    class PrepoExpression;
+  };
+  namespace ASTCache {
+    using Definitions = ALTACORE_MAP<std::string, Parser::PrepoExpression>;
+
+    using CorruptCacheError = Serialization::FormatError;
+
+    /**
+     * Identifies a single parse of a module: the same source file, unmodified,
+     * parsed with the same preprocessor definitions, always produces the same AST
+     */
+    struct CacheKey {
+      std::string path;
+      int64_t modificationTime = 0;
+      uint64_t contentHash = 0;
+      uint64_t definitionsHash = 0;
+
+      CacheKey() {};
+      CacheKey(Filesystem::Path modulePath, const std::string& source, const Definitions& definitions);
+
+      bool operator ==(const CacheKey& other) const;
+    };
+
+    /**
+     * A module imported while parsing another one, along with the definitions
+     * that were in effect at that point (i.e. the ones it was parsed with)
+     */
+    struct ImportRecord {
+      std::string request;
+      std::shared_ptr<Definitions> definitions;
+    };
+
+    /**
+     * Where `.altaast` files are kept
+     *
+     * Caching is disabled while this is an invalid (i.e. empty) path
+     */
+    extern Filesystem::Path cacheDirectory;
+
+    /**
+     * Encode a parsed module, along with the preprocessor definitions
+     * that were in effect once it finished parsing and the imports it made along the way
+     */
+    std::string serialize(const CacheKey& key, std::shared_ptr<AST::RootNode> root, const Definitions& definitions, const std::vector<ImportRecord>& imports);
+    /**
+     * Decode a buffer produced by `serialize`
+     *
+     * Throws a `CorruptCacheError` if the buffer is malformed or if it doesn't match `key`.
+     * If decoding succeeds, `definitions` is replaced with the definitions that were in effect
+     * once the module finished parsing and `imports` with the imports it made (in order);
+     * otherwise, they're left untouched.
+     */
+    std::shared_ptr<AST::RootNode> deserialize(const CacheKey& key, const char* data, size_t size, Definitions& definitions, std::vector<ImportRecord>& imports);
+
+    /**
+     * Where the cache entry for the given key lives (other kinds of per-module caches
+     * share the same directory and naming scheme, just with a different extension)
+     */
+    Filesystem::Path entryPath(const CacheKey& key, std::string extension = "altaast");
+    /**
+     * @brief Try to load a cached AST for the given key
+     *
+     * @return std::shared_ptr<AST::RootNode> The cached AST, or `nullptr` if there's no usable entry
+     */
+    std::shared_ptr<AST::RootNode> load(const CacheKey& key, Definitions& definitions, std::vector<ImportRecord>& imports);
+    /**
+     * @brief Save an AST for the given key, replacing any previous entry for the same module
+     *
+     * Failing to write the entry is not an error; the module will simply be parsed again next time.
+     */
+    void store(const CacheKey& key, std::shared_ptr<AST::RootNode> root, const Definitions& definitions, const std::vector<ImportRecord>& imports);
+  };
+};
+
+#endif // ALTACORE_AST_CACHE_HPP
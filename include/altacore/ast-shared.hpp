@@ -93,9 +93,8 @@ namespace AltaCore {
       "Parameter",
       "BlockNode",
       "FunctionDefinitionNode",
-      "LiteralExpressionNode",
       "ReturnDirectiveNode",
-      "IntgerLiteralNode",
+      "IntegerLiteralNode",
       "VariableDefinitionExpression",
       "Accessor",
       "Fetch",
@@ -134,7 +133,7 @@ namespace AltaCore {
       "UnaryOperation",
       "SizeofOperation",
       "FloatingPointLiteralNode",
-      "StructureDefinitionNode",
+      "StructureDefinitionStatement",
       "ExportStatement",
       "VariableDeclarationStatement",
       "AliasStatement",
@@ -7,6 +7,8 @@
 #include "../det/scope.hpp"
 #include <vector>
 #include "../fs.hpp"
+#include "../ast-cache.hpp"
+#include "../optional.hpp"
 
 namespace AltaCore {
   namespace AST {
@@ -18,11 +20,29 @@ namespace AltaCore {
 
         std::shared_ptr<DH::RootNode> info;
 
+        /**
+         * Identifies the parse that produced this AST (set by `Modules::parseModule`)
+         */
+        ALTACORE_OPTIONAL<ASTCache::CacheKey> cacheKey;
+
         RootNode();
         RootNode(std::vector<std::shared_ptr<StatementNode>> statements);
 
         void detail(Filesystem::Path filePath, std::string moduleName = "", std::shared_ptr<DET::Module> parent = nullptr);
         void detail(std::string filePath, std::string moduleName = "");
+        /**
+         * @brief Set this module up from its DET snapshot instead of detailing it
+         *
+         * Only does anything if `DETSnapshot::rehydrateImports` is on and there's a usable snapshot
+         * for `cacheKey` without any generic templates (those need to be detailed from source so they can
+         * be instantiated). Dependencies that haven't been detailed yet have to be rehydrated, too (so that
+         * modules are never detailed in a different order than they would be from source); if any of them
+         * can't be, neither is this one. `Modules::ImportGraph::detail` details dependencies first, so that
+         * only matters within import cycles there.
+         *
+         * @return Whether the module was rehydrated (or already detailed)
+         */
+        bool rehydrate(Filesystem::Path filePath, std::shared_ptr<DET::Module> parent = nullptr);
         ALTACORE_AST_VALIDATE;
     };
   };
@@ -0,0 +1,111 @@
+#ifndef ALTACORE_CONCURRENCY_HPP
+#define ALTACORE_CONCURRENCY_HPP
+
+#include <cstddef>
+#include <mutex>
+
+namespace AltaCore {
+  /**
+   * What makes it safe to detail several modules at once (see `Modules::ImportGraph::detail`)
+   *
+   * While modules are being detailed concurrently, every worker holds a `DetailingSection`, which
+   * gives it shared access to the DET. That's enough for anything that only touches the modules the
+   * worker is detailing (which no other worker can see) or that only reads modules that are already
+   * done. The rest falls into two groups:
+   *
+   *   * process-wide caches (interned types, cast/compatibility results, lookups, parent chains,
+   *     class hierarchy tables) are only read or filled while holding the `CacheLock`
+   *   * anything that changes what other workers might be looking at (invalidating those caches,
+   *     instantiating generics, detailing deferred function bodies, detailing a module that's not
+   *     in the graph) happens in an `ExclusiveSection`
+   *
+   * Exclusive sections wait for every other worker to reach a `safepoint` (workers only stop there,
+   * between top-level statements, when they're not in the middle of using anything another worker
+   * could change). None of this does anything (or costs anything beyond a flag check) unless
+   * concurrent detailing is `active`.
+   */
+  namespace Concurrency {
+    /**
+     * Whether modules are currently being detailed on more than one thread
+     */
+    bool active();
+
+    /**
+     * Turns concurrent detailing on for as long as it's alive.
+     * No other detailing may be in progress when it's created or destroyed.
+     */
+    class ConcurrentDetailing {
+      public:
+        ConcurrentDetailing(bool enable = true);
+        ~ConcurrentDetailing();
+
+        ConcurrentDetailing(const ConcurrentDetailing&) = delete;
+        ConcurrentDetailing& operator=(const ConcurrentDetailing&) = delete;
+
+      private:
+        bool enabled;
+    };
+
+    /**
+     * Shared access to the DET for a worker; held for as long as the worker is detailing
+     */
+    class DetailingSection {
+      public:
+        DetailingSection();
+        ~DetailingSection();
+
+        DetailingSection(const DetailingSection&) = delete;
+        DetailingSection& operator=(const DetailingSection&) = delete;
+
+      private:
+        bool engaged;
+    };
+
+    /**
+     * Exclusive access to the DET: waits until every other worker is at a safepoint
+     * and keeps them there until it's destroyed
+     *
+     * These can be nested. They can't be created while holding the `CacheLock` (that would
+     * deadlock with workers waiting on it), so that throws a `std::logic_error`.
+     */
+    class ExclusiveSection {
+      public:
+        ExclusiveSection();
+        ~ExclusiveSection();
+
+        ExclusiveSection(const ExclusiveSection&) = delete;
+        ExclusiveSection& operator=(const ExclusiveSection&) = delete;
+
+      private:
+        bool engaged;
+    };
+
+    /**
+     * Guards the process-wide DET caches. Recursive, since filling one cache often reads another.
+     *
+     * Only hold it for as long as it takes to read or update a cache; anything that could
+     * need an `ExclusiveSection` (i.e. most detailing) has to happen outside of it.
+     */
+    class CacheLock {
+      public:
+        CacheLock();
+        ~CacheLock();
+
+        CacheLock(const CacheLock&) = delete;
+        CacheLock& operator=(const CacheLock&) = delete;
+
+      private:
+        std::unique_lock<std::recursive_mutex> lock;
+    };
+
+    /**
+     * @brief Let any pending exclusive sections run
+     *
+     * Only call this where the current thread isn't holding on to anything another
+     * worker could change (e.g. references into caches or other modules' scopes).
+     */
+    void safepoint();
+  };
+};
+
+#endif // ALTACORE_CONCURRENCY_HPP
@@ -0,0 +1,99 @@
+#ifndef ALTACORE_DET_SNAPSHOT_HPP
+#define ALTACORE_DET_SNAPSHOT_HPP
+
+#include <memory>
+#include <string>
+#include <functional>
+#include <stdexcept>
+#include "fs.hpp"
+#include "ast-cache.hpp"
+#include "serialization.hpp"
+
+namespace AltaCore {
+  namespace DET {
+    class Module;
+  };
+
+  /**
+   * Precompiled module interfaces
+   *
+   * A snapshot captures everything an importer can see of a detailed module: its `exports`
+   * scope along with the classes, functions, variables, namespaces, aliases, and types
+   * reachable from it. Function bodies are not included; neither are detail handles
+   * or ASTs, so rehydrated modules can be imported and type-checked against, but not
+   * used to generate code for the module itself.
+   *
+   * Generic templates are recorded (so lookups still find them), but they can't be
+   * instantiated without their AST; see `hasGenericTemplates`.
+   */
+  namespace DETSnapshot {
+    using SnapshotError = Serialization::FormatError;
+
+    /**
+     * Thrown when a module's interface refers to something a snapshot can't represent
+     */
+    class UnsupportedInterfaceError: public std::runtime_error {
+      public:
+        UnsupportedInterfaceError(std::string what = "module interface can't be snapshotted"):
+          runtime_error(what)
+          {};
+    };
+
+    /**
+     * Used to look up the modules that a snapshotted module depends on
+     * (e.g. a lookup in the importer's module cache, or another snapshot)
+     */
+    using ModuleResolver = std::function<std::shared_ptr<DET::Module>(Filesystem::Path modulePath)>;
+    /**
+     * Called with a rehydrated module as soon as it's created (i.e. while it's still empty), before any
+     * of its dependencies are resolved. Dependencies in an import cycle with it can refer to it from then on.
+     */
+    using ModuleCallback = std::function<void(std::shared_ptr<DET::Module> module)>;
+
+    /**
+     * Whether imported modules should be rehydrated from their snapshots (when they have a
+     * usable one) instead of being detailed from source (see `AST::RootNode::rehydrate`).
+     * Detailing an imported module from source saves a snapshot for next time.
+     *
+     * Off by default, since rehydrated modules can't be used to generate code (e.g. this
+     * is meant for tools that only check the root module). Needs `ASTCache::cacheDirectory`.
+     */
+    extern bool rehydrateImports;
+
+    /**
+     * Encode the interface of a fully detailed module. `key` identifies
+     * the source the module was detailed from.
+     *
+     * Throws an `UnsupportedInterfaceError` if the interface can't be represented.
+     */
+    std::string serialize(std::shared_ptr<DET::Module> module, const ASTCache::CacheKey& key);
+    /**
+     * Rebuild a module from a snapshot produced by `serialize`
+     *
+     * Throws a `SnapshotError` if the snapshot is malformed, doesn't match `key`, or if
+     * any of the module's dependencies changed since the snapshot was taken.
+     */
+    std::shared_ptr<DET::Module> deserialize(const ASTCache::CacheKey& key, const char* data, size_t size, ModuleResolver resolveDependency, ModuleCallback created = nullptr);
+
+    /**
+     * Whether any generic class or function is reachable from the module's exports.
+     * Importers that need to instantiate them have to detail the module from source.
+     */
+    bool hasGenericTemplates(std::shared_ptr<DET::Module> module);
+
+    /**
+     * @brief Try to load a snapshot for the given key from `ASTCache::cacheDirectory`
+     *
+     * @return std::shared_ptr<DET::Module> The rehydrated module, or `nullptr` if there's no usable snapshot
+     */
+    std::shared_ptr<DET::Module> load(const ASTCache::CacheKey& key, ModuleResolver resolveDependency, ModuleCallback created = nullptr);
+    /**
+     * @brief Save a snapshot of the given module into `ASTCache::cacheDirectory`
+     *
+     * Modules whose interface can't be snapshotted are silently skipped.
+     */
+    void store(std::shared_ptr<DET::Module> module, const ASTCache::CacheKey& key);
+  };
+};
+
+#endif // ALTACORE_DET_SNAPSHOT_HPP
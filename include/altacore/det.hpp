@@ -4,6 +4,7 @@
 #include "det-shared.hpp"
 
 #include "det/node.hpp"
+#include "det/item-set.hpp"
 #include "det/module.hpp"
 #include "det/scope.hpp"
 #include "det/scope-item.hpp"
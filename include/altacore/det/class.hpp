@@ -2,8 +2,10 @@
 #define ALTACORE_DET_CLASS_HPP
 
 #include "scope-item.hpp"
+#include "../simple-map.hpp"
 #include <memory>
 #include <string>
+#include <unordered_set>
 
 namespace AltaCore {
   namespace AST {
@@ -18,7 +20,47 @@ namespace AltaCore {
     class Type;
 
     class Class: public ScopeItem, public std::enable_shared_from_this<Class> {
+      private:
+        // hierarchy tables; computed on demand and rebuilt once `hierarchyGeneration`
+        // (or, for the virtual tables, `membersVersion()`) moves past them
+        mutable size_t ancestorsGeneration = SIZE_MAX;
+        mutable std::vector<std::shared_ptr<Class>> _ancestors;
+        mutable std::unordered_set<std::string> ancestorIDs;
+
+        size_t virtualsGeneration = SIZE_MAX;
+        size_t virtualsMembersVersion = SIZE_MAX;
+        // name -> virtual methods declared directly in this class, along with their types
+        ALTACORE_MAP<std::string, std::vector<std::pair<std::shared_ptr<Function>, std::shared_ptr<Type>>>> declaredVirtuals;
+        std::vector<std::shared_ptr<Function>> virtualTable;
+
+        // interned type -> result of `findFromCast`/`findToCast`; rebuilt once `Type::castGeneration` moves past them
+        size_t castTablesGeneration = SIZE_MAX;
+        ALTACORE_MAP<const Type*, std::shared_ptr<Function>> fromCastTable;
+        ALTACORE_MAP<const Type*, std::shared_ptr<Function>> toCastTable;
+
+        // (type, orientation) -> the matching operators of this class and each of its ancestors
+        // (in the order of `ancestors`), skipping classes that don't have any
+        mutable size_t operatorTableGeneration = SIZE_MAX;
+        mutable ALTACORE_MAP<size_t, std::vector<std::vector<std::shared_ptr<Function>>>> operatorTable;
+
+        void updateAncestors() const;
+        // the newest `items` version among this class's scope and those of its ancestors
+        size_t membersVersion() const;
+        void updateVirtuals();
+        void updateCastTables();
+        void updateOperatorTable() const;
+
+        std::shared_ptr<Function> findFromCastUncached(const Type& target);
+        std::shared_ptr<Function> findToCastUncached(const Type& target);
+
       public:
+        /**
+         * Bumped whenever a class's parents or operators or a method's virtual-ness change. The hierarchy
+         * tables of every class depend on those of its ancestors, so they're all invalid after that.
+         */
+        static size_t hierarchyGeneration;
+        static void invalidateHierarchies();
+
         virtual const NodeType nodeType();
         virtual std::shared_ptr<Node> clone();
         virtual std::shared_ptr<Node> deepClone();
@@ -59,6 +101,12 @@ namespace AltaCore {
 
         Class(std::string name, std::shared_ptr<Scope> parentScope, AltaCore::Errors::Position position, std::vector<std::shared_ptr<Class>> parents = {});
 
+        /**
+         * @brief Every class this class inherits from, directly or indirectly
+         *
+         * Linearized depth-first, left to right; each ancestor only appears the first time it's reached.
+         */
+        const std::vector<std::shared_ptr<Class>>& ancestors() const;
         bool hasParent(std::shared_ptr<Class> parent) const;
         std::shared_ptr<Class> instantiateGeneric(std::vector<std::shared_ptr<Type>> genericArguments);
 
@@ -68,6 +116,11 @@ namespace AltaCore {
         std::shared_ptr<Function> findOperator(const Shared::ClassOperatorType type, const Shared::ClassOperatorOrientation orient, std::shared_ptr<Type> argType = nullptr) const;
 
         std::vector<std::shared_ptr<Function>> findAllVirtualFunctions();
+        /**
+         * @brief Find a virtual method declared directly in this class
+         * (i.e. not inherited) with the given name and type
+         */
+        std::shared_ptr<Function> findDeclaredVirtualFunction(const std::string& name, const Type& type, bool isAccessor, bool isOperator);
 
         virtual std::string toString() const;
 
@@ -80,17 +80,29 @@ namespace AltaCore {
         EventManager<true> beganThrowing;
         EventManager<true> doneDetailing;
 
+        // only used for generic instantiations
+        //
+        // set while the body is still waiting to be detailed (see `detailBody`)
+        bool bodyDeferred = false;
+
         Function(std::shared_ptr<Scope> parentScope, std::string name, AltaCore::Errors::Position position);
 
         std::vector<std::shared_ptr<Function>> instantiateGeneric(std::vector<std::shared_ptr<Type>> genericArguments);
 
+        /**
+         * @brief Detail this function's body, if it was deferred
+         *
+         * Generic instantiations only detail their signature up front, since most of them
+         * are only created to be considered during overload resolution. Their bodies are
+         * detailed when they're actually referenced, or when a backend asks for them here.
+         */
+        void detailBody();
+
         void recreate(std::vector<std::tuple<std::string, std::shared_ptr<Type>, bool, std::string>> parameters, std::shared_ptr<Type> returnType);
 
         bool isVirtual();
 
-        void setVirtual(bool virt) {
-          _virtual = virt;
-        };
+        void setVirtual(bool virt);
 
         virtual std::string toString() const;
         virtual std::vector<std::shared_ptr<ScopeItem>> fullPrivateHoistedItems() const;
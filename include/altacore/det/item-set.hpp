@@ -0,0 +1,149 @@
+#ifndef ALTACORE_DET_ITEM_SET_HPP
+#define ALTACORE_DET_ITEM_SET_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "../simple-map.hpp"
+
+namespace AltaCore {
+  namespace DET {
+    /**
+     * An insertion-ordered set of DET nodes (compared by ID), with a reference count for each
+     *
+     * Adding an item that's already in the set bumps its count and moves it to the end (so items
+     * are ordered by their latest addition, like they'd be in a plain list after removing the earliest
+     * copy); removing it only drops the count and it's taken out once every addition has been undone.
+     * Otherwise, it behaves like a read-only `std::vector` (just like `ScopeItemList`).
+     */
+    template<typename T>
+    class ItemSet {
+      public:
+        using value_type = std::shared_ptr<T>;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+        using iterator = const_iterator;
+
+      private:
+        struct Entry {
+          size_t index;
+          size_t count;
+        };
+
+        // removed items are left as `nullptr`s until the next time the list is read,
+        // so that repeatedly adding and removing items doesn't shift the list around every time
+        mutable std::vector<value_type> list;
+        mutable ALTACORE_MAP<std::string, Entry> entries;
+        mutable size_t removedCount = 0;
+
+        void compact() const {
+          if (removedCount == 0) return;
+          size_t next = 0;
+          for (size_t i = 0; i < list.size(); ++i) {
+            if (!list[i]) continue;
+            entries[list[i]->id].index = next;
+            list[next++] = std::move(list[i]);
+          }
+          list.resize(next);
+          removedCount = 0;
+        };
+
+      public:
+        ItemSet() = default;
+        ItemSet(const std::vector<value_type>& items) {
+          for (auto& item: items) {
+            push_back(item);
+          }
+        };
+        ItemSet& operator=(const std::vector<value_type>& items) {
+          clear();
+          for (auto& item: items) {
+            push_back(item);
+          }
+          return *this;
+        };
+
+        const_iterator begin() const {
+          compact();
+          return list.begin();
+        };
+        const_iterator end() const {
+          compact();
+          return list.end();
+        };
+        size_t size() const {
+          return entries.size();
+        };
+        bool empty() const {
+          return entries.empty();
+        };
+        const value_type& operator[](size_t index) const {
+          compact();
+          return list[index];
+        };
+        const value_type& front() const {
+          compact();
+          return list.front();
+        };
+        const value_type& back() const {
+          compact();
+          return list.back();
+        };
+        operator const std::vector<value_type>&() const {
+          compact();
+          return list;
+        };
+
+        /**
+         * @brief Add the item at the end, or bump its count and move it to the end if it's already in the set
+         */
+        void push_back(value_type item) {
+          auto it = entries.find(item->id);
+          if (it != entries.end()) {
+            ++it->second.count;
+            if (it->second.index + 1 != list.size()) {
+              list[it->second.index] = nullptr;
+              ++removedCount;
+              it->second.index = list.size();
+              list.push_back(std::move(item));
+            }
+            return;
+          }
+          entries[item->id] = Entry { list.size(), 1 };
+          list.push_back(std::move(item));
+        };
+        /**
+         * @brief Undo one addition of the item
+         *
+         * @returns Whether the item was in the set
+         */
+        bool erase(const value_type& item) {
+          auto it = entries.find(item->id);
+          if (it == entries.end()) return false;
+          if (--it->second.count == 0) {
+            list[it->second.index] = nullptr;
+            ++removedCount;
+            entries.erase(it);
+          }
+          return true;
+        };
+        void clear() {
+          list.clear();
+          entries.clear();
+          removedCount = 0;
+        };
+
+        bool contains(const value_type& item) const {
+          return entries.find(item->id) != entries.end();
+        };
+        /**
+         * @brief How many times the item has been added (and not removed)
+         */
+        size_t count(const value_type& item) const {
+          auto it = entries.find(item->id);
+          return it == entries.end() ? 0 : it->second.count;
+        };
+    };
+  };
+};
+
+#endif // ALTACORE_DET_ITEM_SET_HPP
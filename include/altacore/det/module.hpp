@@ -47,9 +47,9 @@ namespace AltaCore {
         std::shared_ptr<Scope> scope;
         std::shared_ptr<Scope> exports;
         std::vector<std::shared_ptr<Module>> dependencies;
-        std::vector<std::shared_ptr<Module>> dependents;
+        ItemSet<Module> dependents;
         ALTACORE_MAP<std::string, std::vector<std::shared_ptr<Module>>> genericDependencies;
-        std::vector<std::shared_ptr<ScopeItem>> genericsUsed;
+        ItemSet<ScopeItem> genericsUsed;
         std::weak_ptr<AST::RootNode> ast;
         Modules::PackageInfo packageInfo;
         bool noRuntimeInclude = false;
@@ -60,7 +60,7 @@ namespace AltaCore {
         //       for the `_internal` package in root-node.cpp
         std::shared_ptr<Module> parentModule = nullptr;
 
-        std::vector<std::shared_ptr<ScopeItem>> hoistedItems;
+        ItemSet<ScopeItem> hoistedItems;
         size_t rootItemCount = 0;
 
         Module();
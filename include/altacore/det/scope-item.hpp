@@ -2,6 +2,7 @@
 #define ALTACORE_DET_SCOPE_ITEM_HPP
 
 #include "node.hpp"
+#include "item-set.hpp"
 #include <string>
 #include <vector>
 #include "../errors.hpp"
@@ -27,7 +28,7 @@ namespace AltaCore {
         size_t itemID = 0;
         AltaCore::Errors::Position position;
 
-        std::vector<std::shared_ptr<ScopeItem>> privateHoistedItems;
+        ItemSet<ScopeItem> privateHoistedItems;
         std::vector<std::shared_ptr<ScopeItem>> publicHoistedItems;
 
         bool instantiatedFromSamePackage = false;
@@ -5,17 +5,184 @@
 #include "scope-item.hpp"
 #include "type.hpp"
 #include <vector>
+#include <atomic>
 #include <cinttypes>
 #include <string>
 #include <unordered_set>
 #include "../errors.hpp"
+#include "../simple-map.hpp"
 
 namespace AltaCore {
   namespace DET {
     class Class; // forward declaration
 
+    /**
+     * The items in a scope (in the order they were added), along with an index of them by name
+     *
+     * It behaves like a read-only `std::vector`; modifications have to go through the methods
+     * here so that the index stays in sync. Items have to be named before they're added.
+     */
+    class ScopeItemList {
+      public:
+        using value_type = std::shared_ptr<ScopeItem>;
+        using const_iterator = std::vector<value_type>::const_iterator;
+        using iterator = const_iterator;
+
+      private:
+        std::vector<value_type> list;
+        ALTACORE_MAP<std::string, std::vector<value_type>> byName;
+        size_t _version = 0;
+
+        // shared by all lists, so that a newer change anywhere always has a higher version
+        // (atomic since modules can be detailed on different threads)
+        static std::atomic<size_t> latestVersion;
+
+        void reindex();
+        // lets lookup caches know that something changed
+        void changed();
+
+      public:
+        ScopeItemList() = default;
+        ScopeItemList(std::vector<value_type> items);
+        ScopeItemList& operator=(std::vector<value_type> items);
+
+        const_iterator begin() const {
+          return list.begin();
+        };
+        const_iterator end() const {
+          return list.end();
+        };
+        size_t size() const {
+          return list.size();
+        };
+        bool empty() const {
+          return list.empty();
+        };
+        const value_type& operator[](size_t index) const {
+          return list[index];
+        };
+        const value_type& front() const {
+          return list.front();
+        };
+        const value_type& back() const {
+          return list.back();
+        };
+        operator const std::vector<value_type>&() const {
+          return list;
+        };
+
+        void push_back(value_type item);
+        iterator insert(const_iterator position, value_type item);
+        template<typename InputIterator>
+        iterator insert(const_iterator position, InputIterator first, InputIterator last) {
+          bool atEnd = position == list.end();
+          auto offset = position - list.begin();
+          auto oldSize = list.size();
+          list.insert(list.begin() + offset, first, last);
+          if (atEnd) {
+            for (size_t i = oldSize; i < list.size(); i++) {
+              byName[list[i]->name].push_back(list[i]);
+            }
+          } else {
+            // rare enough that it's not worth trying to patch the index in place
+            reindex();
+          }
+          changed();
+          return list.begin() + offset;
+        };
+        iterator erase(const_iterator position);
+        void clear();
+
+        /**
+         * @brief Get every item with the given name, in the order they were added
+         */
+        const std::vector<value_type>& find(const std::string& name) const;
+
+        /**
+         * Changes whenever the list changes (or is `touch`ed). Versions only ever increase,
+         * so the newest version among several lists changes whenever any of them do.
+         */
+        size_t version() const {
+          return _version;
+        };
+        /**
+         * @brief Let anything keyed on `version` know that one of the items changed
+         * in a way that matters to them (e.g. a function's signature changed)
+         */
+        void touch();
+    };
+
     class Scope: public Node, public std::enable_shared_from_this<Scope> {
+      private:
+        struct CachedLookup {
+          std::vector<std::shared_ptr<Type>> excludeTypes;
+          bool searchParents;
+          bool fromSelf;
+          std::vector<std::shared_ptr<ScopeItem>> results;
+        };
+
+        /**
+         * What `findAll` results depend on: the items of this scope and every scope above it,
+         * plus the global generations
+         */
+        struct LookupStamp {
+          size_t itemsVersion = 0;
+          size_t generation = 0;
+          size_t parentChainGeneration = 0;
+
+          bool operator ==(const LookupStamp& other) const {
+            return itemsVersion == other.itemsVersion && generation == other.generation && parentChainGeneration == other.parentChainGeneration;
+          };
+          bool operator !=(const LookupStamp& other) const {
+            return !(*this == other);
+          };
+        };
+
+        // name -> previous `findAll` results
+        ALTACORE_MAP<std::string, std::vector<CachedLookup>> lookupCache;
+        LookupStamp lookupCacheStamp;
+
+        LookupStamp lookupStamp() const;
+
+        std::vector<std::shared_ptr<ScopeItem>> findAllUncached(const std::string& name, const std::vector<std::shared_ptr<Type>>& excludeTypes, bool searchParents, std::shared_ptr<Scope> originScope);
+
       public:
+        /**
+         * Where a scope sits in the scope graph: the closest scope enclosing it, the closest
+         * module, function, class, and namespace it's in, and how many scopes enclose it
+         */
+        struct ParentChain {
+          std::weak_ptr<Scope> closestParent;
+          std::weak_ptr<Module> module;
+          std::weak_ptr<Function> function;
+          std::weak_ptr<Class> klass;
+          std::weak_ptr<Namespace> ns;
+          size_t depth = 0;
+        };
+
+      private:
+        mutable ParentChain chain;
+        mutable size_t chainGeneration = SIZE_MAX;
+
+      public:
+        /**
+         * Bumped whenever a scope (or the item that owns a scope) is moved somewhere else
+         * after it's been created. Parent chains are built from the chains of the scopes
+         * above them, so they're all invalid after that.
+         */
+        static size_t parentChainGeneration;
+        static void invalidateParentChains();
+        /**
+         * Bumped by `invalidateLookups`. Changes to a scope's `items` don't bump this; they only
+         * invalidate the lookup caches of that scope and the scopes below it.
+         */
+        static size_t generation;
+        /**
+         * Invalidate every scope's lookup cache. Use this after changing something that affects
+         * lookups everywhere; for changes to a single item, `items.touch()` on its scope is enough.
+         */
+        static void invalidateLookups();
+
         virtual const NodeType nodeType();
         virtual std::shared_ptr<Node> clone();
         virtual std::shared_ptr<Node> deepClone();
@@ -26,7 +193,7 @@ namespace AltaCore {
         std::weak_ptr<Namespace> parentNamespace;
         std::weak_ptr<Class> parentClass;
 
-        std::vector<std::shared_ptr<ScopeItem>> items;
+        ScopeItemList items;
         std::vector<std::shared_ptr<Scope>> childScopes;
         size_t relativeID = 0;
         size_t nextChildID = 0;
@@ -51,6 +218,13 @@ namespace AltaCore {
         void hoist(std::shared_ptr<ScopeItem> item);
         void unhoist(std::shared_ptr<ScopeItem> item);
 
+        /**
+         * @brief Get this scope's parent chain
+         *
+         * It's built the first time it's needed (by reusing the chain of the closest parent scope),
+         * so the scope's parent links (e.g. `parent` or `parentFunction`) have to be set up by then.
+         */
+        const ParentChain& parentChain() const;
         bool hasParent(std::shared_ptr<Scope> parent) const;
 
         static std::shared_ptr<Scope> getMemberScope(std::shared_ptr<ScopeItem> item);
@@ -5,6 +5,10 @@
 #include "class.hpp"
 #include <string>
 #include <vector>
+#include <cstring>
+#include <bitset>
+#include <initializer_list>
+#include <chrono>
 
 namespace AltaCore {
   namespace AST {
@@ -44,6 +48,38 @@ namespace AltaCore {
     using CastCompatibility = size_t;
     constexpr CastCompatibility MAX_CAST_COMPAT = SIZE_MAX;
 
+    /**
+     * Counters for the cast path cache used by `Type::findCast`
+     */
+    struct CastCacheStatistics {
+      size_t hits = 0;
+      size_t misses = 0;
+      size_t invalidations = 0;
+      size_t entries = 0;
+
+      double hitRate() const;
+    };
+
+    /**
+     * Counters for the cache behind `Type::compatiblity`, `isCompatibleWith`, and `isExactlyCompatibleWith`
+     */
+    struct CompatibilityCacheStatistics {
+      size_t hits = 0;
+      size_t misses = 0;
+      size_t invalidations = 0;
+      size_t entries = 0;
+      /**
+       * Total time spent actually computing results on misses
+       */
+      std::chrono::nanoseconds missTime = std::chrono::nanoseconds(0);
+
+      double hitRate() const;
+      /**
+       * Roughly how long the hits would have taken to compute (hits × average miss time)
+       */
+      std::chrono::nanoseconds estimatedTimeSaved() const;
+    };
+
     class CastComponent {
       public:
         CastComponentType type = CastComponentType::Destination;
@@ -95,9 +131,258 @@ namespace AltaCore {
         bool operator ==(const CastComponent& other) const;
     };
 
+    /**
+     * A type's modifier levels (root level first), stored inline
+     *
+     * This works just like the `std::vector<uint8_t>` that used to hold them, but it doesn't
+     * allocate for up to `capacity` levels (more than any real type needs); deeper stacks
+     * spill over to the heap. Inline levels are laid out back-to-back in two machine words, so
+     * questions like "how many levels are pointers?" are answered with a few bit operations instead of a loop.
+     */
+    class ModifierStack {
+      public:
+        static constexpr size_t capacity = 16;
+
+        using value_type = uint8_t;
+        using iterator = uint8_t*;
+        using const_iterator = const uint8_t*;
+
+        /**
+         * A bitmask with one bit per level (bit 0 is the root level)
+         *
+         * Only covers the first `capacity` levels.
+         */
+        using LevelMask = uint16_t;
+
+      private:
+        uint8_t levels[capacity] = {};
+        size_t levelCount = 0;
+        /**
+         * Holds every level instead of `levels` while there are more than `capacity` of them
+         * (`levels` is kept zeroed in the meantime)
+         */
+        std::vector<uint8_t> spilled;
+
+        uint8_t* data() {
+          return spilled.empty() ? levels : spilled.data();
+        };
+        const uint8_t* data() const {
+          return spilled.empty() ? levels : spilled.data();
+        };
+
+        // make room for `count` levels in total
+        void grow(size_t count) {
+          if (count <= capacity) return;
+          if (spilled.empty()) {
+            spilled.assign(levels, levels + levelCount);
+            std::memset(levels, 0, sizeof(levels));
+          }
+          spilled.resize(count);
+        };
+        // move back inline once the levels fit again
+        void shrink() {
+          if (spilled.empty()) {
+            return;
+          }
+          if (levelCount > capacity) {
+            spilled.resize(levelCount);
+            return;
+          }
+          std::memcpy(levels, spilled.data(), levelCount);
+          std::vector<uint8_t>().swap(spilled);
+        };
+
+        // everything past `levelCount` is always kept zeroed so it never shows up in any masks
+        static LevelMask wordMask(uint64_t word, uint8_t flags) {
+          constexpr uint64_t lows = 0x0101010101010101ull;
+          constexpr uint64_t highs = 0x8080808080808080ull;
+          word &= lows * flags;
+          // set the high bit of every byte that's non-zero...
+          word = (((word & ~highs) + ~highs) | word) & highs;
+          // ...and gather them up into the low byte
+          return static_cast<LevelMask>(((word >> 7) * 0x0102040810204080ull) >> 56);
+        };
+
+      public:
+        ModifierStack() {};
+        ModifierStack(std::initializer_list<uint8_t> init):
+          ModifierStack(init.begin(), init.end())
+          {};
+        ModifierStack(const std::vector<uint8_t>& init):
+          ModifierStack(init.begin(), init.end())
+          {};
+        template<typename InputIterator>
+        ModifierStack(InputIterator first, InputIterator last) {
+          insert(end(), first, last);
+        };
+
+        operator std::vector<uint8_t>() const {
+          return std::vector<uint8_t>(begin(), end());
+        };
+
+        size_t size() const {
+          return levelCount;
+        };
+        bool empty() const {
+          return levelCount == 0;
+        };
+        /**
+         * @brief Whether every level is stored inline (and is therefore covered by the masks)
+         */
+        bool isInline() const {
+          return spilled.empty();
+        };
+
+        iterator begin() {
+          return data();
+        };
+        iterator end() {
+          return data() + levelCount;
+        };
+        const_iterator begin() const {
+          return data();
+        };
+        const_iterator end() const {
+          return data() + levelCount;
+        };
+
+        uint8_t& operator [](size_t index) {
+          return data()[index];
+        };
+        const uint8_t& operator [](size_t index) const {
+          return data()[index];
+        };
+        uint8_t& front() {
+          return data()[0];
+        };
+        const uint8_t& front() const {
+          return data()[0];
+        };
+        uint8_t& back() {
+          return data()[levelCount - 1];
+        };
+        const uint8_t& back() const {
+          return data()[levelCount - 1];
+        };
+
+        void push_back(uint8_t level) {
+          grow(levelCount + 1);
+          data()[levelCount++] = level;
+        };
+        void pop_back() {
+          data()[--levelCount] = 0;
+          shrink();
+        };
+        void clear() {
+          std::memset(levels, 0, sizeof(levels));
+          std::vector<uint8_t>().swap(spilled);
+          levelCount = 0;
+        };
+
+        iterator insert(const_iterator position, uint8_t level) {
+          return insert(position, &level, &level + 1);
+        };
+        template<typename InputIterator>
+        iterator insert(const_iterator position, InputIterator first, InputIterator last) {
+          size_t index = position - data();
+          // copy the new levels out first, in case they come from this stack
+          // (only allocating if there are too many of them to fit inline)
+          uint8_t incoming[capacity];
+          std::vector<uint8_t> incomingSpilled;
+          size_t incomingCount = 0;
+          for (; first != last; ++first) {
+            if (incomingCount < capacity) {
+              incoming[incomingCount] = static_cast<uint8_t>(*first);
+            } else {
+              if (incomingSpilled.empty()) {
+                incomingSpilled.assign(incoming, incoming + capacity);
+              }
+              incomingSpilled.push_back(static_cast<uint8_t>(*first));
+            }
+            ++incomingCount;
+          }
+          grow(levelCount + incomingCount);
+          auto storage = data();
+          std::memmove(storage + index + incomingCount, storage + index, levelCount - index);
+          std::memcpy(storage + index, incomingSpilled.empty() ? incoming : incomingSpilled.data(), incomingCount);
+          levelCount += incomingCount;
+          return storage + index;
+        };
+        iterator erase(const_iterator position) {
+          return erase(position, position + 1);
+        };
+        iterator erase(const_iterator first, const_iterator last) {
+          size_t index = first - data();
+          size_t count = last - first;
+          auto storage = data();
+          std::memmove(storage + index, storage + index + count, levelCount - index - count);
+          std::memset(storage + levelCount - count, 0, count);
+          levelCount -= count;
+          shrink();
+          return data() + index;
+        };
+
+        /**
+         * @brief Get a mask of the (first `capacity`) levels that have any of the given flags
+         */
+        LevelMask levelsWith(uint8_t flags) const {
+          uint64_t words[2];
+          std::memcpy(words, data(), sizeof(words));
+          return wordMask(words[0], flags) | static_cast<LevelMask>(wordMask(words[1], flags) << 8);
+        };
+        /**
+         * @brief Count the levels that have any of the given flags
+         */
+        size_t count(uint8_t flags) const {
+          if (!isInline()) {
+            size_t result = 0;
+            for (auto level: *this) {
+              if (level & flags) ++result;
+            }
+            return result;
+          }
+          return std::bitset<capacity>(levelsWith(flags)).count();
+        };
+        /**
+         * @brief Count the levels that have any of the given flags, stopping after
+         * the first level that has any of `stopFlags`
+         */
+        size_t countUntil(uint8_t flags, uint8_t stopFlags) const {
+          if (!isInline()) {
+            size_t result = 0;
+            for (auto level: *this) {
+              if (level & flags) ++result;
+              if (level & stopFlags) break;
+            }
+            return result;
+          }
+          return std::bitset<capacity>(levelsWith(flags) & throughFirst(levelsWith(stopFlags))).count();
+        };
+
+        /**
+         * @brief Get a mask of every level up to and including the first one in `mask`
+         * (or every level, if `mask` is empty)
+         */
+        static LevelMask throughFirst(LevelMask mask) {
+          LevelMask lowest = mask & static_cast<LevelMask>(-mask);
+          return static_cast<LevelMask>(lowest - 1) | lowest;
+        };
+
+        bool operator ==(const ModifierStack& other) const {
+          return levelCount == other.levelCount && std::memcmp(data(), other.data(), levelCount) == 0;
+        };
+        bool operator !=(const ModifierStack& other) const {
+          return !(*this == other);
+        };
+    };
+
     class Type: public ScopeItem {
       private:
         bool commonCompatiblity(const Type& other, bool strict = false) const;
+        static CastPath findCastUncached(std::shared_ptr<Type> from, std::shared_ptr<Type> to, bool manual);
+        size_t compatiblityUncached(const Type& other) const;
+        bool isExactlyCompatibleWithUncached(const Type& other) const;
+        bool isCompatibleWithUncached(const Type& other) const;
       public:
         virtual const NodeType nodeType();
         virtual std::shared_ptr<Node> clone();
@@ -116,8 +401,69 @@ namespace AltaCore {
         static std::vector<CastPath> findAllPossibleCasts(std::shared_ptr<Type> from, std::shared_ptr<Type> to, bool manual = false);
         static CastCompatibility determineCompatiblity(std::shared_ptr<Type> from, std::shared_ptr<Type> to, CastPath cast);
         static std::pair<CastPath, CastCompatibility> findMostCompatibleCast(std::shared_ptr<Type> from, std::shared_ptr<Type> to, std::vector<CastPath> casts);
+        /**
+         * @brief Find the best way to cast `from` to `to`
+         *
+         * Results are cached by the (interned) structure of both types and `manual`, so
+         * repeated queries for the same pair are cheap. Anything that changes which casts
+         * are available between classes must call `invalidateCasts` afterwards.
+         */
         static CastPath findCast(std::shared_ptr<Type> from, std::shared_ptr<Type> to, bool manual = false);
+        /**
+         * @brief Drop every cached cast path and compatibility result
+         *
+         * Call this whenever a class's parents, `fromCasts`, or `toCasts` change.
+         */
+        static void invalidateCasts();
+        /**
+         * Bumped by every call to `invalidateCasts`; lets other cast caches (e.g. `Class`'s)
+         * know when they need to be rebuilt
+         */
+        static size_t castGeneration();
+        static CastCacheStatistics castCacheStatistics();
+        static void resetCastCacheStatistics();
+        static CompatibilityCacheStatistics compatibilityCacheStatistics();
+        static void resetCompatibilityCacheStatistics();
 
+        /**
+         * @brief Get the canonical instance of the given type
+         *
+         * Structurally identical types are interned as a single shared instance, so they
+         * can be compared by pointer and don't have to be reallocated every time they're needed.
+         * The given type must not be modified afterwards (the types it refers to are
+         * interned as copies); use `copy()` to get a modifiable version of an interned type.
+         */
+        static std::shared_ptr<Type> intern(std::shared_ptr<Type> type);
+        /**
+         * @brief Intern copies of each of the given types
+         */
+        static std::vector<std::shared_ptr<Type>> internAll(const std::vector<std::shared_ptr<Type>>& types);
+        /**
+         * @brief Find the interned instance structurally identical to the given type
+         * without interning anything; `nullptr` if there isn't one yet
+         */
+        static const Type* findInterned(const Type& type);
+        /**
+         * @brief Release every interned type (and every type derived from one) that's
+         * no longer used outside of the intern table
+         *
+         * The cast and compatibility caches are keyed by interned types, so they're dropped as well
+         * (see `invalidateCasts`). Pointers to the released types must not be used afterwards.
+         *
+         * @return size_t How many types were released
+         */
+        static size_t pruneInterned();
+        /**
+         * @brief Shorthand for interning a native type
+         */
+        static std::shared_ptr<Type> native(NativeType nativeTypeName, std::vector<uint8_t> modifiers = {});
+
+        /**
+         * Whether this is a canonical instance returned by `intern`
+         *
+         * Types derived from interned types (e.g. with `reference()`) are interned as well.
+         */
+        bool isInterned = false;
         bool isAny = false;
         bool isNative = true;
         bool isFunction = false;
@@ -144,7 +490,7 @@ namespace AltaCore {
         /**
          * follows the same format as `AltaCore::AST::Type::modifiers`
          */
-        std::vector<uint8_t> modifiers;
+        ModifierStack modifiers;
 
         /**
          * @brief Add a `ref` to this type
@@ -186,9 +532,25 @@ namespace AltaCore {
 
         std::shared_ptr<Type> makeOptional() const;
 
+        /**
+         * The results of these three are cached by the structure of both types
+         * (see `compatibilityCacheStatistics`)
+         */
         size_t compatiblity(const Type& other) const;
         bool isExactlyCompatibleWith(const Type& other) const;
         bool isCompatibleWith(const Type& other) const;
+        /**
+         * @brief Hash only what `isExactlyCompatibleWith` looks at, so that exactly
+         * compatible types always hash the same
+         *
+         * Different hashes mean the types definitely aren't exactly compatible;
+         * equal hashes still have to be checked.
+         */
+        size_t exactCompatibilityHash() const;
+        /**
+         * @brief Same as above, but for a list of types (e.g. a list of generic arguments)
+         */
+        static size_t exactCompatibilityHash(const std::vector<std::shared_ptr<Type>>& types);
 
         static inline std::vector<uint8_t> createModifierVector(std::vector<std::vector<TypeModifierFlag>> modifiers) {
           std::vector<uint8_t> result;
@@ -227,19 +589,34 @@ namespace AltaCore {
         };
 
         inline bool isSigned() const {
-          bool result = true;
-          for (const auto& modifier: modifiers) {
-            if (modifier & static_cast<uint8_t>(AltaCore::DET::TypeModifierFlag::Signed)) {
-              result = true;
-            }
-            if (modifier & static_cast<uint8_t>(AltaCore::DET::TypeModifierFlag::Unsigned)) {
-              result = false;
-            }
-            if (modifier & (static_cast<uint8_t>(AltaCore::DET::TypeModifierFlag::Pointer) | static_cast<uint8_t>(AltaCore::DET::TypeModifierFlag::Reference))) {
-              break;
+          if (!modifiers.isInline()) {
+            bool result = true;
+            for (const auto& modifier: modifiers) {
+              if (modifier & static_cast<uint8_t>(AltaCore::DET::TypeModifierFlag::Signed)) {
+                result = true;
+              }
+              if (modifier & static_cast<uint8_t>(AltaCore::DET::TypeModifierFlag::Unsigned)) {
+                result = false;
+              }
+              if (modifier & (static_cast<uint8_t>(AltaCore::DET::TypeModifierFlag::Pointer) | static_cast<uint8_t>(AltaCore::DET::TypeModifierFlag::Reference))) {
+                break;
+              }
             }
+            return result;
           }
-          return result;
+          // only the levels up to (and including) the first pointer or reference count,
+          // and the last `signed` or `unsigned` among them wins
+          auto relevant = ModifierStack::throughFirst(modifiers.levelsWith(static_cast<uint8_t>(AltaCore::DET::TypeModifierFlag::Pointer) | static_cast<uint8_t>(AltaCore::DET::TypeModifierFlag::Reference)));
+          ModifierStack::LevelMask unsignedLevels = modifiers.levelsWith(static_cast<uint8_t>(AltaCore::DET::TypeModifierFlag::Unsigned)) & relevant;
+          ModifierStack::LevelMask signedLevels = modifiers.levelsWith(static_cast<uint8_t>(AltaCore::DET::TypeModifierFlag::Signed)) & relevant;
+          if (unsignedLevels == 0) return true;
+          // if a level has both, `unsigned` wins (it was checked last)
+          signedLevels &= ~unsignedLevels;
+          // smear the highest `unsigned` level downwards; if any `signed` level is above that, it wins
+          for (size_t shift = 1; shift < ModifierStack::capacity; shift *= 2) {
+            unsignedLevels |= unsignedLevels >> shift;
+          }
+          return signedLevels > unsignedLevels;
         };
 
         inline bool isFloatingPoint() const {
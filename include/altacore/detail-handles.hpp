@@ -7,6 +7,7 @@
 #include "variant.hpp"
 #include "attributes.hpp"
 #include <vector>
+#include <unordered_map>
 
 namespace AltaCore {
   namespace AST {
@@ -187,6 +188,10 @@ namespace AltaCore {
       std::vector<std::shared_ptr<ClassStatementNode>> statements;
       std::vector<std::shared_ptr<RetrievalNode>> parents;
       std::vector<std::shared_ptr<GenericClassInstantiationDefinitionNode>> genericInstantiations;
+      /**
+       * `genericInstantiations`, bucketed by `DET::Type::exactCompatibilityHash` of their generic arguments
+       */
+      std::unordered_map<size_t, std::vector<std::shared_ptr<GenericClassInstantiationDefinitionNode>>> genericInstantiationIndex;
 
       bool isExport = false;
       bool isLiteral = false;
@@ -355,6 +360,10 @@ namespace AltaCore {
       bool isAsync = false;
 
       std::vector<std::shared_ptr<GenericFunctionInstantiationDefinitionNode>> genericInstantiations;
+      /**
+       * `genericInstantiations`, bucketed by `DET::Type::exactCompatibilityHash` of their generic arguments
+       */
+      std::unordered_map<size_t, std::vector<std::shared_ptr<GenericFunctionInstantiationDefinitionNode>>> genericInstantiationIndex;
       std::vector<std::shared_ptr<Generic>> genericDetails;
 
       std::shared_ptr<DET::Function> function = nullptr;
@@ -402,6 +411,10 @@ namespace AltaCore {
       std::shared_ptr<DET::Module> module = nullptr;
       std::vector<std::shared_ptr<AST::RootNode>> dependencyASTs;
       std::shared_ptr<RootNode> parent = nullptr;
+      // whether `AST::RootNode::detail` has finished
+      bool detailed = false;
+      // rehydrated modules have no statement details
+      bool fromSnapshot = false;
     };
     class TypeAliasStatement: public StatementNode {
       ALTACORE_DH_CTOR(TypeAliasStatement, StatementNode);
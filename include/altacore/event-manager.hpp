@@ -3,6 +3,7 @@
 
 #include <forward_list>
 #include "optional.hpp"
+#include "concurrency.hpp"
 
 //
 // adapted from https://cpppatterns.com/patterns/apply-tuple-to-function.html
@@ -46,18 +47,29 @@ namespace AltaCore {
       ALTACORE_OPTIONAL<std::tuple<Args...>> dispatchedArguments = ALTACORE_NULLOPT;
 
     public:
+      // events on items in finished modules get listened to by every module that uses them,
+      // which might be detailed on different threads
       void listen(const std::function<void(Args...)> callback) {
-        if (once && _dispatched) {
-          return applyTuple(callback, *dispatchedArguments);
+        {
+          Concurrency::CacheLock lock;
+          if (!(once && _dispatched)) {
+            callbacks.push_front(callback);
+            return;
+          }
         }
-        callbacks.push_front(callback);
+        applyTuple(callback, *dispatchedArguments);
       };
 
       void dispatch(Args... args) {
-        if (once && _dispatched) return;
-        _dispatched = true;
-        dispatchedArguments = ALTACORE_MAKE_OPTIONAL(std::make_tuple(args...));
-        for (const auto& callback: callbacks) {
+        std::forward_list<std::function<void(Args...)>> current;
+        {
+          Concurrency::CacheLock lock;
+          if (once && _dispatched) return;
+          _dispatched = true;
+          dispatchedArguments = ALTACORE_MAKE_OPTIONAL(std::make_tuple(args...));
+          current = callbacks;
+        }
+        for (const auto& callback: current) {
           callback(args...);
         }
       };
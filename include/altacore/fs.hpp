@@ -2,7 +2,10 @@
 #define ALTACORE_FS_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory>
+#include <cstdint>
 
 // why are we rolling our own filesystem implementation?
 // why not use C++17's `std::filesystem`? alas, while i
@@ -40,28 +43,68 @@ namespace AltaCore {
 
     std::string cwd();
 
+    /**
+     * A filesystem path
+     *
+     * Paths are stored as a single string (joined with the platform separator) along with
+     * where each component starts and ends in it and the hash of every prefix of the path.
+     * That buffer is shared between copies (and only copied when a shared path is modified),
+     * so copying paths, taking their `dirname`, and `pop`ping components don't allocate.
+     */
     class Path {
       friend std::size_t std::hash<Path>::operator()(const Path&) const;
 
       private:
-        bool hasRoot = false;
-        std::string root;
+        struct Component {
+          size_t start;
+          size_t end;
+          // hash of the path up to and including this component
+          size_t hash;
+        };
+        struct Data {
+          std::string text;
+          bool hasRoot = false;
+          size_t rootLength = 0;
+          size_t rootHash = 0;
+          std::vector<Component> components;
+        };
+
+        std::shared_ptr<Data> data = nullptr;
+        // how many of `data`'s components belong to this path
+        // (paths created by `dirname` or `pop` share their parent's buffer)
+        size_t count = 0;
+
+        void parse(std::string_view path, const std::string_view* separators, size_t separatorCount);
+        Data& own();
+        void setRoot(std::string_view root);
+        void append(std::string_view component);
+        size_t end() const;
+        size_t hash() const;
+        std::string_view root() const;
 
         void absolutifyInPlace(Path relativeTo);
       public:
-        std::vector<std::string> components;
-
         Path();
-        Path(std::string path, std::vector<std::string> separators = { "/", "\\" });
+        Path(std::string path);
+        Path(std::string path, std::vector<std::string> separators);
         Path(std::string path, std::string separator);
 
+        size_t componentCount() const;
+        /**
+         * @brief Get a view of one of this path's components
+         *
+         * The view is only valid as long as this path (or a copy of it) is alive and unmodified
+         */
+        std::string_view component(size_t index) const;
+        std::vector<std::string> components() const;
+
         Path normalize() const;
         Path absolutify(Path relativeTo) const;
+        Path absolutify(std::string relativeTo) const;
         /**
-         * @brief Create an absolute path from this path
-         * By default, it is resolved relative to the current working directory
+         * @brief Create an absolute path from this path, resolved relative to the current working directory
          */
-        Path absolutify(std::string relativeTo = cwd()) const;
+        Path absolutify() const;
         Path relativeTo(Path other) const;
         std::string toString(std::string separator = std::string(1, platformSeparator)) const;
         std::string toString(char separator) const;
@@ -93,6 +136,12 @@ namespace AltaCore {
         bool exists() const;
         bool isDirectory() const;
         bool isAbsolute() const;
+        /**
+         * @brief Get the time this path was last modified, in nanoseconds since the Unix epoch
+         *
+         * @return int64_t The modification time, or -1 if the path doesn't exist
+         */
+        int64_t modificationTime() const;
 
         bool hasParentDirectory(const Path& parentDir) const;
 
@@ -104,6 +153,54 @@ namespace AltaCore {
         explicit operator bool() const;
     };
     
+    /**
+     * Remembers what `stat` said about each path (and what the current working directory is),
+     * so that checking the same paths over and over (e.g. while resolving modules) only
+     * hits the filesystem once per path
+     *
+     * `cwd`, `Path::exists`, `Path::isDirectory`, and `Path::modificationTime` all go through
+     * this cache. It's meant to last for a single compilation session: anything that changes
+     * the filesystem (or the working directory) behind our back has to call `invalidate`.
+     * `mkdirp`, `copyFile`, and `copyDirectory` keep it up to date on their own.
+     */
+    class StatCache {
+      public:
+        struct Entry {
+          bool exists = false;
+          bool isDirectory = false;
+          int64_t modificationTime = -1;
+        };
+        struct Statistics {
+          size_t hits = 0;
+          size_t misses = 0;
+          size_t invalidations = 0;
+        };
+
+        /**
+         * When disabled, every lookup goes straight to the filesystem
+         *
+         * Defaults to `true`
+         */
+        static bool enabled;
+
+        static std::string cwd();
+        static Entry lookup(const Path& path);
+        /**
+         * @brief Same as `lookup`, but always checks the filesystem (and updates the cache)
+         */
+        static Entry refresh(const Path& path);
+        /**
+         * @brief Forget everything, including the current working directory
+         */
+        static void invalidate();
+        /**
+         * @brief Forget the given path and everything beneath it
+         */
+        static void invalidate(const Path& path);
+        static Statistics statistics();
+        static void resetStatistics();
+    };
+
     [[deprecated("Use `path.exists()` instead")]] bool exists(Path path);
 
     bool mkdirp(Path targetPath);
@@ -0,0 +1,132 @@
+#ifndef ALTACORE_IMPORT_GRAPH_HPP
+#define ALTACORE_IMPORT_GRAPH_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include "fs.hpp"
+
+namespace AltaCore {
+  namespace AST {
+    class RootNode;
+  };
+  namespace DET {
+    class Module;
+  };
+  namespace Modules {
+    /**
+     * The modules that make up a program and the imports between them
+     *
+     * Modules that import each other (directly or not) can't be processed separately, so they're
+     * grouped into components (the strongly connected components of the import graph). The
+     * components form a DAG, which `detail` and `run` walk dependencies-first.
+     *
+     * Both can process independent components concurrently.
+     */
+    class ImportGraph {
+      public:
+        struct Node {
+          Filesystem::Path path;
+          /**
+           * `nullptr` if the graph was built from DET modules whose AST is gone
+           */
+          std::shared_ptr<AST::RootNode> root = nullptr;
+          /**
+           * `nullptr` until the module has been detailed
+           */
+          std::shared_ptr<DET::Module> module = nullptr;
+          /**
+           * Indices (into `nodes`) of the modules this one imports, in import order
+           */
+          std::vector<size_t> dependencies;
+          /**
+           * Index (into `components`) of the component this module is in
+           */
+          size_t component = 0;
+        };
+
+        struct Component {
+          /**
+           * Indices (into `nodes`) of the modules in this component, in the order a depth-first
+           * walk of the imports reaches them (so the first one is where detailing enters the cycle)
+           */
+          std::vector<size_t> members;
+          /**
+           * Indices (into `components`) of the components this one imports from
+           */
+          std::vector<size_t> dependencies;
+          /**
+           * Indices (into `components`) of the components that import from this one
+           */
+          std::vector<size_t> dependents;
+        };
+
+        /**
+         * The first node is always the one the graph was built from
+         */
+        std::vector<Node> nodes;
+        /**
+         * Sorted so that every component comes after all of its dependencies
+         */
+        std::vector<Component> components;
+
+        /**
+         * @brief Build the graph of everything the given (parsed, but not necessarily detailed) module imports
+         *
+         * Imports are found in the module's top-level import and export-from statements (plus the
+         * implicit import of the `_internal` package) and parsed with `Modules::parseModule`
+         * (so modules that have already been parsed come straight from the `importCache`).
+         * Imports that fail to resolve or parse are left out; detailing reports them as usual.
+         */
+        static ImportGraph fromAST(std::shared_ptr<AST::RootNode> root, Filesystem::Path path);
+        /**
+         * @brief Build the graph of an already-detailed module (e.g. one loaded from a DET snapshot)
+         * from its `dependencies`
+         */
+        static ImportGraph fromModule(std::shared_ptr<DET::Module> module);
+
+        /**
+         * @brief Call `task` for every component, but only once all of its dependencies are done
+         *
+         * Components that don't depend on each other are handed to different worker threads, so `task`
+         * must be safe to run concurrently for different components (use `detail` for detailing).
+         * If `task` throws, no new components are started and the first exception is rethrown on the calling
+         * thread once all workers are done.
+         *
+         * @param workerCount How many threads to use. `0` means one per hardware thread.
+         */
+        void run(std::function<void(const Component& component)> task, size_t workerCount = 0) const;
+
+        /**
+         * @brief Detail every module in the graph, dependencies first
+         *
+         * Every component is only started once all of the components it imports from are detailed,
+         * so when its modules' import statements are detailed, the modules they import are already done
+         * (and `AST::RootNode::detail` returns right away for them). The only imports that are still
+         * detailed recursively are the ones within an import cycle: each component is entered from its
+         * first member and the rest of it is detailed through that member's imports, just like it would be
+         * when detailing the root module directly.
+         *
+         * Components that don't depend on each other are detailed on different threads (through `run`),
+         * with `Concurrency` keeping the process-wide DET state consistent. Imports within a cycle,
+         * generic instantiations, and cache invalidations pause the other workers while they run, so
+         * the more of those a program has, the less it gains from extra workers. Attribute callbacks
+         * (see `Attributes::registerAttribute`) can be called on any of the workers, so when using more
+         * than one, they have to be thread-safe.
+         *
+         * Modules detailed here don't have a `parentModule`, since they're detailed before anything
+         * that imports them.
+         *
+         * With `DETSnapshot::rehydrateImports` on, every module except the root one is rehydrated
+         * from its snapshot when possible (see `AST::RootNode::rehydrate`).
+         *
+         * @param rootModuleName Passed along to `AST::RootNode::detail` for the root module
+         * @param workerCount How many threads to use. `0` means one per hardware thread.
+         */
+        void detail(std::string rootModuleName = "", size_t workerCount = 0);
+    };
+  };
+};
+
+#endif // ALTACORE_IMPORT_GRAPH_HPP
@@ -0,0 +1,118 @@
+#ifndef ALTACORE_MEMORY_HPP
+#define ALTACORE_MEMORY_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include "fs.hpp"
+#include "ast-shared.hpp"
+#include "det-shared.hpp"
+#include "lexer.hpp"
+
+namespace AltaCore {
+  namespace AST {
+    class Node;
+  };
+  namespace DetailHandles {
+    class Node;
+  };
+  namespace DH = DetailHandles;
+  namespace DET {
+    class Module;
+  };
+  namespace Parser {
+    class Parser;
+  };
+
+  /**
+   * Memory accounting for the frontend's data structures
+   *
+   * Reports are built by walking live objects (not by hooking allocations), so they
+   * can be taken at any point without any cost to code that doesn't ask for one.
+   * Byte counts are estimates: the size of each object's concrete type plus the
+   * heap storage owned by its ID and (for tokens) its raw text and buffer. Every
+   * object is counted at most once per report, no matter how many times it's reachable.
+   */
+  namespace Memory {
+    struct Usage {
+      size_t instances = 0;
+      size_t bytes = 0;
+
+      void add(size_t bytes, size_t instances = 1);
+      Usage& operator+=(const Usage& other);
+    };
+
+    struct ModuleUsage {
+      std::string name;
+      Filesystem::Path path;
+
+      std::map<AST::NodeType, Usage> ast;
+      std::map<std::string, Usage> detailHandles;
+      std::map<DET::NodeType, Usage> det;
+      Usage tokens;
+      /**
+       * The `Modules::importCache` entry itself (the key and the map node)
+       */
+      Usage importCache;
+
+      Usage total() const;
+    };
+
+    class Report {
+      private:
+        std::unordered_set<const void*> seen;
+
+        ModuleUsage& moduleFor(Filesystem::Path modulePath);
+
+      public:
+        /**
+         * Keyed by absolute module path
+         */
+        std::map<std::string, ModuleUsage> modules;
+
+        /**
+         * Count every AST node reachable from `root`
+         */
+        void addAST(std::shared_ptr<AST::Node> root, Filesystem::Path modulePath);
+        /**
+         * Count every detail handle reachable from `root`
+         */
+        void addDetails(std::shared_ptr<DH::Node> root, Filesystem::Path modulePath);
+        /**
+         * Count the module along with every scope, item, and type it owns
+         *
+         * Items from other modules (e.g. alias targets or parent classes) aren't
+         * followed; they're counted when their own module is added.
+         */
+        void addModule(std::shared_ptr<DET::Module> module);
+        void addTokens(const std::vector<Lexer::Token>& tokens, Filesystem::Path modulePath);
+        /**
+         * Count the token buffers a parser is holding on to
+         */
+        void addParser(const Parser::Parser& parser, Filesystem::Path modulePath);
+        /**
+         * Count every entry in `Modules::importCache`, along with its AST,
+         * detail handles, and module
+         */
+        void addImportCache();
+
+        std::map<AST::NodeType, Usage> astTotals() const;
+        std::map<std::string, Usage> detailHandleTotals() const;
+        std::map<DET::NodeType, Usage> detTotals() const;
+        Usage tokenTotal() const;
+        Usage importCacheTotal() const;
+        Usage total() const;
+
+        std::string toJSON() const;
+    };
+
+    /**
+     * @brief Build a report covering everything reachable from `Modules::importCache`
+     */
+    Report collect();
+  };
+};
+
+#endif // ALTACORE_MEMORY_HPP
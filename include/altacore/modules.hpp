@@ -8,6 +8,7 @@
 #include <functional>
 #include <stdexcept>
 #include <memory>
+#include <chrono>
 #include "simple-map.hpp"
 
 #ifdef ALTACORE_LOCAL_SEMVER
@@ -80,14 +81,162 @@ namespace AltaCore {
       PackageInfo();
     };
 
+    /**
+     * What to throw away once a module is finished (see `finishModule`)
+     *
+     * The module's `RootNode`, `DH::RootNode`, and `DET::Module` are always kept, since
+     * later imports of the module are resolved through them. So are any statements that
+     * contain generic templates, since importers might still instantiate them.
+     */
+    struct RetentionPolicy {
+      /**
+       * Drop the module's AST statements
+       *
+       * The root's statements and their detail handles stay index-aligned: if only one of `releaseAST`
+       * and `releaseDetails` is set, released entries are replaced with `nullptr` rather than removed.
+       */
+      bool releaseAST = false;
+      /**
+       * Drop the detail handles for the module's statements (see `releaseAST`)
+       */
+      bool releaseDetails = false;
+      /**
+       * Clear the `inputScope` of any detail handles that are kept
+       */
+      bool releaseInputScopes = false;
+      /**
+       * Drop the bodies of generic instantiations. The instantiations themselves are
+       * kept (they're how existing instantiations are looked up), but can no longer be validated.
+       */
+      bool releaseGenericInstantiations = false;
+      /**
+       * Release interned types that nothing uses anymore (see `DET::Type::pruneInterned`) once
+       * the rest has been released. This also drops the cast and compatibility caches, so when finishing
+       * lots of modules at once, it's cheaper to leave this off and prune once they're all finished.
+       */
+      bool pruneInternedTypes = false;
+
+      static RetentionPolicy keepAll();
+      static RetentionPolicy releaseAll();
+    };
+
+    struct ResolutionCacheStatistics {
+      size_t hits = 0;
+      size_t misses = 0;
+      size_t invalidations = 0;
+    };
+
+    struct ImportCacheStatistics {
+      size_t hits = 0;
+      size_t misses = 0;
+      /**
+       * Requests that waited for another thread to finish parsing a module instead of parsing it again
+       */
+      size_t waits = 0;
+      /**
+       * How long each module (by absolute path) took to load, i.e. to read and parse it or to load it
+       * from the AST cache. Time spent loading the modules it imports isn't included.
+       */
+      ALTACORE_MAP<std::string, std::chrono::nanoseconds> parseLatencies;
+    };
+
+    struct PackageInfoCacheStatistics {
+      size_t hits = 0;
+      size_t misses = 0;
+    };
+
     extern std::vector<Filesystem::Path> prioritySearchPaths;
     extern std::vector<Filesystem::Path> searchPaths;
     extern Filesystem::Path standardLibraryPath;
+    /**
+     * Every module parsed so far, by absolute path
+     *
+     * The default `parseModule` guards this with a lock; only access it directly
+     * while no modules are being parsed (or use `findImport`).
+     */
+    extern ALTACORE_MAP<std::string, std::shared_ptr<AST::RootNode>> importCache;
     extern ALTACORE_MAP<std::string, Parser::PrepoExpression>* parsingDefinitions;
+    /**
+     * Defaults to resolving the module, then parsing it (or reusing it from the `importCache`)
+     *
+     * The default can be called from several threads at once: if a module is requested while another
+     * thread is already parsing it, the request waits for that parse instead of starting another one.
+     * Import cycles (which could never be parsed) throw a `ModuleError` instead of waiting forever.
+     */
     extern std::function<std::shared_ptr<AST::RootNode>(std::string importRequest, Filesystem::Path requestingModulePath)> parseModule;
+    /**
+     * @brief `parseModule` for imports found while parsing a module
+     *
+     * Records the import (and the current `parsingDefinitions`) for the importing module's AST cache
+     * entry, so that loading it from the cache can parse its imports the same way parsing it would have.
+     */
+    std::shared_ptr<AST::RootNode> parseImport(std::string importRequest, Filesystem::Path requestingModulePath);
+    /**
+     * Defaults to keeping everything
+     */
+    extern RetentionPolicy retentionPolicy;
+    /**
+     * Whether `resolve` should make sure previously resolved modules still exist before
+     * reusing them (e.g. for long-running processes that watch the filesystem)
+     *
+     * Defaults to `false`
+     */
+    extern bool revalidateResolutions;
+    /**
+     * @brief Find the module that `importRequest` refers to when imported from `relativeTo`
+     *
+     * Results are cached by request and requesting directory (modules in the same directory
+     * resolve imports identically). The cache is dropped automatically when the search paths
+     * or the standard library path change; anything else that could change the result (e.g.
+     * adding or removing modules or packages) has to call `invalidateResolutions`
+     * (which also drops the `Filesystem::StatCache`).
+     */
     Filesystem::Path resolve(std::string importRequest, Filesystem::Path relativeTo);
+    void invalidateResolutions();
+    ResolutionCacheStatistics resolutionCacheStatistics();
+    void resetResolutionCacheStatistics();
+    /**
+     * @brief Find the manifest (`package.alta.yaml`) of the package the given module or package is in
+     *
+     * The manifest found for each directory along the way is remembered (including when
+     * there isn't one), so sibling modules don't have to check the same directories again.
+     */
     Filesystem::Path findInfo(Filesystem::Path moduleOrPackagePath);
+    /**
+     * @brief Get the information in the manifest of the package the given module or package is in
+     *
+     * Manifests are only parsed again if they've been modified since the last time they were read
+     * (according to the `Filesystem::StatCache`).
+     */
     PackageInfo getInfo(Filesystem::Path moduleOrPackagePath, bool findInfo = true);
+    /**
+     * @brief Forget every manifest found by `findInfo` and read by `getInfo`
+     *
+     * Call this when manifests are added or removed (it also drops the `Filesystem::StatCache`).
+     */
+    void invalidatePackageInfo();
+    PackageInfoCacheStatistics packageInfoCacheStatistics();
+    void resetPackageInfoCacheStatistics();
+    /**
+     * @brief Let us know that we're done with a module (i.e. it's been validated and its
+     * backend output has been produced) so its parse artifacts and transient detailing state
+     * can be freed according to `retentionPolicy`
+     *
+     * Modules that haven't been detailed yet are left untouched.
+     */
+    void finishModule(std::shared_ptr<AST::RootNode> root);
+    /**
+     * @brief Same as above, but looks up the module in `importCache`
+     */
+    void finishModule(Filesystem::Path modulePath);
+    /**
+     * @brief Look up an already-parsed module in the `importCache`
+     *
+     * @return std::shared_ptr<AST::RootNode> The module, or `nullptr` if it hasn't been parsed (yet)
+     */
+    std::shared_ptr<AST::RootNode> findImport(Filesystem::Path modulePath);
+    ImportCacheStatistics importCacheStatistics();
+    void resetImportCacheStatistics();
   };
 };
 
@@ -369,6 +369,15 @@ namespace AltaCore {
         ALTACORE_MAP<std::string, PrepoExpression>& definitions;
 
         void parse();
+        /**
+         * The token buffers this parser holds on to (for memory accounting)
+         */
+        const std::vector<Token>& getTokens() const {
+          return tokens;
+        };
+        const std::vector<Token>& getOriginalTokens() const {
+          return originalTokens;
+        };
         void reset() {
           currentState = State();
           root = nullptr;
@@ -0,0 +1,106 @@
+#ifndef ALTACORE_SERIALIZATION_HPP
+#define ALTACORE_SERIALIZATION_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <functional>
+#include <cinttypes>
+#include "fs.hpp"
+#include "simple-map.hpp"
+
+namespace AltaCore {
+  namespace Serialization {
+    class FormatError: public std::runtime_error {
+      public:
+        FormatError(std::string what = "malformed serialized data"):
+          runtime_error(what)
+          {};
+    };
+
+    static const uint64_t hashSeed = 0xcbf29ce484222325ULL;
+
+    /**
+     * 64-bit FNV-1a; stable across runs and platforms, so it's safe to persist
+     */
+    uint64_t hash(const char* data, size_t size, uint64_t seed = hashSeed);
+    uint64_t hash(const std::string& data, uint64_t seed = hashSeed);
+
+    /**
+     * Appends LEB128-encoded integers and interned strings to a byte buffer
+     */
+    class Writer {
+      private:
+        ALTACORE_MAP<std::string, size_t> strings;
+
+      public:
+        std::string buffer;
+
+        void writeVarint(uint64_t value);
+        void writeBool(bool value);
+        void writeRaw(const char* data, size_t size);
+        /**
+         * Strings are interned: the first occurrence is written out in full (tagged with 0),
+         * every later occurrence is just a reference to its index (plus one)
+         */
+        void writeString(const std::string& value);
+        void writeStrings(const std::vector<std::string>& values);
+
+        template<typename T>
+        void writeEnum(T value) {
+          writeVarint(static_cast<uint64_t>(value));
+        };
+    };
+
+    /**
+     * Reads back what a `Writer` wrote. Every read is bounds-checked;
+     * malformed input results in a `FormatError`, never in a crash
+     */
+    class Reader {
+      private:
+        const char* data;
+        size_t size;
+        size_t offset = 0;
+        std::vector<std::string> strings;
+        // paths tend to repeat a lot (e.g. node positions), so only parse each one once
+        std::vector<std::shared_ptr<Filesystem::Path>> paths;
+
+        void ensure(size_t count);
+        size_t readStringIndex();
+
+      public:
+        Reader(const char* data, size_t size);
+
+        bool atEnd() const;
+
+        uint64_t readVarint();
+        bool readBool();
+        void readRaw(char* destination, size_t count);
+        std::string readString();
+        std::vector<std::string> readStrings();
+        Filesystem::Path readPath();
+
+        template<typename T>
+        T readEnum() {
+          return static_cast<T>(readVarint());
+        };
+    };
+
+    /**
+     * @brief Map a file into memory (or read it, where mapping isn't available) and hand its contents to `reader`
+     *
+     * @return bool `false` if the file couldn't be opened or is empty, `true` otherwise
+     */
+    bool readFile(Filesystem::Path path, std::function<void(const char* data, size_t size)> reader);
+    /**
+     * @brief Replace the contents of a file in a single step by writing to a temporary file first,
+     * so that readers (possibly in other processes) never see a partially written file
+     *
+     * @return bool Whether the file was written
+     */
+    bool writeFileAtomically(Filesystem::Path path, const std::string& data);
+  };
+};
+
+#endif // ALTACORE_SERIALIZATION_HPP
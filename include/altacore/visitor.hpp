@@ -0,0 +1,213 @@
+#ifndef ALTACORE_VISITOR_HPP
+#define ALTACORE_VISITOR_HPP
+
+#include <memory>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <exception>
+
+namespace AltaCore {
+  namespace AST {
+    class Node;
+  };
+  namespace DetailHandles {
+    class Node;
+  };
+  namespace DH = DetailHandles;
+
+  namespace Visiting {
+    /**
+     * What a visitor wants the traversal to do after one of its hooks returns
+     */
+    enum class Action {
+      /**
+       * Keep going as usual
+       */
+      Continue,
+      /**
+       * Don't descend into the current node's children
+       *
+       * Only meaningful when returned from `enter`; the node's `leave` hook is still called
+       */
+      SkipChildren,
+      /**
+       * Abort the entire traversal as soon as possible
+       */
+      Stop,
+    };
+
+    /**
+     * Specialized for each kind of node tree we know how to walk.
+     * Must provide a static `children` method that returns the direct
+     * children of a node in source order (null children may be included; they're skipped)
+     */
+    template<typename NodeT>
+    struct ChildTraits;
+
+    template<> struct ChildTraits<AST::Node> {
+      static std::vector<std::shared_ptr<AST::Node>> children(std::shared_ptr<AST::Node> node);
+    };
+    template<> struct ChildTraits<DH::Node> {
+      static std::vector<std::shared_ptr<DH::Node>> children(std::shared_ptr<DH::Node> node);
+    };
+
+    template<typename NodeT>
+    class BasicVisitor {
+      public:
+        using NodePointer = std::shared_ptr<NodeT>;
+        using Factory = std::function<std::shared_ptr<BasicVisitor<NodeT>>(size_t workerIndex)>;
+
+      private:
+        std::atomic<bool>* sharedStop = nullptr;
+
+        bool stopRequested() const {
+          return sharedStop && sharedStop->load(std::memory_order_relaxed);
+        };
+
+      public:
+        virtual ~BasicVisitor() = default;
+
+        /**
+         * Called before a node's children are visited
+         */
+        virtual Action enter(NodePointer) {
+          return Action::Continue;
+        };
+        /**
+         * Called after a node's children have been visited (or skipped)
+         */
+        virtual Action leave(NodePointer) {
+          return Action::Continue;
+        };
+
+        /**
+         * @brief Walk the tree rooted at `root` in depth-first order
+         *
+         * The walk uses an explicit stack instead of native recursion,
+         * so deeply nested trees won't overflow the call stack.
+         *
+         * @return bool `false` if the traversal was stopped early, `true` otherwise
+         */
+        bool visit(NodePointer root) {
+          struct Frame {
+            NodePointer node;
+            std::vector<NodePointer> children;
+            size_t next = 0;
+          };
+
+          std::vector<Frame> stack;
+
+          auto begin = [&](NodePointer node) -> bool {
+            auto action = enter(node);
+            if (action == Action::Stop) return false;
+            if (action == Action::SkipChildren) {
+              return leave(node) != Action::Stop;
+            }
+            stack.push_back(Frame { node, ChildTraits<NodeT>::children(node) });
+            return true;
+          };
+
+          if (!root) return true;
+          if (!begin(root)) return false;
+
+          while (stack.size() > 0) {
+            if (stopRequested()) return false;
+            auto& frame = stack.back();
+            if (frame.next < frame.children.size()) {
+              auto child = frame.children[frame.next++];
+              if (!child) continue;
+              // careful: `frame` is invalidated once `begin` pushes a new frame
+              if (!begin(child)) return false;
+            } else {
+              auto node = frame.node;
+              stack.pop_back();
+              if (leave(node) == Action::Stop) return false;
+            }
+          }
+
+          return true;
+        };
+
+        /**
+         * @brief Walk several independent trees (e.g. the top-level statements of a module) concurrently
+         *
+         * Each worker thread gets its own visitor from `makeVisitor`, so visitors never have to
+         * synchronize with each other; anything they share is their responsibility. If any visitor
+         * returns `Action::Stop`, every worker stops as soon as it reaches its next node. The first
+         * exception thrown by a visitor is rethrown on the calling thread once all workers are done.
+         *
+         * @param workerCount How many threads to use. `0` means one per hardware thread.
+         * @return bool `false` if the traversal was stopped early, `true` otherwise
+         */
+        static bool visitParallel(const std::vector<NodePointer>& roots, Factory makeVisitor, size_t workerCount = 0) {
+          if (workerCount == 0) {
+            workerCount = std::thread::hardware_concurrency();
+          }
+          if (workerCount == 0) {
+            workerCount = 1;
+          }
+          if (workerCount > roots.size()) {
+            workerCount = roots.size();
+          }
+
+          std::atomic<bool> stopped(false);
+          std::atomic<size_t> nextRoot(0);
+          std::exception_ptr error = nullptr;
+          std::mutex errorMutex;
+
+          auto work = [&](size_t workerIndex) {
+            try {
+              auto visitor = makeVisitor(workerIndex);
+              visitor->sharedStop = &stopped;
+              for (size_t i = nextRoot++; i < roots.size(); i = nextRoot++) {
+                if (stopped.load(std::memory_order_relaxed)) break;
+                if (!visitor->visit(roots[i])) {
+                  stopped = true;
+                  break;
+                }
+              }
+              visitor->sharedStop = nullptr;
+            } catch (...) {
+              std::lock_guard<std::mutex> lock(errorMutex);
+              if (!error) {
+                error = std::current_exception();
+              }
+              stopped = true;
+            }
+          };
+
+          // the calling thread does its share of the work, too
+          std::vector<std::thread> workers;
+          for (size_t i = 1; i < workerCount; i++) {
+            workers.emplace_back(work, i);
+          }
+          if (workerCount > 0) {
+            work(0);
+          }
+          for (auto& worker: workers) {
+            worker.join();
+          }
+
+          if (error) {
+            std::rethrow_exception(error);
+          }
+
+          return !stopped;
+        };
+    };
+  };
+
+  namespace AST {
+    using Visitor = Visiting::BasicVisitor<Node>;
+    using VisitAction = Visiting::Action;
+  };
+  namespace DetailHandles {
+    using Visitor = Visiting::BasicVisitor<Node>;
+    using VisitAction = Visiting::Action;
+  };
+};
+
+#endif // ALTACORE_VISITOR_HPP
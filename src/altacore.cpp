@@ -15,6 +15,10 @@
 void AltaCore::registerGlobalAttributes() {
   AC_ATTRIBUTE(FunctionDefinitionNode, "read");
     info->function->isAccessor = true;
+    // the function might already be in a scope, and accessors are looked up differently
+    if (auto scope = info->function->parentScope.lock()) {
+      scope->items.touch();
+    }
   AC_END_ATTRIBUTE;
 
   AC_ATTRIBUTE(ClassSpecialMethodDefinitionStatement, "copy");
@@ -69,6 +73,7 @@ void AltaCore::registerGlobalAttributes() {
 
   AC_ATTRIBUTE(FunctionDefinitionNode, "virtual");
     info->function->_virtual = true;
+    DET::Class::invalidateHierarchies();
   AC_END_ATTRIBUTE;
 
   AC_ATTRIBUTE(FunctionDefinitionNode, "override");
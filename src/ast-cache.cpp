@@ -0,0 +1,1025 @@
+#include "../include/altacore/ast-cache.hpp"
+#include "../include/altacore/ast.hpp"
+#include "../include/altacore/parser.hpp"
+#include <algorithm>
+#include <sstream>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+namespace AltaCore {
+  namespace ASTCache {
+    Filesystem::Path cacheDirectory;
+  };
+};
+
+namespace {
+  using namespace AltaCore;
+
+  // bump this whenever the encoding (or any serialized AST node) changes
+  static const uint64_t formatVersion = 2;
+  static const char magic[8] = { 'A', 'L', 'T', 'A', 'A', 'S', 'T', '\0' };
+
+  static uint64_t hashDefinitions(const ASTCache::Definitions& definitions) {
+    // the map's iteration order is unspecified, so hash it in a stable order
+    std::vector<std::string> keys;
+    keys.reserve(definitions.size());
+    for (auto& [key, value]: definitions) {
+      keys.push_back(key);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    auto hash = Serialization::hashSeed;
+    for (auto& key: keys) {
+      auto& value = definitions.at(key);
+      hash = Serialization::hash(key, hash);
+      char tag[3] = {
+        static_cast<char>(value.type),
+        static_cast<char>(value.defined),
+        static_cast<char>(value.type == Parser::PrepoExpressionType::Boolean && value.boolean),
+      };
+      hash = Serialization::hash(tag, sizeof(tag), hash);
+      if (value.type == Parser::PrepoExpressionType::String) {
+        hash = Serialization::hash(value.string, hash);
+      }
+    }
+    return hash;
+  };
+
+  static int64_t modificationTimeOf(const std::string& path) {
+#if defined(_WIN32) || defined(_WIN64)
+    struct _stat buf;
+    if (_stat(path.c_str(), &buf) != 0) return 0;
+#else
+    struct stat buf;
+    if (stat(path.c_str(), &buf) != 0) return 0;
+#endif
+    return static_cast<int64_t>(buf.st_mtime);
+  };
+
+  class Encoder: public Serialization::Writer {
+    public:
+      void writeDefinitions(const ASTCache::Definitions& definitions) {
+        writeVarint(definitions.size());
+        for (auto& [key, value]: definitions) {
+          writeString(key);
+          writeEnum(value.type);
+          writeBool(value.defined);
+          writeBool(value.type == Parser::PrepoExpressionType::Boolean && value.boolean);
+          writeString(value.string);
+        }
+      };
+
+      template<typename T>
+      void writeNodes(const std::vector<std::shared_ptr<T>>& nodes) {
+        writeVarint(nodes.size());
+        for (auto& node: nodes) {
+          writeNode(node);
+        }
+      };
+
+      void writeNode(std::shared_ptr<AST::Node> node);
+  };
+
+  class Decoder: public Serialization::Reader {
+    public:
+      Decoder(const char* data, size_t size):
+        Reader(data, size)
+        {};
+
+      void readDefinitions(ASTCache::Definitions& definitions) {
+        auto count = readVarint();
+        for (uint64_t i = 0; i < count; i++) {
+          auto key = readString();
+          Parser::PrepoExpression value;
+          value.type = readEnum<Parser::PrepoExpressionType>();
+          value.defined = readBool();
+          value.boolean = readBool();
+          value.string = readString();
+          definitions[key] = value;
+        }
+      };
+
+      std::shared_ptr<AST::Node> readAnyNode();
+
+      template<typename T>
+      std::shared_ptr<T> readNode() {
+        auto node = readAnyNode();
+        if (!node) return nullptr;
+        auto target = std::dynamic_pointer_cast<T>(node);
+        if (!target) {
+          throw ASTCache::CorruptCacheError("unexpected node type in AST cache entry");
+        }
+        return target;
+      };
+      template<typename T>
+      std::vector<std::shared_ptr<T>> readNodes() {
+        std::vector<std::shared_ptr<T>> nodes;
+        auto count = readVarint();
+        for (uint64_t i = 0; i < count; i++) {
+          nodes.push_back(readNode<T>());
+        }
+        return nodes;
+      };
+  };
+
+#define AC_ENCODE(x) case AST::NodeType::x: { auto target = std::static_pointer_cast<AST::x>(node);
+#define AC_END_ENCODE } break;
+
+  void Encoder::writeNode(std::shared_ptr<AST::Node> node) {
+    if (!node) {
+      writeVarint(0);
+      return;
+    }
+
+    auto type = node->nodeType();
+    writeVarint(static_cast<uint64_t>(type) + 1);
+    writeVarint(node->position.line);
+    writeVarint(node->position.column);
+    writeVarint(node->position.filePosition);
+    writeString(node->position.file.toString());
+
+    switch (type) {
+      AC_ENCODE(RootNode)
+        writeNodes(target->statements);
+      AC_END_ENCODE
+      AC_ENCODE(ExpressionStatement)
+        writeNode(target->expression);
+      AC_END_ENCODE
+      AC_ENCODE(Type)
+        writeBool(target->isAny);
+        writeBool(target->isFunction);
+        writeBool(target->isLambda);
+        writeNode(target->returnType);
+        writeVarint(target->parameters.size());
+        for (auto& [paramType, isVariable, name]: target->parameters) {
+          writeNode(paramType);
+          writeBool(isVariable);
+          writeString(name);
+        }
+        writeString(target->name);
+        writeVarint(target->modifiers.size());
+        for (auto modifier: target->modifiers) {
+          writeVarint(modifier);
+        }
+        writeBool(target->isNative);
+        writeNode(target->lookup);
+        writeNodes(target->unionOf);
+        writeBool(target->isOptional);
+        writeNode(target->optionalTarget);
+      AC_END_ENCODE
+      AC_ENCODE(Parameter)
+        writeString(target->name);
+        writeNode(target->type);
+        writeBool(target->isVariable);
+        writeNodes(target->attributes);
+        writeNode(target->defaultValue);
+      AC_END_ENCODE
+      AC_ENCODE(BlockNode)
+        writeNodes(target->statements);
+      AC_END_ENCODE
+      AC_ENCODE(FunctionDefinitionNode)
+        writeString(target->name);
+        writeNodes(target->parameters);
+        writeNode(target->returnType);
+        writeStrings(target->modifiers);
+        writeNode(target->body);
+        writeNodes(target->attributes);
+        writeNodes(target->generics);
+        writeNode(target->generatorParameter);
+        writeBool(target->isGenerator);
+        writeBool(target->isAsync);
+      AC_END_ENCODE
+      AC_ENCODE(ReturnDirectiveNode)
+        writeNode(target->expression);
+      AC_END_ENCODE
+      AC_ENCODE(IntegerLiteralNode)
+        writeString(target->raw);
+      AC_END_ENCODE
+      AC_ENCODE(VariableDefinitionExpression)
+        writeString(target->name);
+        writeNode(target->type);
+        writeNode(target->initializationExpression);
+        writeStrings(target->modifiers);
+      AC_END_ENCODE
+      AC_ENCODE(Accessor)
+        writeString(target->query);
+        writeNode(target->target);
+        writeNodes(target->genericArguments);
+      AC_END_ENCODE
+      AC_ENCODE(Fetch)
+        writeString(target->query);
+        writeNodes(target->genericArguments);
+      AC_END_ENCODE
+      AC_ENCODE(AssignmentExpression)
+        writeNode(target->target);
+        writeNode(target->value);
+        writeEnum(target->type);
+      AC_END_ENCODE
+      AC_ENCODE(BooleanLiteralNode)
+        writeBool(target->value);
+        writeString(target->raw);
+      AC_END_ENCODE
+      AC_ENCODE(BinaryOperation)
+        writeEnum(target->type);
+        writeNode(target->left);
+        writeNode(target->right);
+      AC_END_ENCODE
+      AC_ENCODE(ImportStatement)
+        writeBool(target->isManual);
+        writeString(target->request);
+        writeBool(target->isAliased);
+        writeVarint(target->imports.size());
+        for (auto& [name, alias]: target->imports) {
+          writeString(name);
+          writeString(alias);
+        }
+        writeString(target->alias);
+      AC_END_ENCODE
+      AC_ENCODE(FunctionCallExpression)
+        writeNode(target->target);
+        writeVarint(target->arguments.size());
+        for (auto& [name, argument]: target->arguments) {
+          writeString(name);
+          writeNode(argument);
+        }
+        writeBool(target->maybe);
+      AC_END_ENCODE
+      AC_ENCODE(StringLiteralNode)
+        writeString(target->value);
+        writeString(target->raw);
+      AC_END_ENCODE
+      AC_ENCODE(FunctionDeclarationNode)
+        writeString(target->name);
+        writeNodes(target->parameters);
+        writeNode(target->returnType);
+        writeStrings(target->modifiers);
+        writeNodes(target->attributes);
+      AC_END_ENCODE
+      AC_ENCODE(AttributeNode)
+        writeStrings(target->accessors);
+        writeNodes(target->arguments);
+      AC_END_ENCODE
+      AC_ENCODE(LiteralNode)
+        writeString(target->raw);
+      AC_END_ENCODE
+      AC_ENCODE(AttributeStatement)
+        writeNode(target->attribute);
+      AC_END_ENCODE
+      AC_ENCODE(ConditionalStatement)
+        writeNode(target->primaryTest);
+        writeNode(target->primaryResult);
+        writeVarint(target->alternatives.size());
+        for (auto& [test, result]: target->alternatives) {
+          writeNode(test);
+          writeNode(result);
+        }
+        writeNode(target->finalResult);
+      AC_END_ENCODE
+      AC_ENCODE(ConditionalExpression)
+        writeNode(target->test);
+        writeNode(target->primaryResult);
+        writeNode(target->secondaryResult);
+      AC_END_ENCODE
+      AC_ENCODE(ClassDefinitionNode)
+        writeString(target->name);
+        writeStrings(target->modifiers);
+        writeNodes(target->generics);
+        writeNodes(target->statements);
+        writeNodes(target->parents);
+        writeNodes(target->attributes);
+      AC_END_ENCODE
+      AC_ENCODE(ClassMemberDefinitionStatement)
+        writeEnum(target->visibilityModifier);
+        writeNode(target->varDef);
+      AC_END_ENCODE
+      AC_ENCODE(ClassMethodDefinitionStatement)
+        writeEnum(target->visibilityModifier);
+        writeNode(target->funcDef);
+        writeBool(target->isStatic);
+      AC_END_ENCODE
+      AC_ENCODE(ClassSpecialMethodDefinitionStatement)
+        writeEnum(target->visibilityModifier);
+        writeEnum(target->type);
+        writeNodes(target->attributes);
+        writeNodes(target->parameters);
+        writeNode(target->body);
+        writeNode(target->specialType);
+      AC_END_ENCODE
+      AC_ENCODE(ClassInstantiationExpression)
+        writeNode(target->target);
+        writeVarint(target->arguments.size());
+        for (auto& [name, argument]: target->arguments) {
+          writeString(name);
+          writeNode(argument);
+        }
+        writeBool(target->persistent);
+      AC_END_ENCODE
+      AC_ENCODE(PointerExpression)
+        writeNode(target->target);
+      AC_END_ENCODE
+      AC_ENCODE(DereferenceExpression)
+        writeNode(target->target);
+      AC_END_ENCODE
+      AC_ENCODE(WhileLoopStatement)
+        writeNode(target->test);
+        writeNode(target->body);
+      AC_END_ENCODE
+      AC_ENCODE(CastExpression)
+        writeNode(target->target);
+        writeNode(target->type);
+      AC_END_ENCODE
+      AC_ENCODE(ClassReadAccessorDefinitionStatement)
+        writeEnum(target->visibilityModifier);
+        writeString(target->name);
+        writeNode(target->type);
+        writeNode(target->body);
+      AC_END_ENCODE
+      AC_ENCODE(CharacterLiteralNode)
+        writeVarint(static_cast<uint8_t>(target->value));
+        writeBool(target->escaped);
+        writeString(target->raw);
+      AC_END_ENCODE
+      AC_ENCODE(TypeAliasStatement)
+        writeStrings(target->modifiers);
+        writeString(target->name);
+        writeNode(target->type);
+        writeNodes(target->attributes);
+      AC_END_ENCODE
+      AC_ENCODE(SubscriptExpression)
+        writeNode(target->target);
+        writeNode(target->index);
+      AC_END_ENCODE
+      AC_ENCODE(RetrievalNode)
+        writeString(target->query);
+      AC_END_ENCODE
+      AC_ENCODE(SuperClassFetch)
+        writeNode(target->fetch);
+      AC_END_ENCODE
+      AC_ENCODE(InstanceofExpression)
+        writeNode(target->target);
+        writeNode(target->type);
+      AC_END_ENCODE
+      AC_ENCODE(Generic)
+        writeString(target->name);
+      AC_END_ENCODE
+      AC_ENCODE(ForLoopStatement)
+        writeNode(target->initializer);
+        writeNode(target->condition);
+        writeNode(target->increment);
+        writeNode(target->body);
+      AC_END_ENCODE
+      AC_ENCODE(RangedForLoopStatement)
+        writeString(target->counterName);
+        writeNode(target->counterType);
+        writeNode(target->start);
+        writeNode(target->end);
+        writeNode(target->body);
+        writeBool(target->decrement);
+        writeBool(target->inclusive);
+      AC_END_ENCODE
+      AC_ENCODE(UnaryOperation)
+        writeEnum(target->type);
+        writeNode(target->target);
+      AC_END_ENCODE
+      AC_ENCODE(SizeofOperation)
+        writeNode(target->target);
+      AC_END_ENCODE
+      AC_ENCODE(FloatingPointLiteralNode)
+        writeString(target->raw);
+      AC_END_ENCODE
+      AC_ENCODE(StructureDefinitionStatement)
+        writeBool(target->isExternal);
+        writeBool(target->isTyped);
+        writeStrings(target->modifiers);
+        writeString(target->name);
+        writeVarint(target->members.size());
+        for (auto& [memberType, name]: target->members) {
+          writeNode(memberType);
+          writeString(name);
+        }
+        writeNodes(target->attributes);
+      AC_END_ENCODE
+      AC_ENCODE(ExportStatement)
+        writeVarint(target->localTargets.size());
+        for (auto& [retrieval, alias]: target->localTargets) {
+          writeNode(retrieval);
+          writeString(alias);
+        }
+        writeNode(target->externalTarget);
+      AC_END_ENCODE
+      AC_ENCODE(VariableDeclarationStatement)
+        writeString(target->name);
+        writeNode(target->type);
+        writeStrings(target->modifiers);
+        writeNodes(target->attributes);
+      AC_END_ENCODE
+      AC_ENCODE(AliasStatement)
+        writeNode(target->target);
+        writeString(target->name);
+      AC_END_ENCODE
+      AC_ENCODE(DeleteStatement)
+        writeBool(target->persistent);
+        writeNode(target->target);
+      AC_END_ENCODE
+      AC_ENCODE(ControlDirective)
+        writeBool(target->isBreak);
+      AC_END_ENCODE
+      AC_ENCODE(TryCatchBlock)
+        writeNode(target->tryBlock);
+        writeStrings(target->catchIDs);
+        writeVarint(target->catchBlocks.size());
+        for (auto& [catchType, block]: target->catchBlocks) {
+          writeNode(catchType);
+          writeNode(block);
+        }
+        writeNode(target->catchAllBlock);
+      AC_END_ENCODE
+      AC_ENCODE(ThrowStatement)
+        writeNode(target->expression);
+      AC_END_ENCODE
+      AC_ENCODE(NullptrExpression)
+      AC_END_ENCODE
+      AC_ENCODE(CodeLiteralNode)
+        writeString(target->raw);
+        writeNodes(target->attributes);
+      AC_END_ENCODE
+      AC_ENCODE(BitfieldDefinitionNode)
+        writeStrings(target->modifiers);
+        writeNode(target->underlyingType);
+        writeString(target->name);
+        writeVarint(target->members.size());
+        for (auto& [memberType, name, start, end]: target->members) {
+          writeNode(memberType);
+          writeString(name);
+          writeVarint(start);
+          writeVarint(end);
+        }
+        writeNodes(target->attributes);
+      AC_END_ENCODE
+      AC_ENCODE(LambdaExpression)
+        writeNodes(target->parameters);
+        writeNode(target->returnType);
+        writeNode(target->generatorParameter);
+        writeStrings(target->modifiers);
+        writeNode(target->body);
+        writeBool(target->isGenerator);
+        writeBool(target->isAsync);
+      AC_END_ENCODE
+      AC_ENCODE(SpecialFetchExpression)
+        writeString(target->query);
+      AC_END_ENCODE
+      AC_ENCODE(ClassOperatorDefinitionStatement)
+        writeEnum(target->visibilityModifier);
+        writeEnum(target->type);
+        writeEnum(target->orientation);
+        writeNode(target->block);
+        writeNode(target->returnType);
+        writeNode(target->argumentType);
+      AC_END_ENCODE
+      AC_ENCODE(EnumerationDefinitionNode)
+        writeStrings(target->modifiers);
+        writeString(target->name);
+        writeNode(target->underlyingType);
+        writeVarint(target->members.size());
+        for (auto& [name, value]: target->members) {
+          writeString(name);
+          writeNode(value);
+        }
+      AC_END_ENCODE
+      AC_ENCODE(YieldExpression)
+        writeNode(target->target);
+      AC_END_ENCODE
+      AC_ENCODE(AssertionStatement)
+        writeNode(target->test);
+      AC_END_ENCODE
+      AC_ENCODE(AwaitExpression)
+        writeNode(target->target);
+      AC_END_ENCODE
+      AC_ENCODE(VoidExpression)
+      AC_END_ENCODE
+      default: {
+        throw std::runtime_error("can't cache AST nodes of this type");
+      }
+    }
+
+    if (auto expr = std::dynamic_pointer_cast<AST::ExpressionNode>(node)) {
+      writeNodes(expr->attributes);
+    }
+  };
+
+#define AC_DECODE(x) case AST::NodeType::x: { auto target = std::make_shared<AST::x>
+#define AC_DECODE_BODY node = target;
+#define AC_END_DECODE } break;
+
+  std::shared_ptr<AST::Node> Decoder::readAnyNode() {
+    auto tag = readVarint();
+    if (tag == 0) {
+      return nullptr;
+    }
+
+    auto type = static_cast<AST::NodeType>(tag - 1);
+    Errors::Position position;
+    position.line = readVarint();
+    position.column = readVarint();
+    position.filePosition = readVarint();
+    position.file = readPath();
+
+    std::shared_ptr<AST::Node> node = nullptr;
+
+    switch (type) {
+      AC_DECODE(RootNode)(); AC_DECODE_BODY
+        target->statements = readNodes<AST::StatementNode>();
+      AC_END_DECODE
+      AC_DECODE(ExpressionStatement)(); AC_DECODE_BODY
+        target->expression = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(Type)(); AC_DECODE_BODY
+        target->isAny = readBool();
+        target->isFunction = readBool();
+        target->isLambda = readBool();
+        target->returnType = readNode<AST::Type>();
+        auto paramCount = readVarint();
+        for (uint64_t i = 0; i < paramCount; i++) {
+          auto paramType = readNode<AST::Type>();
+          auto isVariable = readBool();
+          auto name = readString();
+          target->parameters.emplace_back(paramType, isVariable, name);
+        }
+        target->name = readString();
+        auto modifierCount = readVarint();
+        for (uint64_t i = 0; i < modifierCount; i++) {
+          target->modifiers.push_back(static_cast<uint8_t>(readVarint()));
+        }
+        target->isNative = readBool();
+        target->lookup = readNode<AST::ExpressionNode>();
+        target->unionOf = readNodes<AST::Type>();
+        target->isOptional = readBool();
+        target->optionalTarget = readNode<AST::Type>();
+      AC_END_DECODE
+      AC_DECODE(Parameter)(); AC_DECODE_BODY
+        target->name = readString();
+        target->type = readNode<AST::Type>();
+        target->isVariable = readBool();
+        target->attributes = readNodes<AST::AttributeNode>();
+        target->defaultValue = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(BlockNode)(); AC_DECODE_BODY
+        target->statements = readNodes<AST::StatementNode>();
+      AC_END_DECODE
+      AC_DECODE(FunctionDefinitionNode)(); AC_DECODE_BODY
+        target->name = readString();
+        target->parameters = readNodes<AST::Parameter>();
+        target->returnType = readNode<AST::Type>();
+        target->modifiers = readStrings();
+        target->body = readNode<AST::BlockNode>();
+        target->attributes = readNodes<AST::AttributeNode>();
+        target->generics = readNodes<AST::Generic>();
+        target->generatorParameter = readNode<AST::Type>();
+        target->isGenerator = readBool();
+        target->isAsync = readBool();
+      AC_END_DECODE
+      AC_DECODE(ReturnDirectiveNode)(nullptr); AC_DECODE_BODY
+        target->expression = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(IntegerLiteralNode)(readString()); AC_DECODE_BODY
+      AC_END_DECODE
+      AC_DECODE(VariableDefinitionExpression)(); AC_DECODE_BODY
+        target->name = readString();
+        target->type = readNode<AST::Type>();
+        target->initializationExpression = readNode<AST::ExpressionNode>();
+        target->modifiers = readStrings();
+      AC_END_DECODE
+      AC_DECODE(Accessor)(nullptr, readString()); AC_DECODE_BODY
+        target->target = readNode<AST::ExpressionNode>();
+        target->genericArguments = readNodes<AST::Type>();
+      AC_END_DECODE
+      AC_DECODE(Fetch)(readString()); AC_DECODE_BODY
+        target->genericArguments = readNodes<AST::Type>();
+      AC_END_DECODE
+      AC_DECODE(AssignmentExpression)(); AC_DECODE_BODY
+        target->target = readNode<AST::ExpressionNode>();
+        target->value = readNode<AST::ExpressionNode>();
+        target->type = readEnum<Shared::AssignmentType>();
+      AC_END_DECODE
+      AC_DECODE(BooleanLiteralNode)(readBool()); AC_DECODE_BODY
+        target->raw = readString();
+      AC_END_DECODE
+      AC_DECODE(BinaryOperation)(); AC_DECODE_BODY
+        target->type = readEnum<Shared::OperatorType>();
+        target->left = readNode<AST::ExpressionNode>();
+        target->right = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(ImportStatement)(); AC_DECODE_BODY
+        target->isManual = readBool();
+        target->request = readString();
+        target->isAliased = readBool();
+        auto importCount = readVarint();
+        for (uint64_t i = 0; i < importCount; i++) {
+          auto name = readString();
+          auto alias = readString();
+          target->imports.emplace_back(name, alias);
+        }
+        target->alias = readString();
+      AC_END_DECODE
+      AC_DECODE(FunctionCallExpression)(); AC_DECODE_BODY
+        target->target = readNode<AST::ExpressionNode>();
+        auto argumentCount = readVarint();
+        for (uint64_t i = 0; i < argumentCount; i++) {
+          auto name = readString();
+          auto argument = readNode<AST::ExpressionNode>();
+          target->arguments.emplace_back(name, argument);
+        }
+        target->maybe = readBool();
+      AC_END_DECODE
+      AC_DECODE(StringLiteralNode)(readString()); AC_DECODE_BODY
+        target->raw = readString();
+      AC_END_DECODE
+      AC_DECODE(FunctionDeclarationNode)(); AC_DECODE_BODY
+        target->name = readString();
+        target->parameters = readNodes<AST::Parameter>();
+        target->returnType = readNode<AST::Type>();
+        target->modifiers = readStrings();
+        target->attributes = readNodes<AST::AttributeNode>();
+      AC_END_DECODE
+      AC_DECODE(AttributeNode)(); AC_DECODE_BODY
+        target->accessors = readStrings();
+        target->arguments = readNodes<AST::Node>();
+      AC_END_DECODE
+      AC_DECODE(LiteralNode)(readString()); AC_DECODE_BODY
+      AC_END_DECODE
+      AC_DECODE(AttributeStatement)(nullptr); AC_DECODE_BODY
+        target->attribute = readNode<AST::AttributeNode>();
+      AC_END_DECODE
+      AC_DECODE(ConditionalStatement)(); AC_DECODE_BODY
+        target->primaryTest = readNode<AST::ExpressionNode>();
+        target->primaryResult = readNode<AST::StatementNode>();
+        auto alternativeCount = readVarint();
+        for (uint64_t i = 0; i < alternativeCount; i++) {
+          auto test = readNode<AST::ExpressionNode>();
+          auto result = readNode<AST::StatementNode>();
+          target->alternatives.emplace_back(test, result);
+        }
+        target->finalResult = readNode<AST::StatementNode>();
+      AC_END_DECODE
+      AC_DECODE(ConditionalExpression)(); AC_DECODE_BODY
+        target->test = readNode<AST::ExpressionNode>();
+        target->primaryResult = readNode<AST::ExpressionNode>();
+        target->secondaryResult = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(ClassDefinitionNode)(readString()); AC_DECODE_BODY
+        target->modifiers = readStrings();
+        target->generics = readNodes<AST::Generic>();
+        target->statements = readNodes<AST::ClassStatementNode>();
+        target->parents = readNodes<AST::RetrievalNode>();
+        target->attributes = readNodes<AST::AttributeNode>();
+      AC_END_DECODE
+      AC_DECODE(ClassMemberDefinitionStatement)(readEnum<Shared::Visibility>()); AC_DECODE_BODY
+        target->varDef = readNode<AST::VariableDefinitionExpression>();
+      AC_END_DECODE
+      AC_DECODE(ClassMethodDefinitionStatement)(readEnum<Shared::Visibility>()); AC_DECODE_BODY
+        target->funcDef = readNode<AST::FunctionDefinitionNode>();
+        target->isStatic = readBool();
+      AC_END_DECODE
+      case AST::NodeType::ClassSpecialMethodDefinitionStatement: {
+        auto visibility = readEnum<Shared::Visibility>();
+        auto specialType = readEnum<AST::SpecialClassMethod>();
+        auto target = std::make_shared<AST::ClassSpecialMethodDefinitionStatement>(visibility, specialType);
+        node = target;
+        target->attributes = readNodes<AST::AttributeNode>();
+        target->parameters = readNodes<AST::Parameter>();
+        target->body = readNode<AST::BlockNode>();
+        target->specialType = readNode<AST::Type>();
+      } break;
+      AC_DECODE(ClassInstantiationExpression)(); AC_DECODE_BODY
+        target->target = readNode<AST::ExpressionNode>();
+        auto argumentCount = readVarint();
+        for (uint64_t i = 0; i < argumentCount; i++) {
+          auto name = readString();
+          auto argument = readNode<AST::ExpressionNode>();
+          target->arguments.emplace_back(name, argument);
+        }
+        target->persistent = readBool();
+      AC_END_DECODE
+      AC_DECODE(PointerExpression)(); AC_DECODE_BODY
+        target->target = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(DereferenceExpression)(); AC_DECODE_BODY
+        target->target = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(WhileLoopStatement)(); AC_DECODE_BODY
+        target->test = readNode<AST::ExpressionNode>();
+        target->body = readNode<AST::StatementNode>();
+      AC_END_DECODE
+      AC_DECODE(CastExpression)(); AC_DECODE_BODY
+        target->target = readNode<AST::ExpressionNode>();
+        target->type = readNode<AST::Type>();
+      AC_END_DECODE
+      AC_DECODE(ClassReadAccessorDefinitionStatement)(readEnum<Shared::Visibility>()); AC_DECODE_BODY
+        target->name = readString();
+        target->type = readNode<AST::Type>();
+        target->body = readNode<AST::BlockNode>();
+      AC_END_DECODE
+      case AST::NodeType::CharacterLiteralNode: {
+        auto value = static_cast<char>(readVarint());
+        auto escaped = readBool();
+        auto target = std::make_shared<AST::CharacterLiteralNode>(value, escaped);
+        node = target;
+        target->raw = readString();
+      } break;
+      AC_DECODE(TypeAliasStatement)(); AC_DECODE_BODY
+        target->modifiers = readStrings();
+        target->name = readString();
+        target->type = readNode<AST::Type>();
+        target->attributes = readNodes<AST::AttributeNode>();
+      AC_END_DECODE
+      AC_DECODE(SubscriptExpression)(); AC_DECODE_BODY
+        target->target = readNode<AST::ExpressionNode>();
+        target->index = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(RetrievalNode)(readString()); AC_DECODE_BODY
+      AC_END_DECODE
+      AC_DECODE(SuperClassFetch)(); AC_DECODE_BODY
+        target->fetch = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(InstanceofExpression)(); AC_DECODE_BODY
+        target->target = readNode<AST::ExpressionNode>();
+        target->type = readNode<AST::Type>();
+      AC_END_DECODE
+      AC_DECODE(Generic)(readString()); AC_DECODE_BODY
+      AC_END_DECODE
+      AC_DECODE(ForLoopStatement)(); AC_DECODE_BODY
+        target->initializer = readNode<AST::ExpressionNode>();
+        target->condition = readNode<AST::ExpressionNode>();
+        target->increment = readNode<AST::ExpressionNode>();
+        target->body = readNode<AST::StatementNode>();
+      AC_END_DECODE
+      AC_DECODE(RangedForLoopStatement)(); AC_DECODE_BODY
+        target->counterName = readString();
+        target->counterType = readNode<AST::Type>();
+        target->start = readNode<AST::ExpressionNode>();
+        target->end = readNode<AST::ExpressionNode>();
+        target->body = readNode<AST::StatementNode>();
+        target->decrement = readBool();
+        target->inclusive = readBool();
+      AC_END_DECODE
+      AC_DECODE(UnaryOperation)(); AC_DECODE_BODY
+        target->type = readEnum<Shared::UOperatorType>();
+        target->target = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(SizeofOperation)(); AC_DECODE_BODY
+        target->target = readNode<AST::Type>();
+      AC_END_DECODE
+      AC_DECODE(FloatingPointLiteralNode)(readString()); AC_DECODE_BODY
+      AC_END_DECODE
+      AC_DECODE(StructureDefinitionStatement)(); AC_DECODE_BODY
+        target->isExternal = readBool();
+        target->isTyped = readBool();
+        target->modifiers = readStrings();
+        target->name = readString();
+        auto memberCount = readVarint();
+        for (uint64_t i = 0; i < memberCount; i++) {
+          auto memberType = readNode<AST::Type>();
+          auto name = readString();
+          target->members.emplace_back(memberType, name);
+        }
+        target->attributes = readNodes<AST::AttributeNode>();
+      AC_END_DECODE
+      AC_DECODE(ExportStatement)(); AC_DECODE_BODY
+        auto localCount = readVarint();
+        for (uint64_t i = 0; i < localCount; i++) {
+          auto retrieval = readNode<AST::RetrievalNode>();
+          auto alias = readString();
+          target->localTargets.emplace_back(retrieval, alias);
+        }
+        target->externalTarget = readNode<AST::ImportStatement>();
+      AC_END_DECODE
+      AC_DECODE(VariableDeclarationStatement)(); AC_DECODE_BODY
+        target->name = readString();
+        target->type = readNode<AST::Type>();
+        target->modifiers = readStrings();
+        target->attributes = readNodes<AST::AttributeNode>();
+      AC_END_DECODE
+      AC_DECODE(AliasStatement)(); AC_DECODE_BODY
+        target->target = readNode<AST::RetrievalNode>();
+        target->name = readString();
+      AC_END_DECODE
+      AC_DECODE(DeleteStatement)(); AC_DECODE_BODY
+        target->persistent = readBool();
+        target->target = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(ControlDirective)(); AC_DECODE_BODY
+        target->isBreak = readBool();
+      AC_END_DECODE
+      AC_DECODE(TryCatchBlock)(); AC_DECODE_BODY
+        target->tryBlock = readNode<AST::StatementNode>();
+        target->catchIDs = readStrings();
+        auto catchCount = readVarint();
+        for (uint64_t i = 0; i < catchCount; i++) {
+          auto catchType = readNode<AST::Type>();
+          auto block = readNode<AST::StatementNode>();
+          target->catchBlocks.emplace_back(catchType, block);
+        }
+        target->catchAllBlock = readNode<AST::StatementNode>();
+      AC_END_DECODE
+      AC_DECODE(ThrowStatement)(); AC_DECODE_BODY
+        target->expression = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(NullptrExpression)(); AC_DECODE_BODY
+      AC_END_DECODE
+      AC_DECODE(CodeLiteralNode)(readString()); AC_DECODE_BODY
+        target->attributes = readNodes<AST::AttributeNode>();
+      AC_END_DECODE
+      AC_DECODE(BitfieldDefinitionNode)(); AC_DECODE_BODY
+        target->modifiers = readStrings();
+        target->underlyingType = readNode<AST::Type>();
+        target->name = readString();
+        auto memberCount = readVarint();
+        for (uint64_t i = 0; i < memberCount; i++) {
+          auto memberType = readNode<AST::Type>();
+          auto name = readString();
+          size_t start = readVarint();
+          size_t end = readVarint();
+          target->members.emplace_back(memberType, name, start, end);
+        }
+        target->attributes = readNodes<AST::AttributeNode>();
+      AC_END_DECODE
+      AC_DECODE(LambdaExpression)(); AC_DECODE_BODY
+        target->parameters = readNodes<AST::Parameter>();
+        target->returnType = readNode<AST::Type>();
+        target->generatorParameter = readNode<AST::Type>();
+        target->modifiers = readStrings();
+        target->body = readNode<AST::BlockNode>();
+        target->isGenerator = readBool();
+        target->isAsync = readBool();
+      AC_END_DECODE
+      AC_DECODE(SpecialFetchExpression)(); AC_DECODE_BODY
+        target->query = readString();
+      AC_END_DECODE
+      AC_DECODE(ClassOperatorDefinitionStatement)(readEnum<Shared::Visibility>()); AC_DECODE_BODY
+        target->type = readEnum<Shared::ClassOperatorType>();
+        target->orientation = readEnum<Shared::ClassOperatorOrientation>();
+        target->block = readNode<AST::BlockNode>();
+        target->returnType = readNode<AST::Type>();
+        target->argumentType = readNode<AST::Type>();
+      AC_END_DECODE
+      AC_DECODE(EnumerationDefinitionNode)(); AC_DECODE_BODY
+        target->modifiers = readStrings();
+        target->name = readString();
+        target->underlyingType = readNode<AST::Type>();
+        auto memberCount = readVarint();
+        for (uint64_t i = 0; i < memberCount; i++) {
+          auto name = readString();
+          auto value = readNode<AST::ExpressionNode>();
+          target->members.emplace_back(name, value);
+        }
+      AC_END_DECODE
+      AC_DECODE(YieldExpression)(); AC_DECODE_BODY
+        target->target = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(AssertionStatement)(); AC_DECODE_BODY
+        target->test = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(AwaitExpression)(); AC_DECODE_BODY
+        target->target = readNode<AST::ExpressionNode>();
+      AC_END_DECODE
+      AC_DECODE(VoidExpression)(); AC_DECODE_BODY
+      AC_END_DECODE
+      default: {
+        throw ASTCache::CorruptCacheError("unknown node type in AST cache entry");
+      }
+    }
+
+    node->position = position;
+
+    if (auto expr = std::dynamic_pointer_cast<AST::ExpressionNode>(node)) {
+      expr->attributes = readNodes<AST::AttributeNode>();
+    }
+
+    return node;
+  };
+
+  static void writeHeader(Encoder& encoder, const ASTCache::CacheKey& key) {
+    encoder.writeRaw(magic, sizeof(magic));
+    encoder.writeVarint(formatVersion);
+    encoder.writeString(key.path);
+    encoder.writeVarint(static_cast<uint64_t>(key.modificationTime));
+    encoder.writeVarint(key.contentHash);
+    encoder.writeVarint(key.definitionsHash);
+  };
+  static void checkHeader(Decoder& decoder, const ASTCache::CacheKey& key) {
+    char fileMagic[sizeof(magic)];
+    decoder.readRaw(fileMagic, sizeof(fileMagic));
+    if (std::memcmp(fileMagic, magic, sizeof(magic)) != 0) {
+      throw ASTCache::CorruptCacheError("not an AST cache entry");
+    }
+    if (decoder.readVarint() != formatVersion) {
+      throw ASTCache::CorruptCacheError("AST cache entry is from an incompatible version");
+    }
+    ASTCache::CacheKey fileKey;
+    fileKey.path = decoder.readString();
+    fileKey.modificationTime = static_cast<int64_t>(decoder.readVarint());
+    fileKey.contentHash = decoder.readVarint();
+    fileKey.definitionsHash = decoder.readVarint();
+    if (!(fileKey == key)) {
+      throw ASTCache::CorruptCacheError("AST cache entry is stale");
+    }
+  };
+
+#undef AC_ENCODE
+#undef AC_END_ENCODE
+#undef AC_DECODE
+#undef AC_DECODE_BODY
+#undef AC_END_DECODE
+};
+
+AltaCore::ASTCache::CacheKey::CacheKey(AltaCore::Filesystem::Path modulePath, const std::string& source, const Definitions& definitions):
+  path(modulePath.absolutify().toString()),
+  contentHash(Serialization::hash(source)),
+  definitionsHash(hashDefinitions(definitions))
+{
+  modificationTime = modificationTimeOf(path);
+};
+
+bool AltaCore::ASTCache::CacheKey::operator ==(const CacheKey& other) const {
+  return path == other.path && modificationTime == other.modificationTime && contentHash == other.contentHash && definitionsHash == other.definitionsHash;
+};
+
+std::string AltaCore::ASTCache::serialize(const CacheKey& key, std::shared_ptr<AST::RootNode> root, const Definitions& definitions, const std::vector<ImportRecord>& imports) {
+  Encoder encoder;
+  writeHeader(encoder, key);
+  encoder.writeDefinitions(definitions);
+  encoder.writeVarint(imports.size());
+  for (auto& import: imports) {
+    encoder.writeString(import.request);
+    encoder.writeDefinitions(*import.definitions);
+  }
+  encoder.writeNode(root);
+  return encoder.buffer;
+};
+
+std::shared_ptr<AltaCore::AST::RootNode> AltaCore::ASTCache::deserialize(const CacheKey& key, const char* data, size_t size, Definitions& definitions, std::vector<ImportRecord>& imports) {
+  Decoder decoder(data, size);
+  checkHeader(decoder, key);
+
+  // don't touch the caller's definitions until we know the whole entry is good
+  Definitions newDefinitions;
+  decoder.readDefinitions(newDefinitions);
+  std::vector<ImportRecord> newImports;
+  auto importCount = decoder.readVarint();
+  for (uint64_t i = 0; i < importCount; i++) {
+    ImportRecord import;
+    import.request = decoder.readString();
+    import.definitions = std::make_shared<Definitions>();
+    decoder.readDefinitions(*import.definitions);
+    newImports.push_back(std::move(import));
+  }
+
+  auto root = decoder.readNode<AST::RootNode>();
+  if (!root || !decoder.atEnd()) {
+    throw CorruptCacheError("corrupt AST cache entry");
+  }
+
+  // the key pins the definitions we started with, so the ones we finished with replace them entirely
+  // (merging would resurrect anything the original parse undefined)
+  definitions = std::move(newDefinitions);
+  imports = std::move(newImports);
+
+  return root;
+};
+
+AltaCore::Filesystem::Path AltaCore::ASTCache::entryPath(const CacheKey& key, std::string extension) {
+  std::stringstream name;
+  name << std::hex << Serialization::hash(key.path) << '.' << extension;
+  return cacheDirectory / name.str();
+};
+
+std::shared_ptr<AltaCore::AST::RootNode> AltaCore::ASTCache::load(const CacheKey& key, Definitions& definitions, std::vector<ImportRecord>& imports) {
+  if (!cacheDirectory) return nullptr;
+
+  std::shared_ptr<AST::RootNode> root = nullptr;
+  try {
+    Serialization::readFile(entryPath(key), [&](const char* data, size_t size) {
+      root = deserialize(key, data, size, definitions, imports);
+    });
+  } catch (CorruptCacheError&) {
+    root = nullptr;
+  }
+
+  return root;
+};
+
+void AltaCore::ASTCache::store(const CacheKey& key, std::shared_ptr<AST::RootNode> root, const Definitions& definitions, const std::vector<ImportRecord>& imports) {
+  if (!cacheDirectory) return;
+
+  std::string data;
+  try {
+    data = serialize(key, root, definitions, imports);
+  } catch (std::runtime_error&) {
+    return;
+  }
+
+  if (!cacheDirectory.isDirectory() && !Filesystem::mkdirp(cacheDirectory)) return;
+
+  Serialization::writeFileAtomically(entryPath(key), data);
+};
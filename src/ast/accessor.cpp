@@ -256,6 +256,9 @@ ALTACORE_AST_DETAIL_D(Accessor) {
         }
 
         for (const auto& newFunc: newFuncs) {
+          // instantiations that are still waiting on their bodies get hoisted once we narrow to them
+          // (which details the body), so backends never see a function without one
+          if (newFunc->bodyDeferred) continue;
           info->inputScope->hoist(newFunc);
         }
 
@@ -292,6 +295,9 @@ void AltaCore::AST::Accessor::narrowTo(std::shared_ptr<DH::Accessor> info, std::
       }
     }
   }
+  if (auto func = std::dynamic_pointer_cast<DET::Function>(info->narrowedTo)) {
+    func->detailBody();
+  }
   if (info->narrowedTo) {
     if (info->fetchingReturnType) {
       auto itemType = DET::Type::getUnderlyingType(info->narrowedTo);
@@ -309,6 +315,9 @@ void AltaCore::AST::Accessor::narrowTo(std::shared_ptr<DH::Accessor> info, size_
     info->inputScope->unhoist(info->narrowedTo);
   }
   info->narrowedTo = info->items[i];
+  if (auto func = std::dynamic_pointer_cast<DET::Function>(info->narrowedTo)) {
+    func->detailBody();
+  }
   info->narrowedToIndex = i;
   if (info->narrowedTo) {
     if (info->fetchingReturnType) {
@@ -1,6 +1,7 @@
 #include "../../include/altacore/ast/class-definition-node.hpp"
 #include "../../include/altacore/ast/class-special-method-definition-statement.hpp"
 #include "../../include/altacore/util.hpp"
+#include "../../include/altacore/concurrency.hpp"
 #include "../../include/altacore/ast/super-class-fetch.hpp"
 #include "../../include/altacore/ast/class-instantiation-expression.hpp"
 #include "../../include/altacore/ast/integer-literal-node.hpp"
@@ -22,6 +23,8 @@ namespace AltaCoreClassHelpers {
         throw AltaCore::Errors::ValidationError("no class found for the given parent expression", self->position);
       }
       info->klass->parents.push_back(std::dynamic_pointer_cast<DET::Class>(det->items.back()));
+      DET::Class::invalidateHierarchies();
+      DET::Type::invalidateCasts();
     }
 
     bool canCreateDefaultCtor = true;
@@ -62,6 +65,7 @@ namespace AltaCoreClassHelpers {
                 method->parentClassType = std::make_shared<DET::Type>(info->klass, std::vector<uint8_t> { (uint8_t)TypeModifierFlag::Reference });
                 specialDet->correspondingMethod = method;
                 info->klass->fromCasts.push_back(method);
+                DET::Type::invalidateCasts();
               }
             } else if (special->type == SpecialClassMethod::Destructor) {
               if (info->klass->destructor) {
@@ -70,8 +74,10 @@ namespace AltaCoreClassHelpers {
               info->klass->destructor = specialDet->method;
             } else if (special->type == SpecialClassMethod::From) {
               info->klass->fromCasts.push_back(specialDet->method);
+              DET::Type::invalidateCasts();
             } else if (special->type == SpecialClassMethod::To) {
               info->klass->toCasts.push_back(specialDet->method);
+              DET::Type::invalidateCasts();
             } else {
               throw AltaCore::Errors::ValidationError("impossible detailing error: unrecognized special method type", self->position);
             }
@@ -79,6 +85,7 @@ namespace AltaCoreClassHelpers {
             auto op = std::dynamic_pointer_cast<ClassOperatorDefinitionStatement>(stmt);
             auto opDet = std::dynamic_pointer_cast<DH::ClassOperatorDefinitionStatement>(det);
             info->klass->operators.push_back(opDet->method);
+            DET::Class::invalidateHierarchies();
           } else if (stmt->nodeType() == NodeType::ClassMemberDefinitionStatement) {
             auto varDet = std::dynamic_pointer_cast<DH::ClassMemberDefinitionStatement>(det);
             varDet->varDef->inputScope = info->initializerMethod->scope;
@@ -303,29 +310,37 @@ std::shared_ptr<AltaCore::DET::Class> AltaCore::AST::ClassDefinitionNode::instan
     return nullptr;
   }
 
-  for (auto genericInst: info->genericInstantiations) {
-    bool ok = true;
+  // same as `FunctionDefinitionNode::instantiateGeneric`
+  Concurrency::ExclusiveSection exclusive;
+
+  auto matches = [&](std::shared_ptr<DH::GenericClassInstantiationDefinitionNode> genericInst) {
     for (size_t i = 0; i < genericInst->genericDetails.size(); i++) {
-      if (auto target = std::dynamic_pointer_cast<DET::Type>(genericInst->genericDetails[i]->alias->target)) {
-        if (!target->isExactlyCompatibleWith(*genericArguments[i])) {
-          ok = false;
-          break;
-        }
-      } else {
-        ok = false;
-        break;
+      auto target = std::dynamic_pointer_cast<DET::Type>(genericInst->genericDetails[i]->alias->target);
+      if (!target || !target->isExactlyCompatibleWith(*genericArguments[i])) {
+        return false;
       }
     }
+    return true;
+  };
+
+  // same as `FunctionDefinitionNode::instantiateGeneric`: only the matching bucket has to be checked
+  auto& bucket = info->genericInstantiationIndex[DET::Type::exactCompatibilityHash(genericArguments)];
+  std::shared_ptr<DH::GenericClassInstantiationDefinitionNode> found = nullptr;
 
-    if (!ok) {
-      continue;
+  for (auto& genericInst: bucket) {
+    if (matches(genericInst)) {
+      found = genericInst;
+      break;
     }
+  }
 
-    return genericInst->klass;
+  if (found) {
+    return found->klass;
   }
 
   auto inst = std::make_shared<DH::GenericClassInstantiationDefinitionNode>(info->inputScope);
   info->genericInstantiations.push_back(inst);
+  bucket.push_back(inst);
 
   inst->klass = DET::Class::create(name, info->inputScope, {});
   inst->klass->ast = shared_from_this();
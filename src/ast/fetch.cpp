@@ -29,6 +29,9 @@ void AltaCore::AST::Fetch::narrowTo(std::shared_ptr<DH::Fetch> info, size_t i) {
     info->inputScope->unhoist(info->narrowedTo);
   }
   info->narrowedTo = info->items[i];
+  if (auto func = std::dynamic_pointer_cast<DET::Function>(info->narrowedTo)) {
+    func->detailBody();
+  }
   if (info->narrowedTo->nodeType() == DET::NodeType::Variable) {
     if (auto func = Util::getFunction(info->inputScope).lock()) {
       if (func->isGenerator || func->isAsync) {
@@ -234,6 +237,8 @@ ALTACORE_AST_DETAIL_D(Fetch) {
         }
 
         for (const auto& newFunc: newFuncs) {
+          // deferred instantiations are hoisted once we narrow to them (see `Accessor::detail`)
+          if (newFunc->bodyDeferred) continue;
           info->inputScope->hoist(newFunc);
         }
 
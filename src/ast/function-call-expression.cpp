@@ -19,92 +19,113 @@ std::tuple<size_t, ALTACORE_MAP<size_t, size_t>, std::vector<ALTACORE_VARIANT<st
     throw std::runtime_error("Can't call an unknown expression like a function");
   }
 
-  bool found = false; // whether we found the right function
-  bool possible = false; // whether we found any function at all
-  std::vector<std::tuple<size_t, std::vector<size_t>, std::shared_ptr<DET::Type>, std::vector<ALTACORE_VARIANT<std::pair<std::shared_ptr<ExpressionNode>, std::shared_ptr<DH::ExpressionNode>>, std::vector<std::pair<std::shared_ptr<ExpressionNode>, std::shared_ptr<DH::ExpressionNode>>>>>, ALTACORE_MAP<size_t, size_t>>> compatibles;
+  using ArgumentDetails = std::pair<std::shared_ptr<ExpressionNode>, std::shared_ptr<DH::ExpressionNode>>;
+  using ArgumentSlot = ALTACORE_VARIANT<ArgumentDetails, std::vector<ArgumentDetails>>;
+
+  struct Candidate {
+    size_t index;
+    std::vector<size_t> compatiblities;
+    std::shared_ptr<DET::Type> type;
+    std::vector<ArgumentSlot> arguments;
+    ALTACORE_MAP<size_t, size_t> argMap;
+    // the type each argument was matched as, used to narrow the arguments once we've picked a winner
+    std::vector<std::shared_ptr<DET::Type>> argumentTypes;
+  };
+
+  // the possible types of each argument are the same for every candidate, so only look them up once
+  std::vector<std::vector<std::shared_ptr<DET::Type>>> argumentTypes;
+  bool hasNamedArguments = false;
+  argumentTypes.reserve(arguments.size());
+  for (auto& [argName, argExpr, argDet]: arguments) {
+    auto types = DET::Type::getUnderlyingTypes(argDet.get());
+    for (auto& type: types) {
+      if (type->isAccessor) {
+        type = type->returnType;
+      }
+    }
+    argumentTypes.push_back(std::move(types));
+    if (!argName.empty()) {
+      hasNamedArguments = true;
+    }
+  }
+
+  // find the argument type that's most compatible with the given parameter type
+  auto scoreArgument = [&](const std::shared_ptr<DET::Type>& parameterType, size_t argIndex, bool requireCast, std::shared_ptr<DET::Type>& finalType) {
+    size_t compatiblity = 0;
+    for (auto& type: argumentTypes[argIndex]) {
+      auto currentCompat = parameterType->compatiblity(*type);
+      if (currentCompat > 0 && requireCast) {
+        if (AltaCore::DET::Type::findCast(type, parameterType).size() == 0) {
+          currentCompat = 0;
+        }
+      }
+      if (currentCompat > compatiblity) {
+        compatiblity = currentCompat;
+        finalType = type;
+      }
+    }
+    return compatiblity;
+  };
+
+  std::vector<Candidate> compatibles;
   for (size_t index = 0; index < targetTypes.size(); index++) {
     auto& targetType = targetTypes[index];
     if (!targetType) continue;
     if (!targetType->isFunction) continue;
-    possible = true;
-    //if (targetType->parameters.size() != arguments.size()) continue;
-    ALTACORE_MAP<size_t, std::pair<std::string, ALTACORE_VARIANT<std::pair<std::shared_ptr<ExpressionNode>, std::shared_ptr<DH::ExpressionNode>>, std::vector<std::pair<std::shared_ptr<ExpressionNode>, std::shared_ptr<DH::ExpressionNode>>>>>> argumentsInOrder;
-    std::vector<size_t> compatiblities(targetType->parameters.size(), 0);
+
+    auto& parameters = targetType->parameters;
+
+    // quickly rule out candidates that can't possibly take these arguments
+    if (arguments.size() < targetType->requiredArgumentCount()) continue;
+    bool hasVariableParameter = false;
+    for (auto& param: parameters) {
+      if (std::get<2>(param)) {
+        hasVariableParameter = true;
+        break;
+      }
+    }
+    // (named arguments can move us backwards in the parameter list, so we can only do this without them)
+    if (!hasNamedArguments && !hasVariableParameter && arguments.size() > parameters.size()) continue;
+
+    ALTACORE_MAP<std::string, size_t> parameterIndex;
+    if (hasNamedArguments) {
+      for (size_t j = parameters.size(); j > 0; --j) {
+        // iterate backwards so that the first parameter with a given name wins
+        parameterIndex[std::get<0>(parameters[j - 1])] = j - 1;
+      }
+    }
+
+    ALTACORE_MAP<size_t, std::pair<std::string, ArgumentSlot>> argumentsInOrder;
+    std::vector<size_t> compatiblities(parameters.size(), 0);
+    std::vector<std::shared_ptr<DET::Type>> chosenTypes(arguments.size(), nullptr);
     size_t funcArgIndex = 0;
-    bool ok = arguments.size() >= targetType->requiredArgumentCount();
+    bool ok = true;
     ALTACORE_MAP<size_t, size_t> argMap;
-    for (size_t i = 0; i < targetType->parameters.size(); i++) {
-      if (std::get<2>(targetType->parameters[i])) {
-        argumentsInOrder[i] = std::make_pair(std::get<0>(targetType->parameters[i]), std::vector<std::pair<std::shared_ptr<ExpressionNode>, std::shared_ptr<DH::ExpressionNode>>>());
+    for (size_t i = 0; i < parameters.size(); i++) {
+      if (std::get<2>(parameters[i])) {
+        argumentsInOrder[i] = std::make_pair(std::get<0>(parameters[i]), std::vector<ArgumentDetails>());
       }
     }
     for (size_t i = 0; i < arguments.size(); i++) {
-      if (!ok) break;
       auto& [argName, argExpr, argDet] = arguments[i];
-      auto types = DET::Type::getUnderlyingTypes(argDet.get());
       if (argName.empty()) {
-        if (funcArgIndex >= targetType->parameters.size()) {
+        if (funcArgIndex >= parameters.size()) {
           ok = false;
           break;
         }
       } else {
-        bool found = false;
-        for (size_t j = 0; j < targetType->parameters.size(); j++) {
-          if (std::get<0>(targetType->parameters[j]) == argName) {
-            funcArgIndex = j;
-            found = true;
-            break;
-          }
-        }
-        if (!found) {
+        auto it = parameterIndex.find(argName);
+        if (it == parameterIndex.end()) {
           ok = false;
           break;
         }
+        funcArgIndex = it->second;
       }
-      size_t compatiblity = 0;
-      std::shared_ptr<DET::Type> finalType = nullptr;
-      for (auto& maybeType: types) {
-        auto type = maybeType->isAccessor ? maybeType->returnType : maybeType;
-        auto currentCompat = std::get<1>(targetType->parameters[funcArgIndex])->compatiblity(*type);
-        if (currentCompat > 0) {
-          if (AltaCore::DET::Type::findCast(type, std::get<1>(targetType->parameters[funcArgIndex])).size() == 0) {
-            currentCompat = 0;
-          }
-        }
-        if (currentCompat > compatiblity) {
-          compatiblity = currentCompat;
-          finalType = type;
-          if (argExpr->nodeType() == NodeType::Fetch) {
-            auto fetch = std::dynamic_pointer_cast<AST::Fetch>(argExpr);
-            auto fetchDet = std::dynamic_pointer_cast<DH::Fetch>(argDet);
-            fetch->narrowTo(fetchDet, type);
-          } else if (argExpr->nodeType() == NodeType::Accessor) {
-            auto acc = std::dynamic_pointer_cast<AST::Accessor>(argExpr);
-            auto accDet = std::dynamic_pointer_cast<DH::Accessor>(argDet);
-            acc->narrowTo(accDet, type);
-          }
-        }
-      }
+      auto compatiblity = scoreArgument(std::get<1>(parameters[funcArgIndex]), i, true, chosenTypes[i]);
       if (compatiblity == 0) {
-        if (std::get<2>(targetType->parameters[funcArgIndex]) && funcArgIndex + 1 < targetType->parameters.size()) {
+        if (std::get<2>(parameters[funcArgIndex]) && funcArgIndex + 1 < parameters.size()) {
           funcArgIndex++;
-          for (auto& maybeType: types) {
-            auto type = maybeType->isAccessor ? maybeType->returnType : maybeType;
-            auto currentCompat = std::get<1>(targetType->parameters[funcArgIndex])->compatiblity(*type);
-            if (currentCompat > compatiblity) {
-              compatiblity = currentCompat;
-              finalType = type;
-              if (argExpr->nodeType() == NodeType::Fetch) {
-                auto fetch = std::dynamic_pointer_cast<AST::Fetch>(argExpr);
-                auto fetchDet = std::dynamic_pointer_cast<DH::Fetch>(argDet);
-                fetch->narrowTo(fetchDet, type);
-              } else if (argExpr->nodeType() == NodeType::Accessor) {
-                auto acc = std::dynamic_pointer_cast<AST::Accessor>(argExpr);
-                auto accDet = std::dynamic_pointer_cast<DH::Accessor>(argDet);
-                acc->narrowTo(accDet, type);
-              }
-            }
-          }
+          compatiblity = scoreArgument(std::get<1>(parameters[funcArgIndex]), i, false, chosenTypes[i]);
           if (compatiblity == 0) {
             ok = false;
             break;
@@ -119,66 +140,73 @@ std::tuple<size_t, ALTACORE_MAP<size_t, size_t>, std::vector<ALTACORE_VARIANT<st
       } else if (compatiblity < compatiblities[funcArgIndex]) {
         compatiblities[funcArgIndex] = compatiblity;
       }
-      if (std::get<2>(targetType->parameters[funcArgIndex])) {
+      if (std::get<2>(parameters[funcArgIndex])) {
         if (argumentsInOrder.find(funcArgIndex) == argumentsInOrder.end()) {
-          argumentsInOrder[funcArgIndex] = { argName, std::vector<std::pair<std::shared_ptr<ExpressionNode>, std::shared_ptr<DH::ExpressionNode>>>() };
+          argumentsInOrder[funcArgIndex] = { argName, std::vector<ArgumentDetails>() };
         }
-        ALTACORE_VARIANT_GET<std::vector<std::pair<std::shared_ptr<ExpressionNode>, std::shared_ptr<DH::ExpressionNode>>>>(argumentsInOrder[funcArgIndex].second).emplace_back(argExpr, argDet);
+        ALTACORE_VARIANT_GET<std::vector<ArgumentDetails>>(argumentsInOrder[funcArgIndex].second).emplace_back(argExpr, argDet);
       } else {
         argumentsInOrder[funcArgIndex] = std::make_pair(argName, std::make_pair(argExpr, argDet));
       }
       argMap[i] = funcArgIndex;
-      if (!std::get<2>(targetType->parameters[funcArgIndex])) {
+      if (!std::get<2>(parameters[funcArgIndex])) {
         funcArgIndex++;
       }
     }
     if (!ok) continue;
-    found = true;
-    std::vector<ALTACORE_VARIANT<std::pair<std::shared_ptr<ExpressionNode>, std::shared_ptr<DH::ExpressionNode>>, std::vector<std::pair<std::shared_ptr<ExpressionNode>, std::shared_ptr<DH::ExpressionNode>>>>> args(argumentsInOrder.size(), std::make_pair(nullptr, nullptr));
+    std::vector<ArgumentSlot> args(argumentsInOrder.size(), std::make_pair(nullptr, nullptr));
     for (auto& [i, arg]: argumentsInOrder) {
       args[i] = arg.second;
     }
-    compatibles.push_back({ index, compatiblities, targetType, args, argMap });
+    compatibles.push_back({ index, compatiblities, targetType, args, argMap, chosenTypes });
   }
 
-  size_t mostCompatibleIndex = SIZE_MAX;
-  std::vector<size_t> mostCompatibleCompatiblities;
-  std::shared_ptr<DET::Type> mostCompatibleType = nullptr;
-  std::vector<ALTACORE_VARIANT<std::pair<std::shared_ptr<ExpressionNode>, std::shared_ptr<DH::ExpressionNode>>, std::vector<std::pair<std::shared_ptr<ExpressionNode>, std::shared_ptr<DH::ExpressionNode>>>>> mostCompatibleArguments;
-  ALTACORE_MAP<size_t, size_t> mostCompatibleArgMap;
-  for (auto& [index, compatabilities, type, args, argMap]: compatibles) {
-    if (mostCompatibleIndex != SIZE_MAX) {
+  Candidate* mostCompatible = nullptr;
+  for (auto& candidate: compatibles) {
+    if (mostCompatible) {
       size_t numberGreater = 0;
       // the required argument count check is there to prevent variable parameter functions from overriding
       // fixed parameter functions that are defined before them
       // (if only the required number of arguments are given, the function defined first should be given precedence)
-      if (compatabilities.size() > mostCompatibleCompatiblities.size() && arguments.size() > mostCompatibleType->requiredArgumentCount()) {
+      if (candidate.compatiblities.size() > mostCompatible->compatiblities.size() && arguments.size() > mostCompatible->type->requiredArgumentCount()) {
         numberGreater = SIZE_MAX;
-      } else if (compatabilities.size() >= mostCompatibleCompatiblities.size()) {
+      } else if (candidate.compatiblities.size() >= mostCompatible->compatiblities.size()) {
         // TODO: this doesn't handle the case where the variable parameters come in the middle of the parameter list
-        for (size_t i = 0; i < mostCompatibleCompatiblities.size(); i++) {
-          if (compatabilities[i] > mostCompatibleCompatiblities[i]) {
+        for (size_t i = 0; i < mostCompatible->compatiblities.size(); i++) {
+          if (candidate.compatiblities[i] > mostCompatible->compatiblities[i]) {
             numberGreater++;
           }
         }
       }
       if (numberGreater > 0) {
-        mostCompatibleIndex = index;
-        mostCompatibleType = type;
-        mostCompatibleCompatiblities = compatabilities;
-        mostCompatibleArguments = args;
-        mostCompatibleArgMap = argMap;
+        mostCompatible = &candidate;
       }
     } else {
-      mostCompatibleIndex = index;
-      mostCompatibleType = type;
-      mostCompatibleCompatiblities = compatabilities;
-      mostCompatibleArguments = args;
-      mostCompatibleArgMap = argMap;
+      mostCompatible = &candidate;
+    }
+  }
+
+  if (!mostCompatible) {
+    return { SIZE_MAX, {}, {} };
+  }
+
+  // now that we know which function we're calling, narrow the arguments to match it
+  for (size_t i = 0; i < arguments.size(); i++) {
+    auto& [argName, argExpr, argDet] = arguments[i];
+    auto& type = mostCompatible->argumentTypes[i];
+    if (!type) continue;
+    if (argExpr->nodeType() == NodeType::Fetch) {
+      auto fetch = std::dynamic_pointer_cast<AST::Fetch>(argExpr);
+      auto fetchDet = std::dynamic_pointer_cast<DH::Fetch>(argDet);
+      fetch->narrowTo(fetchDet, type);
+    } else if (argExpr->nodeType() == NodeType::Accessor) {
+      auto acc = std::dynamic_pointer_cast<AST::Accessor>(argExpr);
+      auto accDet = std::dynamic_pointer_cast<DH::Accessor>(argDet);
+      acc->narrowTo(accDet, type);
     }
   }
 
-  return { mostCompatibleIndex, mostCompatibleArgMap, mostCompatibleArguments };
+  return { mostCompatible->index, mostCompatible->argMap, mostCompatible->arguments };
 };
 
 ALTACORE_AST_DETAIL_D(FunctionCallExpression) {
@@ -1,6 +1,7 @@
 #include "../../include/altacore/ast/function-definition-node.hpp"
 #include <algorithm>
 #include "../../include/altacore/util.hpp"
+#include "../../include/altacore/concurrency.hpp"
 #include "altacore/det-shared.hpp"
 #include "altacore/det/function.hpp"
 #include "altacore/det/type.hpp"
@@ -354,6 +355,8 @@ ALTACORE_AST_VALIDATE_D(FunctionDefinitionNode) {
   };
   if (generics.size() > 0) {
     for (auto& generic: info->genericInstantiations) {
+      // never referenced, so there's no body to validate
+      if (generic->function->bodyDeferred) continue;
       validationLoop(generic);
     }
   } else {
@@ -559,26 +562,34 @@ std::vector<std::shared_ptr<AltaCore::DET::Function>> AltaCore::AST::FunctionDef
     return {};
   }
 
-  for (auto genericInst: info->genericInstantiations) {
-    bool ok = true;
+  // instantiations are added to the template's module, which other workers might be using
+  Concurrency::ExclusiveSection exclusive;
+
+  auto matches = [&](std::shared_ptr<DH::GenericFunctionInstantiationDefinitionNode> genericInst) {
     for (size_t i = 0; i < genericInst->genericDetails.size(); i++) {
-      if (auto target = std::dynamic_pointer_cast<DET::Type>(genericInst->genericDetails[i]->alias->target)) {
-        if (!target->isExactlyCompatibleWith(*genericArguments[i])) {
-          ok = false;
-          break;
-        }
-      } else {
-        ok = false;
-        break;
+      auto target = std::dynamic_pointer_cast<DET::Type>(genericInst->genericDetails[i]->alias->target);
+      if (!target || !target->isExactlyCompatibleWith(*genericArguments[i])) {
+        return false;
       }
     }
+    return true;
+  };
+
+  // exactly compatible argument lists always land in the same bucket, so if the bucket
+  // doesn't have a match, no existing instantiation does
+  auto& bucket = info->genericInstantiationIndex[DET::Type::exactCompatibilityHash(genericArguments)];
+  std::shared_ptr<DH::GenericFunctionInstantiationDefinitionNode> found = nullptr;
 
-    if (!ok) {
-      continue;
+  for (auto& genericInst: bucket) {
+    if (matches(genericInst)) {
+      found = genericInst;
+      break;
     }
+  }
 
-    std::vector<std::shared_ptr<DET::Function>> result { genericInst->function };
-    for (const auto& [func, valueProvided]: genericInst->optionalVariantFunctions) {
+  if (found) {
+    std::vector<std::shared_ptr<DET::Function>> result { found->function };
+    for (const auto& [func, valueProvided]: found->optionalVariantFunctions) {
       result.push_back(func);
     }
     return result;
@@ -586,6 +597,7 @@ std::vector<std::shared_ptr<AltaCore::DET::Function>> AltaCore::AST::FunctionDef
 
   auto inst = std::make_shared<DH::GenericFunctionInstantiationDefinitionNode>(info->inputScope);
   info->genericInstantiations.push_back(inst);
+  bucket.push_back(inst);
 
   std::vector<std::tuple<std::string, std::shared_ptr<DET::Type>, bool, std::string>> params;
 
@@ -623,7 +635,15 @@ std::vector<std::shared_ptr<AltaCore::DET::Function>> AltaCore::AST::FunctionDef
     }
   }
 
-  fullDetail(inst, false);
+  // only the signature is needed to consider this instantiation as a candidate;
+  // the body is detailed once it's actually referenced (see `DET::Function::detailBody`)
+  fullDetail(inst, true);
+  if (inst->optionalVariantFunctions.size() > 0) {
+    // references to the variants can't find their way back here, so don't wait for them
+    fullDetail(inst, false);
+  } else {
+    inst->function->bodyDeferred = true;
+  }
 
   std::vector<std::shared_ptr<DET::Function>> result { inst->function };
   for (const auto& [func, valueProvided]: inst->optionalVariantFunctions) {
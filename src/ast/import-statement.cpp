@@ -1,6 +1,7 @@
 #include "../../include/altacore/ast/import-statement.hpp"
 #include "../../include/altacore/modules.hpp"
 #include "../../include/altacore/util.hpp"
+#include "../../include/altacore/concurrency.hpp"
 
 const AltaCore::AST::NodeType AltaCore::AST::ImportStatement::nodeType() {
   return NodeType::ImportStatement;
@@ -18,17 +19,27 @@ AltaCore::AST::ImportStatement::ImportStatement(std::string _request, std::strin
   {};
 
 void AltaCore::AST::ImportStatement::parse(Filesystem::Path sourcePath) {
-  Modules::parseModule(request, sourcePath);
+  Modules::parseImport(request, sourcePath);
 };
 
 ALTACORE_AST_DETAIL_D(ImportStatement) {
   ALTACORE_MAKE_DH(ImportStatement);
   info->parentModule = Util::getModule(scope.get()).lock();
   info->importedAST = Modules::parseModule(request, info->parentModule->path);
-  info->importedAST->detail(Modules::resolve(request, info->parentModule->path), "", info->parentModule);
+  // modules in other components of the import graph are already detailed by the time we get here
+  if (!info->importedAST->info) {
+    // it's either in the same import cycle as us or not in the graph at all; in the
+    // latter case, another worker might be importing it at the same time
+    Concurrency::ExclusiveSection exclusive;
+    info->importedAST->detail(Modules::resolve(request, info->parentModule->path), "", info->parentModule);
+  }
   info->importedModule = info->importedAST->info->module;
   info->parentModule->dependencies.push_back(info->importedModule);
-  info->importedModule->dependents.push_back(info->parentModule);
+  {
+    // the imported module is usually one that other workers are importing, too
+    Concurrency::CacheLock lock;
+    info->importedModule->dependents.push_back(info->parentModule);
+  }
   if (!isManual) {
     if (isAliased) {
       auto ns = std::make_shared<DET::Namespace>(alias, position, info->parentModule->scope);
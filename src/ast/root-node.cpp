@@ -3,6 +3,15 @@
 #include "../../include/altacore/ast/import-statement.hpp"
 #include "../../include/altacore/ast/export-statement.hpp"
 #include "../../include/altacore/util.hpp"
+#include "../../include/altacore/concurrency.hpp"
+#include "../../include/altacore/det-snapshot.hpp"
+
+namespace {
+  // every module rehydrated by the outermost `RootNode::rehydrate` in progress on this thread (including
+  // the ones it needed along the way). modules in an import cycle refer to each other, so either all of
+  // them are rehydrated or none of them are
+  thread_local std::vector<std::shared_ptr<AltaCore::AST::RootNode>> rehydrating;
+};
 
 const AltaCore::AST::NodeType AltaCore::AST::RootNode::nodeType() {
   return NodeType::RootNode;
@@ -15,6 +24,7 @@ AltaCore::AST::RootNode::RootNode(std::vector<std::shared_ptr<AltaCore::AST::Sta
 
 void AltaCore::AST::RootNode::detail(AltaCore::Filesystem::Path filePath, std::string moduleName, std::shared_ptr<DET::Module> parentModule) {
   if (info) return;
+  if (parentModule && rehydrate(filePath, parentModule)) return;
   info = std::make_shared<DH::RootNode>();
   
   Modules::PackageInfo pkgInfo;
@@ -122,6 +132,9 @@ void AltaCore::AST::RootNode::detail(AltaCore::Filesystem::Path filePath, std::s
         info->dependencyASTs.push_back(statementDet->externalTarget->importedAST);
       }
     }
+    // we're not in the middle of anything here, so this is a good time to let other workers
+    // make changes that affect everyone (see `Concurrency`)
+    Concurrency::safepoint();
   }
 
   // we need to detail the internal information *after* detailing the module for the `_internal` package
@@ -140,6 +153,82 @@ void AltaCore::AST::RootNode::detail(AltaCore::Filesystem::Path filePath, std::s
       addDetails(dependency);
     }
   }
+
+  info->detailed = true;
+
+  if (DETSnapshot::rehydrateImports && cacheKey && !DETSnapshot::hasGenericTemplates(info->module)) {
+    DETSnapshot::store(info->module, *cacheKey);
+  }
+};
+
+bool AltaCore::AST::RootNode::rehydrate(AltaCore::Filesystem::Path filePath, std::shared_ptr<DET::Module> parentModule) {
+  if (info) return true;
+  if (!DETSnapshot::rehydrateImports || !cacheKey) return false;
+
+  auto self = shared_from_this();
+  bool outermost = rehydrating.empty();
+  rehydrating.push_back(self);
+
+  // this marks us as in progress, so dependencies in an import cycle with us pick up our module instead of trying to rehydrate us again
+  info = std::make_shared<DH::RootNode>();
+  info->fromSnapshot = true;
+
+  auto rollBack = [&]() {
+    for (auto& root: rehydrating) {
+      root->info = nullptr;
+    }
+    rehydrating.clear();
+  };
+
+  std::shared_ptr<DET::Module> module = nullptr;
+  try {
+    module = DETSnapshot::load(*cacheKey, [&](Filesystem::Path dependencyPath) -> std::shared_ptr<DET::Module> {
+      std::shared_ptr<RootNode> dependency = nullptr;
+      try {
+        dependency = Modules::parseModule(dependencyPath.toString(), filePath);
+      } catch (const std::exception&) {
+        // detailing from source will run into (and report) the same problem
+        return nullptr;
+      }
+      if (!dependency) return nullptr;
+      // detailing it from source here would detail it before us (even if it's in an import cycle with us), which could
+      // change what it sees. with `Modules::ImportGraph::detail`, this only happens within a cycle anyways.
+      if (!dependency->info && !dependency->rehydrate(dependencyPath, parentModule)) return nullptr;
+      // if it's still being detailed from source, it's in a cycle with us and its interface isn't done yet
+      if (!dependency->info->detailed && !dependency->info->fromSnapshot) return nullptr;
+      return dependency->info->module;
+    }, [&](std::shared_ptr<DET::Module> module) {
+      info->module = module;
+      module->ast = self;
+      module->parentModule = parentModule;
+    });
+  } catch (...) {
+    if (outermost) {
+      rollBack();
+    }
+    throw;
+  }
+
+  bool usable = module && !DETSnapshot::hasGenericTemplates(module);
+  // failures make every module that depends on us fail, too, all the way up to the outermost module
+  if (!outermost) return usable;
+
+  if (!usable) {
+    rollBack();
+    return false;
+  }
+
+  for (auto& root: rehydrating) {
+    root->info->detailed = true;
+    for (auto& dependency: root->info->module->dependencies) {
+      root->info->dependencyASTs.push_back(dependency->ast.lock());
+      Concurrency::CacheLock lock;
+      dependency->dependents.push_back(root->info->module);
+    }
+  }
+  rehydrating.clear();
+
+  return true;
 };
 void AltaCore::AST::RootNode::detail(std::string filePath, std::string moduleName) {
   return detail(Filesystem::Path(filePath), moduleName);
@@ -147,6 +236,11 @@ void AltaCore::AST::RootNode::detail(std::string filePath, std::string moduleNam
 
 ALTACORE_AST_VALIDATE_D(RootNode) {
   ALTACORE_VS_SS;
+  // there's nothing to validate; the module's interface was validated when the snapshot was taken
+  if (info->fromSnapshot) {
+    ALTACORE_VS_E;
+    return;
+  }
   for (size_t i = 0; i< statements.size(); i++) {
     auto& stmt = statements[i];
     auto& stmtDet = info->statements[i];
@@ -2,6 +2,7 @@
 #include "../include/altacore/simple-map.hpp"
 #include "../include/altacore/ast/attribute-node.hpp"
 #include "../include/altacore/util.hpp"
+#include "../include/altacore/concurrency.hpp"
 
 namespace AltaCore {
   namespace Attributes {
@@ -57,6 +58,9 @@ bool AltaCore::Attributes::Attribute::checkIfAppliesTo(AltaCore::AST::NodeType t
 bool AltaCore::Attributes::registerAttribute(std::vector<std::string> fullDomainPath, std::vector<AltaCore::AST::NodeType> appliesTo, std::function<void(std::shared_ptr<AltaCore::AST::Node>, std::shared_ptr<AltaCore::DH::Node>, std::vector<AltaCore::Attributes::AttributeArgument>)> callback, std::string file, bool postProcess) {
   if (fullDomainPath.size() == 0) return false;
 
+  // attributes can be registered and looked up by modules being detailed on different threads
+  Concurrency::CacheLock lock;
+
   std::vector<Attribute>* target = nullptr;
 
   if (file == "") {
@@ -116,6 +120,8 @@ bool AltaCore::Attributes::registerAttribute(std::vector<std::string> fullDomain
 ALTACORE_OPTIONAL<AltaCore::Attributes::Attribute> AltaCore::Attributes::findAttribute(std::vector<std::string> fullDomainPath, ALTACORE_OPTIONAL<AltaCore::AST::NodeType> appliesTo, std::string file) {
   if (fullDomainPath.size() == 0) return ALTACORE_NULLOPT;
 
+  Concurrency::CacheLock lock;
+
   std::vector<Attribute>* target = nullptr;
 
   if (file == "") {
@@ -158,14 +164,17 @@ ALTACORE_OPTIONAL<AltaCore::Attributes::Attribute> AltaCore::Attributes::findAtt
 };
 
 void AltaCore::Attributes::clearGlobalAttributes() {
+  Concurrency::CacheLock lock;
   registeredGlobalAttributes.clear();
 };
 void AltaCore::Attributes::clearFileAttributes(std::string file) {
+  Concurrency::CacheLock lock;
   if (registeredFileAttributes.find(file) != registeredFileAttributes.end()) {
     registeredFileAttributes[file].clear();
   }
 };
 void AltaCore::Attributes::clearAllAttributes() {
+  Concurrency::CacheLock lock;
   registeredGlobalAttributes.clear();
   registeredFileAttributes.clear();
 };
@@ -0,0 +1,151 @@
+#include "../include/altacore/concurrency.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <stdexcept>
+
+namespace {
+  struct State {
+    std::atomic<bool> active { false };
+    std::recursive_mutex cacheMutex;
+
+    // guards everything below
+    std::mutex mutex;
+    std::condition_variable changed;
+    // workers that currently have shared access
+    size_t sharedHolders = 0;
+    // exclusive sections waiting for the workers to reach a safepoint (atomic so `safepoint` can check it without locking)
+    std::atomic<size_t> writersWaiting { 0 };
+    bool writerActive = false;
+  };
+
+  State& state() {
+    static State state;
+    return state;
+  };
+
+  thread_local size_t detailingDepth = 0;
+  thread_local size_t exclusiveDepth = 0;
+  thread_local size_t cacheDepth = 0;
+  thread_local bool holdsShared = false;
+
+  void acquireShared(State& state) {
+    std::unique_lock<std::mutex> lock(state.mutex);
+    // pending exclusive sections go first; otherwise, workers that keep hitting safepoints could starve them
+    state.changed.wait(lock, [&]() {
+      return !state.writerActive && state.writersWaiting == 0;
+    });
+    ++state.sharedHolders;
+    holdsShared = true;
+  };
+
+  void releaseShared(State& state) {
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      --state.sharedHolders;
+      holdsShared = false;
+    }
+    state.changed.notify_all();
+  };
+};
+
+bool AltaCore::Concurrency::active() {
+  return state().active.load(std::memory_order_relaxed);
+};
+
+AltaCore::Concurrency::ConcurrentDetailing::ConcurrentDetailing(bool enable):
+  enabled(enable && !active())
+{
+  if (enabled) {
+    state().active = true;
+  }
+};
+
+AltaCore::Concurrency::ConcurrentDetailing::~ConcurrentDetailing() {
+  if (enabled) {
+    state().active = false;
+  }
+};
+
+AltaCore::Concurrency::DetailingSection::DetailingSection():
+  engaged(active())
+{
+  if (!engaged) return;
+  // inside an exclusive section, we already have all the access we need
+  if (detailingDepth++ == 0 && exclusiveDepth == 0) {
+    acquireShared(state());
+  }
+};
+
+AltaCore::Concurrency::DetailingSection::~DetailingSection() {
+  if (!engaged) return;
+  if (--detailingDepth == 0 && holdsShared) {
+    releaseShared(state());
+  }
+};
+
+AltaCore::Concurrency::ExclusiveSection::ExclusiveSection():
+  engaged(active())
+{
+  if (!engaged) return;
+  if (exclusiveDepth > 0) {
+    ++exclusiveDepth;
+    return;
+  }
+  if (cacheDepth > 0) {
+    throw std::logic_error("can't enter an exclusive section while holding the cache lock");
+  }
+
+  auto& state = ::state();
+  // other workers can't reach a safepoint while we're waiting on them with shared access
+  if (holdsShared) {
+    releaseShared(state);
+  }
+
+  std::unique_lock<std::mutex> lock(state.mutex);
+  ++state.writersWaiting;
+  state.changed.wait(lock, [&]() {
+    return !state.writerActive && state.sharedHolders == 0;
+  });
+  --state.writersWaiting;
+  state.writerActive = true;
+  exclusiveDepth = 1;
+};
+
+AltaCore::Concurrency::ExclusiveSection::~ExclusiveSection() {
+  if (!engaged) return;
+  if (--exclusiveDepth > 0) return;
+
+  auto& state = ::state();
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.writerActive = false;
+  }
+  state.changed.notify_all();
+
+  if (detailingDepth > 0) {
+    acquireShared(state);
+  }
+};
+
+AltaCore::Concurrency::CacheLock::CacheLock():
+  lock(state().cacheMutex, std::defer_lock)
+{
+  if (active()) {
+    lock.lock();
+    ++cacheDepth;
+  }
+};
+
+AltaCore::Concurrency::CacheLock::~CacheLock() {
+  if (lock.owns_lock()) {
+    --cacheDepth;
+  }
+};
+
+void AltaCore::Concurrency::safepoint() {
+  if (!holdsShared) return;
+  auto& state = ::state();
+  if (state.writersWaiting == 0) return;
+  releaseShared(state);
+  acquireShared(state);
+};
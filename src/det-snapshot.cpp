@@ -0,0 +1,953 @@
+#include "../include/altacore/det-snapshot.hpp"
+#include "../include/altacore/det.hpp"
+#include "../include/altacore/det/variable.hpp"
+#include "../include/altacore/parser.hpp"
+#include "../include/altacore/util.hpp"
+#include <unordered_map>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+
+namespace AltaCore {
+  namespace DETSnapshot {
+    bool rehydrateImports = false;
+  };
+};
+
+namespace {
+  using namespace AltaCore;
+
+  // bump this whenever the encoding (or any serialized DET node) changes
+  static const uint64_t formatVersion = 1;
+  static const char magic[8] = { 'A', 'L', 'T', 'A', 'D', 'E', 'T', '\0' };
+
+  enum class ItemReference {
+    Null,
+    Local,
+    External,
+    InlineType,
+  };
+
+  enum class ScopeKind {
+    Module,
+    Exports,
+    Class,
+    Function,
+    Namespace,
+  };
+
+  enum class ScopeReference {
+    Null,
+    Local,
+    ExternalModule,
+    ExternalExports,
+  };
+
+  /**
+   * Identifies a dependency's source without caring about the definitions it was parsed with;
+   * those are already covered by the key of the module that imported it
+   */
+  static ASTCache::CacheKey sourceKey(Filesystem::Path path) {
+    std::ifstream file(path.absolutify().toString(), std::ios::binary);
+    std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return ASTCache::CacheKey(path, source, {});
+  };
+
+  static void writeKey(Serialization::Writer& writer, const ASTCache::CacheKey& key) {
+    writer.writeString(key.path);
+    writer.writeVarint(static_cast<uint64_t>(key.modificationTime));
+    writer.writeVarint(key.contentHash);
+    writer.writeVarint(key.definitionsHash);
+  };
+  static ASTCache::CacheKey readKey(Serialization::Reader& reader) {
+    ASTCache::CacheKey key;
+    key.path = reader.readString();
+    key.modificationTime = static_cast<int64_t>(reader.readVarint());
+    key.contentHash = reader.readVarint();
+    key.definitionsHash = reader.readVarint();
+    return key;
+  };
+
+  /**
+   * Everything in the module that the snapshot has to include, in the order they'll be written
+   *
+   * Items and scopes reference each other cyclically (e.g. a class and its methods), so they're
+   * written in two parts: first a "shell" with just enough information to allocate each object,
+   * then a body that fills in all the references.
+   */
+  struct Tables {
+    std::shared_ptr<DET::Module> module;
+    std::vector<std::shared_ptr<DET::ScopeItem>> items;
+    std::unordered_map<std::shared_ptr<DET::ScopeItem>, size_t> itemIndices;
+    std::vector<std::shared_ptr<DET::Scope>> scopes;
+    std::unordered_map<std::shared_ptr<DET::Scope>, size_t> scopeIndices;
+    bool frozen = false;
+  };
+
+  class Encoder: public Serialization::Writer {
+    private:
+      Tables& tables;
+
+      size_t collect(std::shared_ptr<DET::ScopeItem> item) {
+        auto it = tables.itemIndices.find(item);
+        if (it != tables.itemIndices.end()) return it->second;
+        if (tables.frozen) {
+          throw std::logic_error("DET snapshot tables changed while writing");
+        }
+        auto index = tables.items.size();
+        tables.items.push_back(item);
+        tables.itemIndices[item] = index;
+        return index;
+      };
+      size_t collect(std::shared_ptr<DET::Scope> scope) {
+        auto it = tables.scopeIndices.find(scope);
+        if (it != tables.scopeIndices.end()) return it->second;
+        if (tables.frozen) {
+          throw std::logic_error("DET snapshot tables changed while writing");
+        }
+        auto index = tables.scopes.size();
+        tables.scopes.push_back(scope);
+        tables.scopeIndices[scope] = index;
+        return index;
+      };
+
+      bool owns(std::shared_ptr<DET::ScopeItem> item) const {
+        auto parent = item->parentScope.lock();
+        // detached items (e.g. namespaces created for `export * as foo`) can only be
+        // reached through whoever created them, so they're always ours
+        if (!parent) return true;
+        return Util::getModule(parent.get()).lock() == tables.module;
+      };
+
+      void writeExternal(std::shared_ptr<DET::ScopeItem> item) {
+        // external items are identified by their path from their module's root scope,
+        // with each step disambiguated by its position among items of the same name
+        std::vector<std::pair<std::string, size_t>> chain;
+        std::shared_ptr<DET::Module> owner = nullptr;
+        auto current = item;
+
+        while (!owner) {
+          auto scope = current->parentScope.lock();
+          if (!scope) {
+            throw DETSnapshot::UnsupportedInterfaceError("can't reference detached item \"" + item->name + "\" from another module");
+          }
+
+          size_t ordinal = 0;
+          bool found = false;
+          for (auto& sibling: scope->items) {
+            if (sibling == current) {
+              found = true;
+              break;
+            }
+            if (sibling->name == current->name) {
+              ordinal++;
+            }
+          }
+          if (!found) {
+            throw DETSnapshot::UnsupportedInterfaceError("can't locate \"" + item->name + "\" in its parent scope");
+          }
+          chain.emplace_back(current->name, ordinal);
+
+          if (auto mod = scope->parentModule.lock()) {
+            if (scope != mod->scope) {
+              throw DETSnapshot::UnsupportedInterfaceError("can't reference \"" + item->name + "\" outside its module's root scope");
+            }
+            owner = mod;
+          } else if (auto klass = scope->parentClass.lock()) {
+            current = klass;
+          } else if (auto ns = scope->parentNamespace.lock()) {
+            current = ns;
+          } else if (auto func = scope->parentFunction.lock()) {
+            current = func;
+          } else {
+            throw DETSnapshot::UnsupportedInterfaceError("can't reference \"" + item->name + "\" declared in a nested block");
+          }
+        }
+
+        writeString(owner->path.toString());
+        writeVarint(chain.size());
+        for (auto it = chain.rbegin(); it != chain.rend(); it++) {
+          writeString(it->first);
+          writeVarint(it->second);
+        }
+      };
+
+      void writePosition(const Errors::Position& position) {
+        writeVarint(position.line);
+        writeVarint(position.column);
+        writeVarint(position.filePosition);
+        writeString(position.file.toString());
+      };
+
+      void writeTypeFields(std::shared_ptr<DET::Type> type) {
+        writeString(type->name);
+        writeBool(type->isAny);
+        writeBool(type->isNative);
+        writeBool(type->isFunction);
+        writeBool(type->isMethod);
+        writeBool(type->isAccessor);
+        writeBool(type->throws);
+        writeBool(type->isRawFunction);
+        writeItem(type->methodParent);
+        writeEnum(type->nativeTypeName);
+        writeString(type->userDefinedName);
+        writeItem(type->klass);
+        writeItem(type->returnType);
+        writeVarint(type->parameters.size());
+        for (auto& [name, paramType, isVariable, id]: type->parameters) {
+          writeString(name);
+          writeItem(paramType);
+          writeBool(isVariable);
+          writeString(id);
+        }
+        writeItems(type->unionOf);
+        writeItem(type->bitfield);
+        writeBool(type->isOptional);
+        writeItem(type->optionalTarget);
+        writeVarint(type->modifiers.size());
+        for (auto modifier: type->modifiers) {
+          writeVarint(modifier);
+        }
+      };
+
+    public:
+      Encoder(Tables& _tables):
+        tables(_tables)
+        {};
+
+      void writeItem(std::shared_ptr<DET::ScopeItem> item) {
+        if (!item) {
+          writeEnum(ItemReference::Null);
+          return;
+        }
+
+        auto it = tables.itemIndices.find(item);
+        if (it != tables.itemIndices.end()) {
+          writeEnum(ItemReference::Local);
+          writeVarint(it->second);
+          return;
+        }
+
+        // types are values; unless they're declared in a scope (i.e. type aliases),
+        // they're just written out in full wherever they're used
+        if (item->nodeType() == DET::NodeType::Type) {
+          writeEnum(ItemReference::InlineType);
+          writeTypeFields(std::dynamic_pointer_cast<DET::Type>(item));
+          return;
+        }
+
+        if (owns(item)) {
+          writeEnum(ItemReference::Local);
+          writeVarint(collect(item));
+          return;
+        }
+
+        writeEnum(ItemReference::External);
+        writeExternal(item);
+      };
+      template<typename T>
+      void writeItems(const std::vector<std::shared_ptr<T>>& items) {
+        writeVarint(items.size());
+        for (auto& item: items) {
+          writeItem(item);
+        }
+      };
+
+      void writeScope(std::shared_ptr<DET::Scope> scope) {
+        if (!scope) {
+          writeEnum(ScopeReference::Null);
+          return;
+        }
+
+        auto owner = Util::getModule(scope.get()).lock();
+        if (owner == tables.module) {
+          writeEnum(ScopeReference::Local);
+          writeVarint(collect(scope));
+        } else if (owner && scope == owner->scope) {
+          writeEnum(ScopeReference::ExternalModule);
+          writeString(owner->path.toString());
+        } else if (owner && scope == owner->exports) {
+          writeEnum(ScopeReference::ExternalExports);
+          writeString(owner->path.toString());
+        } else {
+          throw DETSnapshot::UnsupportedInterfaceError("can't reference a nested scope from another module");
+        }
+      };
+
+      void writeItemShell(std::shared_ptr<DET::ScopeItem> item) {
+        writeEnum(item->nodeType());
+        writeString(item->name);
+        writePosition(item->position);
+        writeEnum(item->visibility);
+        writeVarint(item->genericParameterCount);
+        writeVarint(item->moduleIndex);
+        writeVarint(item->itemID);
+        writeBool(item->instantiatedFromSamePackage);
+      };
+
+      void writeItemBody(std::shared_ptr<DET::ScopeItem> item) {
+        writeScope(item->parentScope.lock());
+        writeItems(item->publicHoistedItems);
+
+        switch (item->nodeType()) {
+          case DET::NodeType::Type: {
+            writeTypeFields(std::dynamic_pointer_cast<DET::Type>(item));
+          } break;
+          case DET::NodeType::Variable: {
+            auto var = std::dynamic_pointer_cast<DET::Variable>(item);
+            writeItem(var->type);
+            writeBool(var->isLiteral);
+            writeBool(var->isExport);
+            writeBool(var->isVariable);
+            writeBool(var->isBitfieldEntry);
+            writeVarint(var->bitfieldBits.first);
+            writeVarint(var->bitfieldBits.second);
+          } break;
+          case DET::NodeType::Alias: {
+            auto alias = std::dynamic_pointer_cast<DET::Alias>(item);
+            writeItem(alias->target);
+          } break;
+          case DET::NodeType::Namespace: {
+            auto ns = std::dynamic_pointer_cast<DET::Namespace>(item);
+            writeScope(ns->scope);
+            writeItems(ns->hoistedFunctionalTypes);
+            writeItem(ns->underlyingEnumerationType);
+            writeItem(ns->enumerationLookupFunction);
+            writeItem(ns->enumerationReverseLookupFunction);
+          } break;
+          case DET::NodeType::Function: {
+            auto func = std::dynamic_pointer_cast<DET::Function>(item);
+            writeVarint(func->parameters.size());
+            for (auto& [name, paramType, isVariable, id]: func->parameters) {
+              writeString(name);
+              writeItem(paramType);
+              writeBool(isVariable);
+              writeString(id);
+            }
+            writeItems(func->parameterVariables);
+            writeItem(func->returnType);
+            writeScope(func->scope);
+            writeBool(func->isLiteral);
+            writeBool(func->isExport);
+            writeBool(func->isMethod);
+            writeBool(func->isAccessor);
+            writeBool(func->isDestructor);
+            writeBool(func->isLambda);
+            writeBool(func->isOperator);
+            writeBool(func->isGenerator);
+            writeBool(func->isAsync);
+            writeBool(func->isConstructor);
+            writeEnum(func->operatorType);
+            writeEnum(func->orientation);
+            writeItem(func->generatorParameterType);
+            writeItem(func->generatorReturnType);
+            writeItem(func->coroutineReturnType);
+            writeItem(func->optionalVariantParent);
+            writeBool(func->throws());
+            writeBool(func->isVirtual());
+            writeItem(func->parentClassType);
+            writeItems(func->genericArguments);
+          } break;
+          case DET::NodeType::Class: {
+            auto klass = std::dynamic_pointer_cast<DET::Class>(item);
+            writeBool(klass->isStructure);
+            writeBool(klass->isExternal);
+            writeBool(klass->isTyped);
+            writeBool(klass->isLiteral);
+            writeBool(klass->isExport);
+            writeBool(klass->isBitfield);
+            writeScope(klass->scope);
+            writeItem(klass->defaultConstructor);
+            writeItems(klass->constructors);
+            writeItem(klass->destructor);
+            writeItems(klass->parents);
+            writeItem(klass->copyConstructor);
+            writeItems(klass->members);
+            writeItems(klass->fromCasts);
+            writeItems(klass->toCasts);
+            writeItems(klass->operators);
+            writeItems(klass->genericArguments);
+            writeItem(klass->underlyingBitfieldType.lock());
+            writeItem(klass->suspendableInput);
+            writeItem(klass->suspendableOutput);
+          } break;
+          default: {
+            throw DETSnapshot::UnsupportedInterfaceError("can't snapshot items of this type");
+          }
+        }
+      };
+
+      void writeScopeShell(std::shared_ptr<DET::Scope> scope) {
+        if (auto mod = scope->parentModule.lock()) {
+          writeEnum(scope == mod->exports ? ScopeKind::Exports : ScopeKind::Module);
+        } else if (auto klass = scope->parentClass.lock()) {
+          writeEnum(ScopeKind::Class);
+          writeVarint(collect(klass));
+        } else if (auto func = scope->parentFunction.lock()) {
+          writeEnum(ScopeKind::Function);
+          writeVarint(collect(func));
+        } else if (auto ns = scope->parentNamespace.lock()) {
+          writeEnum(ScopeKind::Namespace);
+          writeVarint(collect(ns));
+        } else {
+          throw DETSnapshot::UnsupportedInterfaceError("can't snapshot nested block scopes");
+        }
+        writePosition(scope->position);
+        writeVarint(scope->relativeID);
+        writeVarint(scope->nextChildID);
+        writeVarint(scope->nextItemID);
+        writeBool(scope->noRuntime);
+      };
+
+      void writeScopeBody(std::shared_ptr<DET::Scope> scope) {
+        // function bodies aren't part of the interface, only their parameters are
+        if (auto func = scope->parentFunction.lock()) {
+          writeItems(func->parameterVariables);
+          return;
+        }
+
+        writeVarint(scope->items.size());
+        for (auto& item: scope->items) {
+          if (item->nodeType() == DET::NodeType::Type && owns(item) && item->parentScope.lock() == scope) {
+            // declared here, so it has an identity of its own
+            collect(item);
+          }
+          writeItem(item);
+        }
+      };
+  };
+
+  class Decoder: public Serialization::Reader {
+    private:
+      DETSnapshot::ModuleResolver resolve;
+      ALTACORE_MAP<std::string, std::shared_ptr<DET::Module>> externalModules;
+
+      std::shared_ptr<DET::Module> externalModule(std::string path) {
+        auto it = externalModules.find(path);
+        if (it != externalModules.end()) return it->second;
+        auto mod = resolve(Filesystem::Path(path));
+        if (!mod) {
+          throw DETSnapshot::SnapshotError("failed to resolve snapshot dependency \"" + path + "\"");
+        }
+        externalModules[path] = mod;
+        return mod;
+      };
+
+      std::shared_ptr<DET::ScopeItem> readExternal() {
+        auto mod = externalModule(readString());
+        auto count = readVarint();
+        if (count == 0) {
+          throw DETSnapshot::SnapshotError("empty external reference in DET snapshot");
+        }
+
+        auto scope = mod->scope;
+        std::shared_ptr<DET::ScopeItem> item = nullptr;
+        for (uint64_t i = 0; i < count; i++) {
+          auto name = readString();
+          auto ordinal = readVarint();
+          if (!scope) {
+            throw DETSnapshot::SnapshotError("external reference to \"" + name + "\" goes through an item without a scope");
+          }
+          item = nullptr;
+          for (auto& candidate: scope->items) {
+            if (candidate->name != name) continue;
+            if (ordinal == 0) {
+              item = candidate;
+              break;
+            }
+            ordinal--;
+          }
+          if (!item) {
+            throw DETSnapshot::SnapshotError("external item \"" + name + "\" no longer exists in \"" + mod->path.toString() + "\"");
+          }
+          scope = DET::Scope::getMemberScope(item);
+        }
+        return item;
+      };
+
+      Errors::Position readPosition() {
+        Errors::Position position;
+        position.line = readVarint();
+        position.column = readVarint();
+        position.filePosition = readVarint();
+        position.file = readPath();
+        return position;
+      };
+
+      size_t readIndex(size_t limit) {
+        auto index = readVarint();
+        if (index >= limit) {
+          throw DETSnapshot::SnapshotError("invalid reference in DET snapshot");
+        }
+        return index;
+      };
+
+      void readTypeFields(std::shared_ptr<DET::Type> type) {
+        type->name = readString();
+        type->isAny = readBool();
+        type->isNative = readBool();
+        type->isFunction = readBool();
+        type->isMethod = readBool();
+        type->isAccessor = readBool();
+        type->throws = readBool();
+        type->isRawFunction = readBool();
+        type->methodParent = readItem<DET::Class>();
+        type->nativeTypeName = readEnum<DET::NativeType>();
+        type->userDefinedName = readString();
+        type->klass = readItem<DET::Class>();
+        type->returnType = readItem<DET::Type>();
+        auto paramCount = readVarint();
+        for (uint64_t i = 0; i < paramCount; i++) {
+          auto name = readString();
+          auto paramType = readItem<DET::Type>();
+          auto isVariable = readBool();
+          auto id = readString();
+          type->parameters.emplace_back(name, paramType, isVariable, id);
+        }
+        type->unionOf = readItems<DET::Type>();
+        type->bitfield = readItem<DET::Class>();
+        type->isOptional = readBool();
+        type->optionalTarget = readItem<DET::Type>();
+        auto modifierCount = readVarint();
+        for (uint64_t i = 0; i < modifierCount; i++) {
+          type->modifiers.push_back(static_cast<uint8_t>(readVarint()));
+        }
+      };
+
+    public:
+      std::shared_ptr<DET::Module> module = nullptr;
+      std::vector<std::shared_ptr<DET::ScopeItem>> items;
+      std::vector<std::shared_ptr<DET::Scope>> scopes;
+
+      Decoder(const char* data, size_t size, DETSnapshot::ModuleResolver _resolve):
+        Reader(data, size),
+        resolve(_resolve)
+        {};
+
+      std::shared_ptr<DET::ScopeItem> readAnyItem() {
+        auto reference = readEnum<ItemReference>();
+        switch (reference) {
+          case ItemReference::Null: {
+            return nullptr;
+          }
+          case ItemReference::Local: {
+            return items[readIndex(items.size())];
+          }
+          case ItemReference::External: {
+            return readExternal();
+          }
+          case ItemReference::InlineType: {
+            auto type = std::make_shared<DET::Type>();
+            readTypeFields(type);
+            return type;
+          }
+        }
+        throw DETSnapshot::SnapshotError("invalid item reference in DET snapshot");
+      };
+      template<typename T>
+      std::shared_ptr<T> readItem() {
+        auto item = readAnyItem();
+        if (!item) return nullptr;
+        auto target = std::dynamic_pointer_cast<T>(item);
+        if (!target) {
+          throw DETSnapshot::SnapshotError("unexpected item type in DET snapshot");
+        }
+        return target;
+      };
+      template<typename T>
+      std::vector<std::shared_ptr<T>> readItems() {
+        std::vector<std::shared_ptr<T>> result;
+        auto count = readVarint();
+        for (uint64_t i = 0; i < count; i++) {
+          result.push_back(readItem<T>());
+        }
+        return result;
+      };
+
+      std::shared_ptr<DET::Scope> readScope() {
+        auto reference = readEnum<ScopeReference>();
+        switch (reference) {
+          case ScopeReference::Null: {
+            return nullptr;
+          }
+          case ScopeReference::Local: {
+            return scopes[readIndex(scopes.size())];
+          }
+          case ScopeReference::ExternalModule: {
+            return externalModule(readString())->scope;
+          }
+          case ScopeReference::ExternalExports: {
+            return externalModule(readString())->exports;
+          }
+        }
+        throw DETSnapshot::SnapshotError("invalid scope reference in DET snapshot");
+      };
+
+      std::shared_ptr<DET::ScopeItem> readItemShell() {
+        auto type = readEnum<DET::NodeType>();
+        auto name = readString();
+        auto position = readPosition();
+
+        std::shared_ptr<DET::ScopeItem> item = nullptr;
+        switch (type) {
+          case DET::NodeType::Type: {
+            item = std::make_shared<DET::Type>();
+          } break;
+          case DET::NodeType::Variable: {
+            item = std::make_shared<DET::Variable>(name, nullptr, position);
+          } break;
+          case DET::NodeType::Alias: {
+            item = std::make_shared<DET::Alias>(name, nullptr, position);
+          } break;
+          case DET::NodeType::Namespace: {
+            item = std::make_shared<DET::Namespace>(name, position);
+          } break;
+          case DET::NodeType::Function: {
+            item = std::make_shared<DET::Function>(nullptr, name, position);
+          } break;
+          case DET::NodeType::Class: {
+            item = std::make_shared<DET::Class>(name, nullptr, position);
+          } break;
+          default: {
+            throw DETSnapshot::SnapshotError("unknown item type in DET snapshot");
+          }
+        }
+
+        item->name = name;
+        item->position = position;
+        item->visibility = readEnum<Shared::Visibility>();
+        item->genericParameterCount = readVarint();
+        item->moduleIndex = readVarint();
+        item->itemID = readVarint();
+        item->instantiatedFromSamePackage = readBool();
+        return item;
+      };
+
+      void readItemBody(std::shared_ptr<DET::ScopeItem> item) {
+        item->parentScope = readScope();
+        item->publicHoistedItems = readItems<DET::ScopeItem>();
+
+        switch (item->nodeType()) {
+          case DET::NodeType::Type: {
+            readTypeFields(std::dynamic_pointer_cast<DET::Type>(item));
+          } break;
+          case DET::NodeType::Variable: {
+            auto var = std::dynamic_pointer_cast<DET::Variable>(item);
+            var->type = readItem<DET::Type>();
+            var->isLiteral = readBool();
+            var->isExport = readBool();
+            var->isVariable = readBool();
+            var->isBitfieldEntry = readBool();
+            var->bitfieldBits.first = readVarint();
+            var->bitfieldBits.second = readVarint();
+          } break;
+          case DET::NodeType::Alias: {
+            auto alias = std::dynamic_pointer_cast<DET::Alias>(item);
+            alias->target = readAnyItem();
+          } break;
+          case DET::NodeType::Namespace: {
+            auto ns = std::dynamic_pointer_cast<DET::Namespace>(item);
+            ns->scope = readScope();
+            ns->hoistedFunctionalTypes = readItems<DET::Type>();
+            ns->underlyingEnumerationType = readItem<DET::Type>();
+            ns->enumerationLookupFunction = readItem<DET::Function>();
+            ns->enumerationReverseLookupFunction = readItem<DET::Function>();
+          } break;
+          case DET::NodeType::Function: {
+            auto func = std::dynamic_pointer_cast<DET::Function>(item);
+            auto paramCount = readVarint();
+            for (uint64_t i = 0; i < paramCount; i++) {
+              auto name = readString();
+              auto paramType = readItem<DET::Type>();
+              auto isVariable = readBool();
+              auto id = readString();
+              func->parameters.emplace_back(name, paramType, isVariable, id);
+            }
+            func->parameterVariables = readItems<DET::Variable>();
+            func->returnType = readItem<DET::Type>();
+            func->scope = readScope();
+            func->isLiteral = readBool();
+            func->isExport = readBool();
+            func->isMethod = readBool();
+            func->isAccessor = readBool();
+            func->isDestructor = readBool();
+            func->isLambda = readBool();
+            func->isOperator = readBool();
+            func->isGenerator = readBool();
+            func->isAsync = readBool();
+            func->isConstructor = readBool();
+            func->operatorType = readEnum<Shared::ClassOperatorType>();
+            func->orientation = readEnum<Shared::ClassOperatorOrientation>();
+            func->generatorParameterType = readItem<DET::Type>();
+            func->generatorReturnType = readItem<DET::Type>();
+            func->coroutineReturnType = readItem<DET::Type>();
+            func->optionalVariantParent = readItem<DET::Function>();
+            // nobody's listening to `beganThrowing` yet, so this won't trigger anything
+            if (readBool()) func->throws(true);
+            func->setVirtual(readBool());
+            func->parentClassType = readItem<DET::Type>();
+            func->genericArguments = readItems<DET::Type>();
+          } break;
+          case DET::NodeType::Class: {
+            auto klass = std::dynamic_pointer_cast<DET::Class>(item);
+            klass->isStructure = readBool();
+            klass->isExternal = readBool();
+            klass->isTyped = readBool();
+            klass->isLiteral = readBool();
+            klass->isExport = readBool();
+            klass->isBitfield = readBool();
+            klass->scope = readScope();
+            klass->defaultConstructor = readItem<DET::Function>();
+            klass->constructors = readItems<DET::Function>();
+            klass->destructor = readItem<DET::Function>();
+            klass->parents = readItems<DET::Class>();
+            klass->copyConstructor = readItem<DET::Function>();
+            klass->members = readItems<DET::Variable>();
+            klass->fromCasts = readItems<DET::Function>();
+            klass->toCasts = readItems<DET::Function>();
+            klass->operators = readItems<DET::Function>();
+            klass->genericArguments = readItems<DET::Type>();
+            klass->underlyingBitfieldType = readItem<DET::Type>();
+            klass->suspendableInput = readItem<DET::Type>();
+            klass->suspendableOutput = readItem<DET::Type>();
+          } break;
+          default: {
+            throw DETSnapshot::SnapshotError("unknown item type in DET snapshot");
+          }
+        }
+      };
+
+      std::shared_ptr<DET::Scope> readScopeShell() {
+        auto kind = readEnum<ScopeKind>();
+        std::shared_ptr<DET::Scope> scope = nullptr;
+
+        switch (kind) {
+          case ScopeKind::Module: {
+            scope = module->scope;
+          } break;
+          case ScopeKind::Exports: {
+            scope = module->exports;
+          } break;
+          case ScopeKind::Class: {
+            auto owner = std::dynamic_pointer_cast<DET::Class>(items[readIndex(items.size())]);
+            if (!owner) throw DETSnapshot::SnapshotError("class scope owned by a non-class");
+            scope = std::make_shared<DET::Scope>(owner);
+          } break;
+          case ScopeKind::Function: {
+            auto owner = std::dynamic_pointer_cast<DET::Function>(items[readIndex(items.size())]);
+            if (!owner) throw DETSnapshot::SnapshotError("function scope owned by a non-function");
+            scope = std::make_shared<DET::Scope>(owner);
+          } break;
+          case ScopeKind::Namespace: {
+            auto owner = std::dynamic_pointer_cast<DET::Namespace>(items[readIndex(items.size())]);
+            if (!owner) throw DETSnapshot::SnapshotError("namespace scope owned by a non-namespace");
+            scope = std::make_shared<DET::Scope>(owner);
+          } break;
+          default: {
+            throw DETSnapshot::SnapshotError("unknown scope kind in DET snapshot");
+          }
+        }
+
+        scope->position = readPosition();
+        scope->relativeID = readVarint();
+        scope->nextChildID = readVarint();
+        scope->nextItemID = readVarint();
+        scope->noRuntime = readBool();
+        return scope;
+      };
+
+      void readScopeBody(std::shared_ptr<DET::Scope> scope) {
+        scope->items = readItems<DET::ScopeItem>();
+      };
+  };
+
+  static bool isGenericTemplate(std::shared_ptr<DET::ScopeItem> item) {
+    if (item->genericParameterCount == 0) return false;
+    if (auto klass = std::dynamic_pointer_cast<DET::Class>(item)) {
+      return klass->genericArguments.size() == 0;
+    }
+    if (auto func = std::dynamic_pointer_cast<DET::Function>(item)) {
+      return func->genericArguments.size() == 0;
+    }
+    return false;
+  };
+};
+
+std::string AltaCore::DETSnapshot::serialize(std::shared_ptr<DET::Module> module, const ASTCache::CacheKey& key) {
+  Tables tables;
+  tables.module = module;
+
+  // first, discover everything reachable from the module's scopes. writing each
+  // entry into a scratch buffer collects whatever it references along the way
+  {
+    Encoder scratch(tables);
+    scratch.writeScope(module->scope);
+    scratch.writeScope(module->exports);
+    size_t itemsDone = 0;
+    size_t scopesDone = 0;
+    while (itemsDone < tables.items.size() || scopesDone < tables.scopes.size()) {
+      for (; itemsDone < tables.items.size(); itemsDone++) {
+        scratch.writeItemShell(tables.items[itemsDone]);
+        scratch.writeItemBody(tables.items[itemsDone]);
+      }
+      for (; scopesDone < tables.scopes.size(); scopesDone++) {
+        scratch.writeScopeShell(tables.scopes[scopesDone]);
+        scratch.writeScopeBody(tables.scopes[scopesDone]);
+      }
+    }
+  }
+
+  tables.frozen = true;
+
+  Encoder encoder(tables);
+  encoder.writeRaw(magic, sizeof(magic));
+  encoder.writeVarint(formatVersion);
+  writeKey(encoder, key);
+
+  encoder.writeString(module->name);
+  encoder.writeString(module->path.toString());
+  encoder.writeVarint(module->dependencies.size());
+  for (auto& dependency: module->dependencies) {
+    writeKey(encoder, sourceKey(dependency->path));
+  }
+
+  encoder.writeVarint(tables.items.size());
+  for (auto& item: tables.items) {
+    encoder.writeItemShell(item);
+  }
+  encoder.writeVarint(tables.scopes.size());
+  for (auto& scope: tables.scopes) {
+    encoder.writeScopeShell(scope);
+  }
+  for (auto& item: tables.items) {
+    encoder.writeItemBody(item);
+  }
+  for (auto& scope: tables.scopes) {
+    encoder.writeScopeBody(scope);
+  }
+
+  return encoder.buffer;
+};
+
+std::shared_ptr<AltaCore::DET::Module> AltaCore::DETSnapshot::deserialize(const ASTCache::CacheKey& key, const char* data, size_t size, ModuleResolver resolveDependency, ModuleCallback created) {
+  Decoder decoder(data, size, resolveDependency);
+
+  char fileMagic[sizeof(magic)];
+  decoder.readRaw(fileMagic, sizeof(fileMagic));
+  if (std::memcmp(fileMagic, magic, sizeof(magic)) != 0) {
+    throw SnapshotError("not a DET snapshot");
+  }
+  if (decoder.readVarint() != formatVersion) {
+    throw SnapshotError("DET snapshot is from an incompatible version");
+  }
+  if (!(readKey(decoder) == key)) {
+    throw SnapshotError("DET snapshot is stale");
+  }
+
+  auto name = decoder.readString();
+  auto path = decoder.readPath();
+
+  // check every dependency before resolving any of them,
+  // so a stale snapshot never triggers any imports
+  std::vector<Filesystem::Path> dependencyPaths;
+  auto dependencyCount = decoder.readVarint();
+  for (uint64_t i = 0; i < dependencyCount; i++) {
+    auto dependencyKey = readKey(decoder);
+    Filesystem::Path dependencyPath(dependencyKey.path);
+    if (!(sourceKey(dependencyPath) == dependencyKey)) {
+      throw SnapshotError("a dependency of the DET snapshot has changed");
+    }
+    dependencyPaths.push_back(dependencyPath);
+  }
+
+  decoder.module = DET::Module::create(name, path);
+  if (created) {
+    created(decoder.module);
+  }
+  for (auto& dependencyPath: dependencyPaths) {
+    auto dependency = resolveDependency(dependencyPath);
+    if (!dependency) {
+      throw SnapshotError("failed to resolve snapshot dependency \"" + dependencyPath.toString() + "\"");
+    }
+    decoder.module->dependencies.push_back(dependency);
+  }
+
+  auto itemCount = decoder.readVarint();
+  for (uint64_t i = 0; i < itemCount; i++) {
+    decoder.items.push_back(decoder.readItemShell());
+  }
+  auto scopeCount = decoder.readVarint();
+  for (uint64_t i = 0; i < scopeCount; i++) {
+    decoder.scopes.push_back(decoder.readScopeShell());
+  }
+  for (auto& item: decoder.items) {
+    decoder.readItemBody(item);
+  }
+  for (auto& scope: decoder.scopes) {
+    decoder.readScopeBody(scope);
+  }
+
+  if (!decoder.atEnd()) {
+    throw SnapshotError("trailing data in DET snapshot");
+  }
+
+  // items were moved into their scopes and classes got their parents after they were created.
+  // these wipe every cache in the process, so only do it once, now that everything's in place
+  DET::Scope::invalidateParentChains();
+  DET::Class::invalidateHierarchies();
+  DET::Type::invalidateCasts();
+
+  return decoder.module;
+};
+
+bool AltaCore::DETSnapshot::hasGenericTemplates(std::shared_ptr<DET::Module> module) {
+  std::vector<std::shared_ptr<DET::Scope>> pending = { module->exports };
+  std::unordered_map<std::shared_ptr<DET::Scope>, bool> seen;
+
+  while (pending.size() > 0) {
+    auto scope = pending.back();
+    pending.pop_back();
+    if (!scope || seen[scope]) continue;
+    seen[scope] = true;
+
+    for (auto& item: scope->items) {
+      if (isGenericTemplate(item)) return true;
+      if (item->nodeType() == DET::NodeType::Class || item->nodeType() == DET::NodeType::Namespace) {
+        pending.push_back(DET::Scope::getMemberScope(item));
+      }
+    }
+  }
+
+  return false;
+};
+
+std::shared_ptr<AltaCore::DET::Module> AltaCore::DETSnapshot::load(const ASTCache::CacheKey& key, ModuleResolver resolveDependency, ModuleCallback created) {
+  if (!ASTCache::cacheDirectory) return nullptr;
+
+  std::shared_ptr<DET::Module> module = nullptr;
+  try {
+    Serialization::readFile(ASTCache::entryPath(key, "altadet"), [&](const char* data, size_t size) {
+      module = deserialize(key, data, size, resolveDependency, created);
+    });
+  } catch (SnapshotError&) {
+    module = nullptr;
+  }
+
+  return module;
+};
+
+void AltaCore::DETSnapshot::store(std::shared_ptr<DET::Module> module, const ASTCache::CacheKey& key) {
+  if (!ASTCache::cacheDirectory) return;
+
+  std::string data;
+  try {
+    data = serialize(module, key);
+  } catch (UnsupportedInterfaceError&) {
+    return;
+  }
+
+  auto& directory = ASTCache::cacheDirectory;
+  if (!directory.isDirectory() && !Filesystem::mkdirp(directory)) return;
+
+  Serialization::writeFileAtomically(ASTCache::entryPath(key, "altadet"), data);
+};
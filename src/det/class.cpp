@@ -3,13 +3,22 @@
 #include "../../include/altacore/ast/class-definition-node.hpp"
 #include "../../include/altacore/det/scope.hpp"
 #include "../../include/altacore/util.hpp"
+#include "../../include/altacore/concurrency.hpp"
+#include <functional>
+#include <algorithm>
 
 const AltaCore::DET::NodeType AltaCore::DET::Class::nodeType() {
   return NodeType::Class;
 };
 
 std::shared_ptr<AltaCore::DET::Node> AltaCore::DET::Class::clone() {
-  return std::make_shared<Class>(*this);
+  auto self = std::make_shared<Class>(*this);
+  // the clone gets its own tables (its scope might be replaced, e.g. by `deepClone`)
+  self->ancestorsGeneration = SIZE_MAX;
+  self->virtualsGeneration = SIZE_MAX;
+  self->castTablesGeneration = SIZE_MAX;
+  self->operatorTableGeneration = SIZE_MAX;
+  return self;
 };
 
 std::shared_ptr<AltaCore::DET::Node> AltaCore::DET::Class::deepClone() {
@@ -37,12 +46,48 @@ AltaCore::DET::Class::Class(std::string _name, std::shared_ptr<AltaCore::DET::Sc
   parents(_parents)
   {};
 
+size_t AltaCore::DET::Class::hierarchyGeneration = 0;
+
+void AltaCore::DET::Class::invalidateHierarchies() {
+  // other workers might be in the middle of using some hierarchy tables
+  Concurrency::ExclusiveSection exclusive;
+  hierarchyGeneration++;
+};
+
+void AltaCore::DET::Class::updateAncestors() const {
+  Concurrency::CacheLock lock;
+  if (ancestorsGeneration == hierarchyGeneration) return;
+
+  _ancestors.clear();
+  ancestorIDs.clear();
+
+  // this also guards against cyclic hierarchies (which are invalid anyways)
+  ancestorIDs.insert(id);
+
+  std::function<void(const Class&)> visit = [&](const Class& klass) {
+    for (auto& parent: klass.parents) {
+      if (!ancestorIDs.insert(parent->id).second) continue;
+      _ancestors.push_back(parent);
+      visit(*parent);
+    }
+  };
+  visit(*this);
+
+  ancestorIDs.erase(id);
+  ancestorsGeneration = hierarchyGeneration;
+};
+
+auto AltaCore::DET::Class::ancestors() const -> const std::vector<std::shared_ptr<Class>>& {
+  // the table is only ever rebuilt after an invalidation, which has to wait for everyone else
+  // to stop using it, so it's fine to hand out a reference to it
+  updateAncestors();
+  return _ancestors;
+};
+
 bool AltaCore::DET::Class::hasParent(std::shared_ptr<Class> parent) const {
-  for (auto& myParent: parents) {
-    if (myParent->id == parent->id) return true;
-    if (myParent->hasParent(parent)) return true;
-  }
-  return false;
+  Concurrency::CacheLock lock;
+  updateAncestors();
+  return ancestorIDs.find(parent->id) != ancestorIDs.end();
 };
 
 std::shared_ptr<AltaCore::DET::Class> AltaCore::DET::Class::instantiateGeneric(std::vector<std::shared_ptr<Type>> genericArguments) {
@@ -331,16 +376,59 @@ namespace {
   };
 };
 
+namespace {
+  size_t operatorKey(AltaCore::Shared::ClassOperatorType type, AltaCore::Shared::ClassOperatorOrientation orient) {
+    return (static_cast<size_t>(type) << 8) | static_cast<size_t>(orient);
+  };
+};
+
+void AltaCore::DET::Class::updateCastTables() {
+  Concurrency::CacheLock lock;
+  if (castTablesGeneration == Type::castGeneration()) return;
+  fromCastTable.clear();
+  toCastTable.clear();
+  castTablesGeneration = Type::castGeneration();
+};
+
 std::shared_ptr<AltaCore::DET::Function> AltaCore::DET::Class::findFromCast(const Type& from) {
+  updateCastTables();
+
+  auto canonical = Type::findInterned(from);
+  size_t generation;
+  {
+    Concurrency::CacheLock lock;
+    if (canonical) {
+      auto it = fromCastTable.find(canonical);
+      if (it != fromCastTable.end()) return it->second;
+    }
+    generation = Type::castGeneration();
+  }
+
+  auto result = findFromCastUncached(from);
+
+  Concurrency::CacheLock lock;
+
+  // only store the result if no casts changed while we were searching
+  if (generation == Type::castGeneration()) {
+    if (!canonical) canonical = Type::intern(from.copy()).get();
+    fromCastTable[canonical] = result;
+  }
+
+  return result;
+};
+
+std::shared_ptr<AltaCore::DET::Function> AltaCore::DET::Class::findFromCastUncached(const Type& from) {
   for (auto& fromFunc: fromCasts) {
     auto special = std::get<1>(fromFunc->parameters[0]);
     if (from == *special || from == *special->deconstify() || from == *special->deconstify(true) || *from.deconstify() == *special || *from.deconstify() == *special->deconstify()) {
       return fromFunc;
     }
   }
+  if (fromCasts.empty()) return nullptr;
+  auto fromCopy = std::make_shared<Type>(from);
   for (auto& fromFunc: fromCasts) {
     auto special = std::get<1>(fromFunc->parameters[0]);
-    if (doFromOrToLoop(std::make_shared<Type>(from), special)) return fromFunc;
+    if (doFromOrToLoop(fromCopy, special)) return fromFunc;
   }
   // note that for `from` casts, we CANNOT search parents for cast methods
   // this is because we cannot automatically construct a child from a parent
@@ -348,15 +436,44 @@ std::shared_ptr<AltaCore::DET::Function> AltaCore::DET::Class::findFromCast(cons
 };
 
 std::shared_ptr<AltaCore::DET::Function> AltaCore::DET::Class::findToCast(const Type& to) {
+  updateCastTables();
+
+  auto canonical = Type::findInterned(to);
+  size_t generation;
+  {
+    Concurrency::CacheLock lock;
+    if (canonical) {
+      auto it = toCastTable.find(canonical);
+      if (it != toCastTable.end()) return it->second;
+    }
+    generation = Type::castGeneration();
+  }
+
+  auto result = findToCastUncached(to);
+
+  Concurrency::CacheLock lock;
+
+  if (generation == Type::castGeneration()) {
+    if (!canonical) canonical = Type::intern(to.copy()).get();
+    toCastTable[canonical] = result;
+  }
+
+  return result;
+};
+
+std::shared_ptr<AltaCore::DET::Function> AltaCore::DET::Class::findToCastUncached(const Type& to) {
   for (auto& toFunc: toCasts) {
     auto special = toFunc->returnType;
     if (*special == to || *special == *to.deconstify() || *special == *to.deconstify(true) || *special->deconstify() == to || *special->deconstify() == *to.deconstify()) {
       return toFunc;
     }
   }
-  for (auto& toFunc: toCasts) {
-    auto special = toFunc->returnType;
-    if (doFromOrToLoop(special, std::make_shared<Type>(to))) return toFunc;
+  if (!toCasts.empty()) {
+    auto toCopy = std::make_shared<Type>(to);
+    for (auto& toFunc: toCasts) {
+      auto special = toFunc->returnType;
+      if (doFromOrToLoop(special, toCopy)) return toFunc;
+    }
   }
   if (to.unionOf.size() > 0) {
     for (auto& uni: to.unionOf) {
@@ -370,42 +487,94 @@ std::shared_ptr<AltaCore::DET::Function> AltaCore::DET::Class::findToCast(const
   return nullptr;
 };
 
+void AltaCore::DET::Class::updateOperatorTable() const {
+  Concurrency::CacheLock lock;
+  if (operatorTableGeneration == hierarchyGeneration) return;
+
+  operatorTable.clear();
+
+  auto addOperators = [&](const Class& klass) {
+    ALTACORE_MAP<size_t, std::vector<std::shared_ptr<Function>>> own;
+    for (auto& op: klass.operators) {
+      own[operatorKey(op->operatorType, op->orientation)].push_back(op);
+    }
+    for (auto& [key, ops]: own) {
+      operatorTable[key].push_back(std::move(ops));
+    }
+  };
+
+  addOperators(*this);
+  for (auto& ancestor: ancestors()) {
+    addOperators(*ancestor);
+  }
+
+  operatorTableGeneration = hierarchyGeneration;
+};
+
 std::shared_ptr<AltaCore::DET::Function> AltaCore::DET::Class::findOperator(const Shared::ClassOperatorType type, const Shared::ClassOperatorOrientation orient, std::shared_ptr<Type> argType) const {
-  size_t highestCompat = 0;
-  size_t compatIdx = SIZE_MAX;
-  for (size_t i = 0; i < operators.size(); ++i) {
-    auto& op = operators[i];
-    if (op->operatorType != type) continue;
-    if (op->orientation != orient) continue;
-    if (argType) {
+  Concurrency::CacheLock lock;
+  updateOperatorTable();
+
+  auto it = operatorTable.find(operatorKey(type, orient));
+  if (it == operatorTable.end()) return nullptr;
+
+  // the first class (searching upwards from us) that has a compatible operator wins
+  for (auto& ops: it->second) {
+    if (!argType) {
+      return ops.front();
+    }
+    size_t highestCompat = 0;
+    std::shared_ptr<Function> result = nullptr;
+    for (auto& op: ops) {
       auto compat = op->parameterVariables.front()->type->compatiblity(*argType);
       if (compat > highestCompat) {
         highestCompat = compat;
-        compatIdx = i;
+        result = op;
       }
-    } else {
-      highestCompat = SIZE_MAX;
-      compatIdx = i;
-      break;
     }
+    if (result) return result;
   }
-  if (highestCompat != 0) {
-    return operators[compatIdx];
-  }
-  for (auto& parent: parents) {
-    auto func = parent->findOperator(type, orient, argType);
-    if (func) return func;
-  }
+
   return nullptr;
 };
 
-std::vector<std::shared_ptr<AltaCore::DET::Function>> AltaCore::DET::Class::findAllVirtualFunctions() {
-  std::vector<std::shared_ptr<AltaCore::DET::Function>> virtFuncs;
+size_t AltaCore::DET::Class::membersVersion() const {
+  Concurrency::CacheLock lock;
+  // versions only ever increase, so the newest one changes whenever any of these scopes do
+  size_t version = scope ? scope->items.version() : 0;
+  for (auto& ancestor: ancestors()) {
+    if (ancestor->scope) {
+      version = std::max(version, ancestor->scope->items.version());
+    }
+  }
+  return version;
+};
+
+void AltaCore::DET::Class::updateVirtuals() {
+  Concurrency::CacheLock lock;
+  auto currentMembersVersion = membersVersion();
+  // only changes to this class or its ancestors (their parents, their members, or their
+  // methods' virtual-ness or signatures) can change the table
+  if (virtualsGeneration == hierarchyGeneration && virtualsMembersVersion == currentMembersVersion) return;
+
+  // stamp it with the generation we started from; if something changes while we're
+  // building the table (e.g. while finding a function's type), we'll rebuild it next time
+  auto startingGeneration = hierarchyGeneration;
+
+  declaredVirtuals.clear();
+  virtualTable.clear();
+
+  // name -> types already in the table
+  ALTACORE_MAP<std::string, std::vector<std::shared_ptr<Type>>> seen;
 
   for (auto& item: scope->items) {
     if (item->nodeType() != NodeType::Function) continue;
     auto func = std::dynamic_pointer_cast<Function>(item);
-    if (func->isVirtual()) virtFuncs.push_back(func);
+    if (!func->isVirtual()) continue;
+    auto type = Type::getUnderlyingType(func);
+    declaredVirtuals[func->name].emplace_back(func, type);
+    seen[func->name].push_back(type);
+    virtualTable.push_back(func);
   }
 
   for (auto& parent: parents) {
@@ -413,9 +582,10 @@ std::vector<std::shared_ptr<AltaCore::DET::Function>> AltaCore::DET::Class::find
 
     for (auto& otherFunc: otherFuncs) {
       auto otherType = Type::getUnderlyingType(otherFunc);
+      auto& types = seen[otherFunc->name];
       bool skip = false;
-      for (auto& virtFunc: virtFuncs) {
-        if (virtFunc->name == otherFunc->name && *Type::getUnderlyingType(virtFunc) == *otherType) {
+      for (auto& type: types) {
+        if (*type == *otherType) {
           skip = true;
           break;
         }
@@ -423,11 +593,40 @@ std::vector<std::shared_ptr<AltaCore::DET::Function>> AltaCore::DET::Class::find
       if (skip) {
         continue;
       }
-      virtFuncs.push_back(otherFunc);
+      types.push_back(otherType);
+      virtualTable.push_back(otherFunc);
+    }
+  }
+
+  virtualsGeneration = startingGeneration;
+  virtualsMembersVersion = currentMembersVersion;
+};
+
+std::vector<std::shared_ptr<AltaCore::DET::Function>> AltaCore::DET::Class::findAllVirtualFunctions() {
+  Concurrency::CacheLock lock;
+  updateVirtuals();
+  return virtualTable;
+};
+
+std::shared_ptr<AltaCore::DET::Function> AltaCore::DET::Class::findDeclaredVirtualFunction(const std::string& name, const Type& type, bool isAccessor, bool isOperator) {
+  Concurrency::CacheLock lock;
+  updateVirtuals();
+
+  auto it = declaredVirtuals.find(name);
+  if (it == declaredVirtuals.end()) return nullptr;
+
+  for (auto& [func, funcType]: it->second) {
+    if (func->isAccessor != isAccessor) continue;
+    if (func->isOperator != isOperator) continue;
+
+    if (isAccessor) {
+      if (*funcType->returnType == *type.returnType) return func;
+    } else {
+      if (*funcType == type) return func;
     }
   }
 
-  return virtFuncs;
+  return nullptr;
 };
 
 std::string AltaCore::DET::Class::toString() const {
@@ -466,7 +665,7 @@ bool AltaCore::DET::Class::isCaptureClass() const {
 };
 
 auto AltaCore::DET::Class::fullPrivateHoistedItems() const -> std::vector<std::shared_ptr<ScopeItem>> {
-  auto result = privateHoistedItems;
+  std::vector<std::shared_ptr<ScopeItem>> result = privateHoistedItems;
 
   for (auto& item: scope->items) {
     auto priv = item->fullPrivateHoistedItems();
@@ -2,6 +2,7 @@
 #include "../../include/altacore/det/class.hpp"
 #include "../../include/altacore/ast/function-definition-node.hpp"
 #include "../../include/altacore/util.hpp"
+#include "../../include/altacore/concurrency.hpp"
 
 const AltaCore::DET::NodeType AltaCore::DET::Function::nodeType() {
   return NodeType::Function;
@@ -24,6 +25,7 @@ std::shared_ptr<AltaCore::DET::Node> AltaCore::DET::Function::deepClone() {
   }
   self->scope = std::dynamic_pointer_cast<Scope>(scope->deepClone());
   self->scope->parentFunction = self;
+  Scope::invalidateParentChains();
   return self;
 };
 
@@ -66,10 +68,40 @@ std::vector<std::shared_ptr<AltaCore::DET::Function>> AltaCore::DET::Function::i
   }
 };
 
+void AltaCore::DET::Function::detailBody() {
+  if (!bodyDeferred) return;
+
+  // the function can be in a module that other workers are using
+  Concurrency::ExclusiveSection exclusive;
+  // someone else might've gotten to it while we were waiting
+  if (!bodyDeferred) return;
+
+  // clear it first; the body might reference this function (e.g. recursion)
+  bodyDeferred = false;
+
+  auto func = ast.lock();
+  auto inf = info.lock();
+  if (!func || !inf) return;
+
+  func->detail(inf, false);
+};
+
+void AltaCore::DET::Function::setVirtual(bool virt) {
+  _virtual = virt;
+  Class::invalidateHierarchies();
+};
+
 void AltaCore::DET::Function::recreate(std::vector<std::tuple<std::string, std::shared_ptr<Type>, bool, std::string>> _parameters, std::shared_ptr<Type> _returnType) {
   parameters = _parameters;
   returnType = _returnType;
 
+  // our type changed, so any overload resolution involving us has to be redone
+  // (and so do any casts that go through us)
+  if (auto parent = parentScope.lock()) {
+    parent->items.touch();
+  }
+  Type::invalidateCasts();
+
   for (auto& var: parameterVariables) {
     for (size_t i = 0; i < scope->items.size(); ++i) {
       if (scope->items[i]->id == var->id) {
@@ -107,51 +139,8 @@ bool AltaCore::DET::Function::isVirtual()  {
   auto pClass = pScope->parentClass.lock();
   auto thisType = Type::getUnderlyingType(shared_from_this());
 
-  std::function<bool(std::shared_ptr<Class>)> loop = [&](std::shared_ptr<Class> klass) {
-    for (auto& item: klass->scope->items) {
-      if (item->nodeType() != NodeType::Function) continue;
-      
-      auto func = std::dynamic_pointer_cast<DET::Function>(item);
-
-      if (!func) continue;
-
-      if (func->name != name) continue;
-
-      if (!func->isVirtual()) continue;
-
-      if (func->isAccessor != isAccessor) continue;
-      if (func->isOperator != isOperator) continue;
-
-      /**
-       * TODO: allow C++-style covariant overrides, e.g:
-       * class Parent {
-       *   public @virtual function hello(): ref Parent {
-       *     return this
-       *   }
-       * }
-       * 
-       * class Child {
-       *   public @virtual function hello(): ref Child {
-       *     return this
-       *   }
-       * }
-       */
-      if (isAccessor) {
-        if (*func->returnType == *thisType->returnType) return true;
-      } else {
-        if (*Type::getUnderlyingType(func) == *thisType) return true;
-      }
-    }
-
-    for (auto& parent: klass->parents) {
-      if (loop(parent)) return true;
-    }
-
-    return false;
-  };
-
-  for (auto& parent: pClass->parents) {
-    if (loop(parent)) return true;
+  for (auto& ancestor: pClass->ancestors()) {
+    if (ancestor->findDeclaredVirtualFunction(name, *thisType, isAccessor, isOperator)) return true;
   }
 
   return false;
@@ -213,7 +202,7 @@ std::string AltaCore::DET::Function::toString() const {
 };
 
 auto AltaCore::DET::Function::fullPrivateHoistedItems() const -> std::vector<std::shared_ptr<ScopeItem>> {
-  auto result = privateHoistedItems;
+  std::vector<std::shared_ptr<ScopeItem>> result = privateHoistedItems;
 
   for (auto& item: scope->items) {
     auto priv = item->fullPrivateHoistedItems();
@@ -12,6 +12,7 @@ std::shared_ptr<AltaCore::DET::Node> AltaCore::DET::Module::deepClone() {
   auto self = std::dynamic_pointer_cast<Module>(clone());
   self->scope = std::dynamic_pointer_cast<Scope>(scope->deepClone());
   self->scope->parentModule = self;
+  Scope::invalidateParentChains();
   return self;
 };
 
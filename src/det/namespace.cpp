@@ -30,7 +30,7 @@ AltaCore::DET::Namespace::Namespace(
   {};
 
 auto AltaCore::DET::Namespace::fullPrivateHoistedItems() const -> std::vector<std::shared_ptr<ScopeItem>> {
-  auto result = privateHoistedItems;
+  std::vector<std::shared_ptr<ScopeItem>> result = privateHoistedItems;
 
   for (auto& item: scope->items) {
     auto priv = item->fullPrivateHoistedItems();
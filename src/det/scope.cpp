@@ -6,13 +6,163 @@
 #include "../../include/altacore/det/variable.hpp"
 #include "../../include/altacore/det/class.hpp"
 #include "../../include/altacore/util.hpp"
+#include "../../include/altacore/concurrency.hpp"
+#include <algorithm>
+
+AltaCore::DET::ScopeItemList::ScopeItemList(std::vector<value_type> items):
+  list(std::move(items))
+{
+  reindex();
+};
+
+auto AltaCore::DET::ScopeItemList::operator=(std::vector<value_type> items) -> ScopeItemList& {
+  list = std::move(items);
+  reindex();
+  changed();
+  return *this;
+};
+
+void AltaCore::DET::ScopeItemList::reindex() {
+  byName.clear();
+  for (auto& item: list) {
+    byName[item->name].push_back(item);
+  }
+};
+
+std::atomic<size_t> AltaCore::DET::ScopeItemList::latestVersion { 0 };
+
+void AltaCore::DET::ScopeItemList::changed() {
+  _version = ++latestVersion;
+};
+
+void AltaCore::DET::ScopeItemList::touch() {
+  changed();
+};
+
+void AltaCore::DET::ScopeItemList::push_back(value_type item) {
+  byName[item->name].push_back(item);
+  list.push_back(std::move(item));
+  changed();
+};
+
+auto AltaCore::DET::ScopeItemList::insert(const_iterator position, value_type item) -> iterator {
+  return insert(position, &item, &item + 1);
+};
+
+auto AltaCore::DET::ScopeItemList::erase(const_iterator position) -> iterator {
+  auto name = (*position)->name;
+  auto offset = position - list.begin();
+  list.erase(list.begin() + offset);
+
+  // the same item might have been added more than once,
+  // so just rebuild this name's entry rather than guessing which one to remove
+  auto& entry = byName[name];
+  entry.clear();
+  for (auto& item: list) {
+    if (item->name == name) {
+      entry.push_back(item);
+    }
+  }
+  if (entry.empty()) {
+    byName.erase(name);
+  }
+
+  changed();
+  return list.begin() + offset;
+};
+
+void AltaCore::DET::ScopeItemList::clear() {
+  list.clear();
+  byName.clear();
+  changed();
+};
+
+auto AltaCore::DET::ScopeItemList::find(const std::string& name) const -> const std::vector<value_type>& {
+  static const std::vector<value_type> none;
+  auto it = byName.find(name);
+  if (it == byName.end()) {
+    return none;
+  }
+  return it->second;
+};
+
+size_t AltaCore::DET::Scope::generation = 0;
+
+void AltaCore::DET::Scope::invalidateLookups() {
+  // other workers might be in the middle of a cached lookup
+  Concurrency::ExclusiveSection exclusive;
+  generation++;
+};
+
+size_t AltaCore::DET::Scope::parentChainGeneration = 0;
+
+void AltaCore::DET::Scope::invalidateParentChains() {
+  Concurrency::ExclusiveSection exclusive;
+  parentChainGeneration++;
+};
+
+auto AltaCore::DET::Scope::lookupStamp() const -> LookupStamp {
+  Concurrency::CacheLock lock;
+  LookupStamp stamp;
+  stamp.generation = generation;
+  stamp.parentChainGeneration = parentChainGeneration;
+  // `findAllUncached` searches the same scopes the parent chain goes through
+  stamp.itemsVersion = items.version();
+  auto scope = parentChain().closestParent.lock();
+  while (scope) {
+    stamp.itemsVersion = std::max(stamp.itemsVersion, scope->items.version());
+    scope = scope->parentChain().closestParent.lock();
+  }
+  return stamp;
+};
+
+auto AltaCore::DET::Scope::parentChain() const -> const ParentChain& {
+  // like `Class::ancestors`, this is only rebuilt once nobody else can be using it
+  Concurrency::CacheLock lock;
+  if (chainGeneration == parentChainGeneration) return chain;
+
+  ParentChain result;
+
+  std::shared_ptr<Scope> closest = nullptr;
+  if (auto sParent = parent.lock()) {
+    closest = sParent;
+  } else if (auto sModule = parentModule.lock()) {
+    result.module = sModule;
+  } else if (auto sFunction = parentFunction.lock()) {
+    result.function = sFunction;
+    closest = sFunction->parentScope.lock();
+  } else if (auto sNamespace = parentNamespace.lock()) {
+    result.ns = sNamespace;
+    closest = sNamespace->parentScope.lock();
+  } else if (auto sClass = parentClass.lock()) {
+    result.klass = sClass;
+    closest = sClass->parentScope.lock();
+  }
+
+  if (closest) {
+    auto& above = closest->parentChain();
+    result.closestParent = closest;
+    result.depth = above.depth + 1;
+    if (result.module.expired()) result.module = above.module;
+    if (result.function.expired()) result.function = above.function;
+    if (result.klass.expired()) result.klass = above.klass;
+    if (result.ns.expired()) result.ns = above.ns;
+  }
+
+  chain = std::move(result);
+  chainGeneration = parentChainGeneration;
+  return chain;
+};
 
 const AltaCore::DET::NodeType AltaCore::DET::Scope::nodeType() {
   return NodeType::Scope;
 };
 
 std::shared_ptr<AltaCore::DET::Node> AltaCore::DET::Scope::clone() {
-  return std::make_shared<Scope>(*this);
+  auto self = std::make_shared<Scope>(*this);
+  self->lookupCache.clear();
+  self->chainGeneration = SIZE_MAX;
+  return self;
 };
 
 std::shared_ptr<AltaCore::DET::Node> AltaCore::DET::Scope::deepClone() {
@@ -23,6 +173,8 @@ std::shared_ptr<AltaCore::DET::Node> AltaCore::DET::Scope::deepClone() {
     newItem->parentScope = self;
     self->items.push_back(newItem);
   }
+  // the items' scopes moved along with them
+  invalidateParentChains();
   return self;
 };
 
@@ -69,12 +221,63 @@ AltaCore::DET::Scope::Scope(std::shared_ptr<AltaCore::DET::Class> _parentClass):
 };
 
 std::vector<std::shared_ptr<AltaCore::DET::ScopeItem>> AltaCore::DET::Scope::findAll(std::string name, std::vector<std::shared_ptr<Type>> excludeTypes, bool searchParents, std::shared_ptr<Scope> originScope) {
+  // visibility depends on where we're looking from, so we can only cache lookups
+  // that are either unrestricted or done from this scope (which is what most of them are)
+  bool fromSelf = originScope && originScope.get() == this;
+  if (originScope && !fromSelf) {
+    return findAllUncached(name, excludeTypes, searchParents, originScope);
+  }
+
+  LookupStamp stamp;
+  {
+    Concurrency::CacheLock lock;
+    stamp = lookupStamp();
+    if (lookupCacheStamp != stamp) {
+      lookupCache.clear();
+      lookupCacheStamp = stamp;
+    }
+
+    auto& entries = lookupCache[name];
+
+    for (auto& entry: entries) {
+      if (entry.searchParents != searchParents || entry.fromSelf != fromSelf || entry.excludeTypes.size() != excludeTypes.size()) {
+        continue;
+      }
+      // exactly compatible exclusions exclude exactly the same items
+      bool same = true;
+      for (size_t i = 0; i < excludeTypes.size(); i++) {
+        if (entry.excludeTypes[i] != excludeTypes[i] && !entry.excludeTypes[i]->isExactlyCompatibleWith(*excludeTypes[i])) {
+          same = false;
+          break;
+        }
+      }
+      if (same) {
+        return entry.results;
+      }
+    }
+  }
+
+  // this can do just about anything (e.g. instantiate a generic), so it can't hold on to the cache lock
+  auto results = findAllUncached(name, excludeTypes, searchParents, originScope);
+
+  Concurrency::CacheLock lock;
+  // `entries` might've been invalidated if the lookup added items somewhere
+  // (e.g. by instantiating a generic), in which case the results can't be cached anyway
+  if (lookupStamp() == stamp) {
+    lookupCache[name].push_back(CachedLookup { excludeTypes, searchParents, fromSelf, results });
+  }
+
+  return results;
+};
+
+std::vector<std::shared_ptr<AltaCore::DET::ScopeItem>> AltaCore::DET::Scope::findAllUncached(const std::string& name, const std::vector<std::shared_ptr<Type>>& excludeTypes, bool searchParents, std::shared_ptr<Scope> originScope) {
   std::vector<std::shared_ptr<ScopeItem>> results;
   std::vector<std::shared_ptr<Type>> funcTypes;
   std::shared_ptr<ScopeItem> first = nullptr;
   bool allFunctions = true;
 
-  for (auto& item: items) {
+  for (auto& item: items.find(name)) {
+    // items can technically be renamed after they're added to a scope
     if (item->name == name) {
       if (originScope && !originScope->canSee(item)) {
         continue;
@@ -220,7 +423,11 @@ void AltaCore::DET::Scope::hoist(std::shared_ptr<AltaCore::DET::ScopeItem> item)
   }
   if (auto mod = Util::getModule(this).lock()) {
     if (auto otherMod = Util::getModule(item->parentScope.lock().get()).lock()) {
-      otherMod->dependents.push_back(mod);
+      {
+        // the other module is usually done and used by modules on other workers, too
+        Concurrency::CacheLock lock;
+        otherMod->dependents.push_back(mod);
+      }
       if (item->genericParameterCount > 0) {
         mod->genericsUsed.push_back(item);
       }
@@ -231,26 +438,11 @@ void AltaCore::DET::Scope::hoist(std::shared_ptr<AltaCore::DET::ScopeItem> item)
 void AltaCore::DET::Scope::unhoist(std::shared_ptr<AltaCore::DET::ScopeItem> item) {
   if (item->nodeType() == NodeType::Namespace) return;
   if (auto mod = parentModule.lock()) {
-    for (size_t i = 0; i < mod->hoistedItems.size(); i++) {
-      if (mod->hoistedItems[i]->id == item->id) {
-        mod->hoistedItems.erase(mod->hoistedItems.begin() + i);
-        break;
-      }
-    }
+    mod->hoistedItems.erase(item);
   } else if (auto func = parentFunction.lock()) {
-    for (size_t i = 0; i < func->privateHoistedItems.size(); i++) {
-      if (func->privateHoistedItems[i]->id == item->id) {
-        func->privateHoistedItems.erase(func->privateHoistedItems.begin() + i);
-        break;
-      }
-    }
+    func->privateHoistedItems.erase(item);
   } else if (auto klass = parentClass.lock()) {
-    for (size_t i = 0; i < klass->privateHoistedItems.size(); i++) {
-      if (klass->privateHoistedItems[i]->id == item->id) {
-        klass->privateHoistedItems.erase(klass->privateHoistedItems.begin() + i);
-        break;
-      }
-    }
+    klass->privateHoistedItems.erase(item);
   } else if (auto ns = parentNamespace.lock()) {
     if (auto scope = ns->parentScope.lock()) {
       scope->unhoist(item);
@@ -260,12 +452,7 @@ void AltaCore::DET::Scope::unhoist(std::shared_ptr<AltaCore::DET::ScopeItem> ite
   }
   if (item->genericParameterCount > 0) {
     if (auto mod = Util::getModule(this).lock()) {
-      for (size_t i = 0; i < mod->genericsUsed.size(); i++) {
-        if (mod->genericsUsed[i]->id == item->id) {
-          mod->genericsUsed.erase(mod->genericsUsed.begin() + i);
-          break;
-        }
-      }
+      mod->genericsUsed.erase(item);
     }
   }
 };
@@ -293,29 +480,17 @@ std::shared_ptr<AltaCore::DET::Scope> AltaCore::DET::Scope::getMemberScope(std::
 };
 
 bool AltaCore::DET::Scope::hasParent(std::shared_ptr<Scope> lookup) const {
-  // `s` for `strong` (i.e. locked)
-  if (auto sParent = parent.lock()) {
-    if (sParent->id == lookup->id) return true;
-    return sParent->hasParent(lookup);
-  } else if (auto sModule = parentModule.lock()) {
-    return false;
-  } else if (auto sFunction = parentFunction.lock()) {
-    if (auto sParent = sFunction->parentScope.lock()) {
-      if (sParent->id == lookup->id) return true;
-      return sParent->hasParent(lookup);
-    }
-  } else if (auto sNamespace = parentNamespace.lock()) {
-    if (auto sParent = sNamespace->parentScope.lock()) {
-      if (sParent->id == lookup->id) return true;
-      return sParent->hasParent(lookup);
-    }
-  } else if (auto sClass = parentClass.lock()) {
-    if (auto sParent = sClass->parentScope.lock()) {
-      if (sParent->id == lookup->id) return true;
-      return sParent->hasParent(lookup);
-    }
+  // scopes can only enclose scopes that are less deeply nested than them,
+  // so we only need to go up to the one at the same depth as `lookup` and check that
+  auto& lookupChain = lookup->parentChain();
+  auto& ourChain = parentChain();
+  if (lookupChain.depth >= ourChain.depth) return false;
+
+  auto scope = ourChain.closestParent.lock();
+  while (scope && scope->parentChain().depth > lookupChain.depth) {
+    scope = scope->parentChain().closestParent.lock();
   }
-  return false;
+  return scope && scope->id == lookup->id;
 };
 
 bool AltaCore::DET::Scope::canSee(std::shared_ptr<ScopeItem> item) const {
@@ -444,20 +619,5 @@ std::shared_ptr<AltaCore::DET::Class> AltaCore::DET::Scope::findParentCaptureCla
 };
 
 auto AltaCore::DET::Scope::findClosestParentScope() -> std::shared_ptr<Scope> {
-  if (auto sParent = parent.lock()) {
-    return sParent;
-  } else if (auto sFunction = parentFunction.lock()) {
-    if (auto sParent = sFunction->parentScope.lock()) {
-      return sParent;
-    }
-  } else if (auto sNamespace = parentNamespace.lock()) {
-    if (auto sParent = sNamespace->parentScope.lock()) {
-      return sParent;
-    }
-  } else if (auto sClass = parentClass.lock()) {
-    if (auto sParent = sClass->parentScope.lock()) {
-      return sParent;
-    }
-  }
-  return nullptr;
+  return parentChain().closestParent.lock();
 };
@@ -1,7 +1,223 @@
 #include "../../include/altacore/det/type.hpp"
 #include "../../include/altacore/ast.hpp"
 #include "../../include/altacore/util.hpp"
+#include "../../include/altacore/concurrency.hpp"
 #include <queue>
+#include <array>
+#include <functional>
+#include <stack>
+#include <unordered_set>
+#include <algorithm>
+
+namespace {
+  using namespace AltaCore;
+
+  enum class Derivation {
+    Reference,
+    ForcedReference,
+    Dereference,
+    Point,
+    Follow,
+    FollowBlindly,
+    Deconstify,
+    FullDeconstify,
+    DestroyReferences,
+    Optional,
+    COUNT,
+  };
+
+  // `std::hash<DET::Type>` skips some fields that are relevant for interning,
+  // so we just mix those in on top of it
+  size_t structuralHash(const DET::Type& type) {
+    size_t result = std::hash<DET::Type>()(type);
+    result = result * 31 + std::hash<bool>()(type.throws);
+    result = result * 31 + std::hash<bool>()(type.isRawFunction);
+    result = result * 31 + std::hash<bool>()(type.isOptional);
+    result = result * 31 + std::hash<std::string>()(type.name);
+    result = result * 31 + std::hash<const void*>()(type.methodParent.get());
+    result = result * 31 + std::hash<const void*>()(type.bitfield.get());
+    if (type.optionalTarget) {
+      result = result * 31 + structuralHash(*type.optionalTarget);
+    }
+    return result;
+  };
+
+  bool structurallyIdentical(const std::shared_ptr<DET::Type>& lhs, const std::shared_ptr<DET::Type>& rhs);
+
+  bool structurallyIdentical(const DET::Type& lhs, const DET::Type& rhs) {
+    if (&lhs == &rhs) return true;
+    if (
+      lhs.isAny != rhs.isAny ||
+      lhs.isNative != rhs.isNative ||
+      lhs.isFunction != rhs.isFunction ||
+      lhs.isMethod != rhs.isMethod ||
+      lhs.isAccessor != rhs.isAccessor ||
+      lhs.throws != rhs.throws ||
+      lhs.isRawFunction != rhs.isRawFunction ||
+      lhs.isOptional != rhs.isOptional ||
+      lhs.nativeTypeName != rhs.nativeTypeName ||
+      lhs.userDefinedName != rhs.userDefinedName ||
+      lhs.name != rhs.name ||
+      lhs.methodParent != rhs.methodParent ||
+      lhs.klass != rhs.klass ||
+      lhs.bitfield != rhs.bitfield ||
+      lhs.modifiers != rhs.modifiers ||
+      lhs.parameters.size() != rhs.parameters.size() ||
+      lhs.unionOf.size() != rhs.unionOf.size()
+    ) {
+      return false;
+    }
+    if (!structurallyIdentical(lhs.returnType, rhs.returnType)) return false;
+    if (!structurallyIdentical(lhs.optionalTarget, rhs.optionalTarget)) return false;
+    for (size_t i = 0; i < lhs.parameters.size(); i++) {
+      auto& [lhsName, lhsType, lhsIsVariable, lhsID] = lhs.parameters[i];
+      auto& [rhsName, rhsType, rhsIsVariable, rhsID] = rhs.parameters[i];
+      if (lhsName != rhsName || lhsIsVariable != rhsIsVariable || lhsID != rhsID) return false;
+      if (!structurallyIdentical(lhsType, rhsType)) return false;
+    }
+    for (size_t i = 0; i < lhs.unionOf.size(); i++) {
+      if (!structurallyIdentical(lhs.unionOf[i], rhs.unionOf[i])) return false;
+    }
+    return true;
+  };
+
+  bool structurallyIdentical(const std::shared_ptr<DET::Type>& lhs, const std::shared_ptr<DET::Type>& rhs) {
+    if (!lhs || !rhs) return lhs == rhs;
+    return structurallyIdentical(*lhs, *rhs);
+  };
+
+  struct InternTable {
+    std::unordered_map<size_t, std::vector<std::shared_ptr<DET::Type>>> types;
+    // canonical type -> canonical types derived from it
+    std::unordered_map<const DET::Type*, std::array<std::shared_ptr<DET::Type>, static_cast<size_t>(Derivation::COUNT)>> derived;
+  };
+
+  InternTable& internTable() {
+    static InternTable table;
+    return table;
+  };
+
+  struct CastCacheKey {
+    const DET::Type* from;
+    const DET::Type* to;
+    bool manual;
+
+    bool operator ==(const CastCacheKey& other) const {
+      return from == other.from && to == other.to && manual == other.manual;
+    };
+  };
+
+  struct CastCacheKeyHash {
+    size_t operator ()(const CastCacheKey& key) const {
+      size_t result = std::hash<const void*>()(key.from);
+      result = result * 31 + std::hash<const void*>()(key.to);
+      result = result * 31 + std::hash<bool>()(key.manual);
+      return result;
+    };
+  };
+
+  struct CastCache {
+    // the keys point to interned types, which live as long as the intern table
+    std::unordered_map<CastCacheKey, DET::CastPath, CastCacheKeyHash> entries;
+    size_t generation = 0;
+    DET::CastCacheStatistics statistics;
+  };
+
+  CastCache& castCache() {
+    static CastCache cache;
+    return cache;
+  };
+
+  using TypePair = std::pair<const DET::Type*, const DET::Type*>;
+
+  struct TypePairHash {
+    size_t operator ()(const TypePair& pair) const {
+      return std::hash<const void*>()(pair.first) * 31 + std::hash<const void*>()(pair.second);
+    };
+  };
+
+  struct CompatibilityEntry {
+    ALTACORE_OPTIONAL<size_t> score;
+    ALTACORE_OPTIONAL<bool> compatible;
+    ALTACORE_OPTIONAL<bool> exactlyCompatible;
+  };
+
+  struct CompatibilityCache {
+    // the keys point to interned types, which live as long as the intern table
+    std::unordered_map<TypePair, CompatibilityEntry, TypePairHash> entries;
+    size_t generation = 0;
+    DET::CompatibilityCacheStatistics statistics;
+  };
+
+  CompatibilityCache& compatibilityCache() {
+    static CompatibilityCache cache;
+    return cache;
+  };
+
+  /**
+   * Find the interned type that's structurally identical to the given one
+   * without interning anything (so it doesn't allocate)
+   */
+  const DET::Type* findInterned(const DET::Type& type) {
+    if (type.isInterned) return &type;
+    Concurrency::CacheLock lock;
+    auto& types = internTable().types;
+    auto it = types.find(structuralHash(type));
+    if (it == types.end()) return nullptr;
+    for (auto& candidate: it->second) {
+      if (structurallyIdentical(*candidate, type)) {
+        return candidate.get();
+      }
+    }
+    return nullptr;
+  };
+
+  template<typename T>
+  T cachedCompatibility(const DET::Type& lhs, const DET::Type& rhs, ALTACORE_OPTIONAL<T> CompatibilityEntry::* field, std::function<T()> compute) {
+    auto& cache = compatibilityCache();
+
+    auto canonicalLHS = findInterned(lhs);
+    auto canonicalRHS = canonicalLHS ? findInterned(rhs) : nullptr;
+    size_t generation;
+    {
+      Concurrency::CacheLock lock;
+      if (canonicalLHS && canonicalRHS) {
+        auto it = cache.entries.find(std::make_pair(canonicalLHS, canonicalRHS));
+        if (it != cache.entries.end() && it->second.*field) {
+          ++cache.statistics.hits;
+          return *(it->second.*field);
+        }
+      }
+      ++cache.statistics.misses;
+      generation = cache.generation;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = compute();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    Concurrency::CacheLock lock;
+    cache.statistics.missTime += elapsed;
+
+    // don't store anything if the classes involved changed while we were computing it
+    if (generation == cache.generation) {
+      if (!canonicalLHS) canonicalLHS = DET::Type::intern(lhs.copy()).get();
+      if (!canonicalRHS) canonicalRHS = DET::Type::intern(rhs.copy()).get();
+      cache.entries[std::make_pair(canonicalLHS, canonicalRHS)].*field = result;
+    }
+
+    return result;
+  };
+
+  std::shared_ptr<DET::Type> derive(const DET::Type* type, Derivation derivation, std::function<std::shared_ptr<DET::Type>()> compute) {
+    Concurrency::CacheLock lock;
+    auto& slot = internTable().derived[type][static_cast<size_t>(derivation)];
+    if (!slot) {
+      slot = DET::Type::intern(compute());
+    }
+    return slot;
+  };
+};
 
 bool AltaCore::DET::CastComponent::operator ==(const CastComponent& other) const {
   if (type != other.type) return false;
@@ -22,7 +238,7 @@ const AltaCore::DET::NodeType AltaCore::DET::Type::nodeType() {
 };
 
 std::shared_ptr<AltaCore::DET::Node> AltaCore::DET::Type::clone() {
-  return std::make_shared<Type>(*this);
+  return copy();
 };
 
 std::shared_ptr<AltaCore::DET::Node> AltaCore::DET::Type::deepClone() {
@@ -30,14 +246,155 @@ std::shared_ptr<AltaCore::DET::Node> AltaCore::DET::Type::deepClone() {
 };
 
 std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::copy() const {
-  return std::make_shared<Type>(*this);
+  auto result = std::make_shared<Type>(*this);
+  result->isInterned = false;
+  return result;
+};
+
+std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::intern(std::shared_ptr<Type> type) {
+  if (!type || type->isInterned) return type;
+
+  Concurrency::CacheLock lock;
+
+  // make sure none of the types this one refers to can change out from under us
+  auto canonicalize = [](std::shared_ptr<Type>& subtype) {
+    if (subtype && !subtype->isInterned) {
+      subtype = intern(subtype->copy());
+    }
+  };
+  canonicalize(type->returnType);
+  canonicalize(type->optionalTarget);
+  for (auto& param: type->parameters) {
+    canonicalize(std::get<1>(param));
+  }
+  for (auto& member: type->unionOf) {
+    canonicalize(member);
+  }
+
+  auto& candidates = internTable().types[structuralHash(*type)];
+  for (auto& candidate: candidates) {
+    if (structurallyIdentical(*candidate, *type)) {
+      return candidate;
+    }
+  }
+
+  type->isInterned = true;
+  candidates.push_back(type);
+  return type;
+};
+
+size_t AltaCore::DET::Type::pruneInterned() {
+  // cached cast paths hold on to interned types (and the rest of the caches are keyed by them)
+  invalidateCasts();
+
+  Concurrency::ExclusiveSection exclusive;
+
+  auto& table = internTable();
+
+  auto forEachSubtype = [](const Type& type, const std::function<void(const std::shared_ptr<Type>&)>& callback) {
+    if (type.returnType) callback(type.returnType);
+    if (type.optionalTarget) callback(type.optionalTarget);
+    for (auto& param: type.parameters) {
+      if (std::get<1>(param)) callback(std::get<1>(param));
+    }
+    for (auto& member: type.unionOf) {
+      if (member) callback(member);
+    }
+  };
+
+  // count the references the table itself is responsible for: its own, the ones from other
+  // interned types (subtypes are always interned), and the ones from derivations
+  std::unordered_map<const Type*, long> internalReferences;
+  for (auto& [hash, bucket]: table.types) {
+    for (auto& type: bucket) {
+      ++internalReferences[type.get()];
+      forEachSubtype(*type, [&](const std::shared_ptr<Type>& subtype) {
+        ++internalReferences[subtype.get()];
+      });
+    }
+  }
+  for (auto& [type, slots]: table.derived) {
+    for (auto& slot: slots) {
+      if (slot) ++internalReferences[slot.get()];
+    }
+  }
+
+  // anything referenced from outside is still in use, along with everything it refers to
+  // (derivations don't count; they're recomputed if they're needed again)
+  std::unordered_set<const Type*> used;
+  std::vector<const Type*> pending;
+  for (auto& [hash, bucket]: table.types) {
+    for (auto& type: bucket) {
+      if (type.use_count() > internalReferences[type.get()]) {
+        used.insert(type.get());
+        pending.push_back(type.get());
+      }
+    }
+  }
+  while (pending.size() > 0) {
+    auto type = pending.back();
+    pending.pop_back();
+    forEachSubtype(*type, [&](const std::shared_ptr<Type>& subtype) {
+      if (used.insert(subtype.get()).second) {
+        pending.push_back(subtype.get());
+      }
+    });
+  }
+
+  for (auto it = table.derived.begin(); it != table.derived.end();) {
+    if (used.find(it->first) == used.end()) {
+      it = table.derived.erase(it);
+      continue;
+    }
+    for (auto& slot: it->second) {
+      if (slot && used.find(slot.get()) == used.end()) {
+        slot = nullptr;
+      }
+    }
+    ++it;
+  }
+
+  size_t released = 0;
+  for (auto it = table.types.begin(); it != table.types.end();) {
+    auto& bucket = it->second;
+    auto kept = std::remove_if(bucket.begin(), bucket.end(), [&](const std::shared_ptr<Type>& type) {
+      return used.find(type.get()) == used.end();
+    });
+    released += bucket.end() - kept;
+    bucket.erase(kept, bucket.end());
+    if (bucket.empty()) {
+      it = table.types.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  return released;
+};
+
+std::vector<std::shared_ptr<AltaCore::DET::Type>> AltaCore::DET::Type::internAll(const std::vector<std::shared_ptr<Type>>& types) {
+  std::vector<std::shared_ptr<Type>> result;
+  result.reserve(types.size());
+  for (auto& type: types) {
+    result.push_back((!type || type->isInterned) ? type : intern(type->copy()));
+  }
+  return result;
+};
+
+auto AltaCore::DET::Type::findInterned(const Type& type) -> const Type* {
+  return ::findInterned(type);
+};
+
+
+std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::native(NativeType nativeTypeName, std::vector<uint8_t> modifiers) {
+  return intern(std::make_shared<Type>(nativeTypeName, modifiers));
 };
 
 std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::getUnderlyingType(AltaCore::DH::ExpressionNode* expression) {
   using Modifier = AST::TypeModifierFlag;
 
   if (auto intLit = dynamic_cast<DH::IntegerLiteralNode*>(expression)) {
-    return std::make_shared<Type>(NativeType::Integer, std::vector<uint8_t> { (uint8_t)Modifier::Constant });
+    return native(NativeType::Integer, { (uint8_t)Modifier::Constant });
   } else if (auto varDef = dynamic_cast<DH::VariableDefinitionExpression*>(expression)) {
     return std::dynamic_pointer_cast<Type>(varDef->variable->type->clone())->reference();
   } else if (auto assign = dynamic_cast<DH::AssignmentExpression*>(expression)) {
@@ -54,7 +411,7 @@ std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::getUnderlyingType(Alta
     }
     return getUnderlyingType(fetch->narrowedTo);
   } else if (auto boolean = dynamic_cast<DH::BooleanLiteralNode*>(expression)) {
-    return std::make_shared<Type>(NativeType::Bool, std::vector<uint8_t> { (uint8_t)Modifier::Constant });
+    return native(NativeType::Bool, { (uint8_t)Modifier::Constant });
   } else if (auto binOp = dynamic_cast<DH::BinaryOperation*>(expression)) {
     if (binOp->operatorMethod) {
       return binOp->operatorMethod->returnType;
@@ -62,7 +419,7 @@ std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::getUnderlyingType(Alta
     if ((uint8_t)binOp->type <= (uint8_t)Shared::OperatorType::BitwiseXor) {
       return binOp->commonOperandType->destroyReferences();
     } else {
-      return std::make_shared<Type>(NativeType::Bool, std::vector<uint8_t> { (uint8_t)Modifier::Constant });
+      return native(NativeType::Bool, { (uint8_t)Modifier::Constant });
     }
   } else if (auto call = dynamic_cast<DH::FunctionCallExpression*>(expression)) {
     auto type = call->targetType->returnType;
@@ -85,7 +442,7 @@ std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::getUnderlyingType(Alta
     }
     return getUnderlyingType(acc->narrowedTo);
   } else if (auto str = dynamic_cast<DH::StringLiteralNode*>(expression)) {
-    return std::make_shared<Type>(NativeType::Byte, std::vector<uint8_t> { (uint8_t)Modifier::Constant | (uint8_t)Modifier::Pointer, (uint8_t)Modifier::Constant });
+    return native(NativeType::Byte, { (uint8_t)Modifier::Constant | (uint8_t)Modifier::Pointer, (uint8_t)Modifier::Constant });
   } else if (auto cond = dynamic_cast<DH::ConditionalExpression*>(expression)) {
     return cond->commonType->copy();
   } else if (auto inst = dynamic_cast<DH::ClassInstantiationExpression*>(expression)) {
@@ -116,7 +473,7 @@ std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::getUnderlyingType(Alta
   } else if (auto cast = dynamic_cast<DH::CastExpression*>(expression)) {
     return cast->type->type;
   } else if (auto chara = dynamic_cast<DH::CharacterLiteralNode*>(expression)) {
-    return std::make_shared<Type>(NativeType::Byte, std::vector<uint8_t> { (uint8_t)Modifier::Constant });
+    return native(NativeType::Byte, { (uint8_t)Modifier::Constant });
   } else if (auto subs = dynamic_cast<DH::SubscriptExpression*>(expression)) {
     if (subs->enumeration) {
       if (subs->reverseLookup) {
@@ -132,24 +489,24 @@ std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::getUnderlyingType(Alta
   } else if (auto sc = dynamic_cast<DH::SuperClassFetch*>(expression)) {
     return std::make_shared<Type>(sc->superclass, std::vector<uint8_t> { (uint8_t)Modifier::Reference });
   } else if (auto instOf = dynamic_cast<DH::InstanceofExpression*>(expression)) {
-    return std::make_shared<Type>(NativeType::Bool, std::vector<uint8_t> { (uint8_t)Modifier::Constant });
+    return native(NativeType::Bool, { (uint8_t)Modifier::Constant });
   } else if (auto unary = dynamic_cast<DH::UnaryOperation*>(expression)) {
     if (unary->operatorMethod) {
       return unary->operatorMethod->returnType;
     }
     if (unary->type == Shared::UOperatorType::Not) {
-      return std::make_shared<Type>(NativeType::Bool, std::vector<uint8_t> { (uint8_t)Modifier::Constant });
+      return native(NativeType::Bool, { (uint8_t)Modifier::Constant });
     } else {
       return getUnderlyingType(unary->target.get())->destroyReferences();
     }
   } else if (auto op = dynamic_cast<DH::SizeofOperation*>(expression)) {
-    return std::make_shared<Type>(NativeType::Integer, std::vector<uint8_t> { (uint8_t)Modifier::Constant, (uint8_t)Modifier::Long, (uint8_t)Modifier::Long });
+    return native(NativeType::Integer, { (uint8_t)Modifier::Constant, (uint8_t)Modifier::Long, (uint8_t)Modifier::Long });
   } else if (auto deci = dynamic_cast<DH::FloatingPointLiteralNode*>(expression)) {
-    return std::make_shared<Type>(NativeType::Double, std::vector<uint8_t> { (uint8_t)Modifier::Constant });
+    return native(NativeType::Double, { (uint8_t)Modifier::Constant });
   } else if (auto null = dynamic_cast<DH::NullptrExpression*>(expression)) {
     auto type = std::make_shared<Type>();
     type->modifiers.push_back((uint8_t)Shared::TypeModifierFlag::Pointer);
-    return type;
+    return intern(type);
   } else if (auto lambda = dynamic_cast<DH::LambdaExpression*>(expression)) {
     return getUnderlyingType(lambda->function);
   } else if (auto special = dynamic_cast<DH::SpecialFetchExpression*>(expression)) {
@@ -168,7 +525,7 @@ std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::getUnderlyingType(Alta
     auto tgt = getUnderlyingType(await->target.get());
     return std::dynamic_pointer_cast<DET::Function>(tgt->klass->scope->findAll("value")[0])->returnType->optionalTarget;
   } else if (auto voidNode = dynamic_cast<DH::VoidExpression*>(expression)) {
-    return std::make_shared<Type>(NativeType::Void);
+    return native(NativeType::Void);
   }
 
   return nullptr;
@@ -240,6 +597,9 @@ std::vector<std::shared_ptr<AltaCore::DET::Type>> AltaCore::DET::Type::getUnderl
 };
 
 std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::reference(bool force) const {
+  if (isInterned) {
+    return derive(this, force ? Derivation::ForcedReference : Derivation::Reference, [&]() { return copy()->reference(force); });
+  }
   auto other = copy();
   if (force || other->referenceLevel() < 1) {
     other->modifiers.insert(other->modifiers.begin(), (uint8_t)Shared::TypeModifierFlag::Reference);
@@ -247,6 +607,9 @@ std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::reference(bool force)
   return other;
 };
 std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::dereference() const {
+  if (isInterned) {
+    return derive(this, Derivation::Dereference, [&]() { return copy()->dereference(); });
+  }
   auto other = copy();
   if (other->modifiers.size() > 0) {
     auto& root = other->modifiers.front();
@@ -260,11 +623,17 @@ std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::dereference() const {
   return other;
 };
 std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::point() const {
+  if (isInterned) {
+    return derive(this, Derivation::Point, [&]() { return copy()->point(); });
+  }
   auto other = copy();
   other->modifiers.insert(other->modifiers.begin(), (uint8_t)Shared::TypeModifierFlag::Pointer);
   return other;
 };
 std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::follow() const {
+  if (isInterned) {
+    return derive(this, Derivation::Follow, [&]() { return copy()->follow(); });
+  }
   auto other = copy();
   if (other->modifiers.size() > 0) {
     auto& root = other->modifiers.front();
@@ -276,6 +645,9 @@ std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::follow() const {
   return other;
 };
 std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::followBlindly() const {
+  if (isInterned) {
+    return derive(this, Derivation::FollowBlindly, [&]() { return copy()->followBlindly(); });
+  }
   auto other = copy();
   if (other->modifiers.size() > 0) {
     auto& root = other->modifiers.front();
@@ -287,6 +659,9 @@ std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::followBlindly() const
   return other;
 };
 std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::deconstify(bool full) const {
+  if (isInterned) {
+    return derive(this, full ? Derivation::FullDeconstify : Derivation::Deconstify, [&]() { return copy()->deconstify(full); });
+  }
   auto other = copy();
   if (full) {
     for (size_t i = 0; i < other->modifiers.size(); ++i) {
@@ -311,6 +686,9 @@ std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::deconstify(bool full)
   return other;
 };
 std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::destroyReferences() const {
+  if (isInterned) {
+    return derive(this, Derivation::DestroyReferences, [&]() { return copy()->destroyReferences(); });
+  }
   auto other = copy();
   while (other->referenceLevel() > 0) {
     other = other->dereference();
@@ -318,47 +696,20 @@ std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::destroyReferences() co
   return other;
 };
 std::shared_ptr<AltaCore::DET::Type> AltaCore::DET::Type::makeOptional() const {
+  if (isInterned) {
+    return derive(this, Derivation::Optional, [&]() { return copy()->makeOptional(); });
+  }
   return std::make_shared<DET::Type>(true, copy());
 }
 const size_t AltaCore::DET::Type::indirectionLevel() const {
-  size_t count = 0;
-
-  for (auto& modLevel: modifiers) {
-    if (modLevel & (uint8_t)Shared::TypeModifierFlag::Pointer || modLevel & (uint8_t)Shared::TypeModifierFlag::Reference) {
-      count++;
-    }
-  }
-
-  return count;
+  return modifiers.count((uint8_t)Shared::TypeModifierFlag::Pointer | (uint8_t)Shared::TypeModifierFlag::Reference);
 };
 const size_t AltaCore::DET::Type::pointerLevel() const {
   if (referenceLevel() > 0) return destroyReferences()->pointerLevel();
-  size_t count = 0;
-
-  for (auto& modLevel: modifiers) {
-    if (modLevel & (uint8_t)Shared::TypeModifierFlag::Pointer) {
-      count++;
-    }
-    if (modLevel & (uint8_t)Shared::TypeModifierFlag::Reference) {
-      break;
-    }
-  }
-
-  return count;
+  return modifiers.countUntil((uint8_t)Shared::TypeModifierFlag::Pointer, (uint8_t)Shared::TypeModifierFlag::Reference);
 };
 const size_t AltaCore::DET::Type::referenceLevel() const {
-  size_t count = 0;
-
-  for (auto& modLevel: modifiers) {
-    if (modLevel & (uint8_t)Shared::TypeModifierFlag::Reference) {
-      count++;
-    }
-    if (modLevel & (uint8_t)Shared::TypeModifierFlag::Pointer) {
-      break;
-    }
-  }
-
-  return count;
+  return modifiers.countUntil((uint8_t)Shared::TypeModifierFlag::Reference, (uint8_t)Shared::TypeModifierFlag::Pointer);
 };
 
 auto AltaCore::DET::Type::findAllPossibleCasts(std::shared_ptr<Type> from, std::shared_ptr<Type> to, bool manual) -> std::vector<CastPath> {
@@ -373,17 +724,7 @@ auto AltaCore::DET::Type::findAllPossibleCasts(std::shared_ptr<Type> from, std::
   }
 
   if (to->indirectionLevel() > 0) {
-    auto nonConstPtrTo = to->deconstify();
-    for (size_t i = 0; i < nonConstPtrTo->modifiers.size(); ++i) {
-      auto& mod = nonConstPtrTo->modifiers[i];
-      if (mod & (uint8_t)AltaCore::DET::TypeModifierFlag::Constant) {
-        mod &= ~((uint8_t)AltaCore::DET::TypeModifierFlag::Constant);
-      }
-      if (mod == 0) {
-        nonConstPtrTo->modifiers.erase(nonConstPtrTo->modifiers.begin() + i);
-        --i;
-      }
-    }
+    auto nonConstPtrTo = to->deconstify(true);
     if (*from == *nonConstPtrTo) {
       results.push_back({ CastComponent(CastComponentType::SimpleCoercion, to), CastComponent(CastComponentType::Destination) });
     }
@@ -565,980 +906,1238 @@ auto AltaCore::DET::Type::findAllPossibleCasts(std::shared_ptr<Type> from, std::
   return results;
 };
 
+double AltaCore::DET::CastCacheStatistics::hitRate() const {
+  auto total = hits + misses;
+  return total == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(total);
+};
+
 auto AltaCore::DET::Type::findCast(std::shared_ptr<Type> from, std::shared_ptr<Type> to, bool manual) -> CastPath {
-  using CC = CastComponent;
-  using CCT = CastComponentType;
-  using SCT = SpecialCastType;
-  using NT = NativeType;
+  // the cache is keyed by canonical instances, so we intern copies of the types
+  // (the originals might still be modified by whoever owns them)
+  auto canonicalFrom = from->isInterned ? from : intern(from->copy());
+  auto canonicalTo = to->isInterned ? to : intern(to->copy());
+
+  auto& cache = castCache();
+  CastCacheKey key { canonicalFrom.get(), canonicalTo.get(), manual };
+  size_t generation;
+  {
+    Concurrency::CacheLock lock;
+    auto it = cache.entries.find(key);
+    if (it != cache.entries.end()) {
+      ++cache.statistics.hits;
+      return it->second;
+    }
+    ++cache.statistics.misses;
+    generation = cache.generation;
+  }
 
-  std::function<CastPath(std::vector<std::shared_ptr<Type>>, std::shared_ptr<Type>, size_t*)> reverseLoop = nullptr;
-  std::function<CastPath(std::shared_ptr<Type>, std::vector<std::shared_ptr<Type>>, size_t*)> loop = nullptr;
+  auto result = findCastUncached(canonicalFrom, canonicalTo, manual);
 
-  bool dontReverseLoopBack = false;
+  Concurrency::CacheLock lock;
+  // only store the result if nothing was invalidated while we were searching
+  if (generation == cache.generation) {
+    cache.entries[key] = result;
+  }
 
-  reverseLoop = [&loop, &reverseLoop, &manual, &dontReverseLoopBack](std::vector<std::shared_ptr<Type>> froms, std::shared_ptr<Type> to, size_t* index) -> CastPath {
-    #define AC_FROM_LOOP for (size_t i = 0; i < froms.size(); ++i) { auto& from = froms[i];
-    #define AC_FROM_LOOP_END }
-    #define AC_RETURN_INDEX if (index) { *index = i; }
+  return result;
+};
 
-    if (to->isAny && to->pointerLevel() == 0) {
-      return { CC(CCT::Destination) };
-    }
+size_t AltaCore::DET::Type::castGeneration() {
+  return castCache().generation;
+};
 
-    AC_FROM_LOOP;
-      if (*from == *to) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::Destination) };
-      }
-    AC_FROM_LOOP_END;
+void AltaCore::DET::Type::invalidateCasts() {
+  // other workers might be in the middle of using cached casts
+  Concurrency::ExclusiveSection exclusive;
+  auto& cache = castCache();
+  ++cache.generation;
+  if (!cache.entries.empty()) {
+    ++cache.statistics.invalidations;
+    cache.entries.clear();
+  }
 
-    decltype(froms) deconstFroms;
-    bool deconstSame = true;
-    AC_FROM_LOOP;
-      auto deconst = from->deconstify();
-      deconstFroms.push_back(deconst);
-      if (!deconst->isAny && !(*deconst == *from)) {
-        deconstSame = false;
-      }
-    AC_FROM_LOOP_END;
+  // compatibility depends on the same things (class parents and cast methods)
+  auto& compatCache = compatibilityCache();
+  ++compatCache.generation;
+  if (!compatCache.entries.empty()) {
+    ++compatCache.statistics.invalidations;
+    compatCache.entries.clear();
+  }
+};
 
-    if (!deconstSame) {
-      auto cast = reverseLoop(deconstFroms, to, index);
-      if (cast.size() > 0) {
-        return cast;
-      }
-    };
+double AltaCore::DET::CompatibilityCacheStatistics::hitRate() const {
+  auto total = hits + misses;
+  return total == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(total);
+};
 
-    auto deconstTo = to->deconstify();
-    auto noconstTo = to->deconstify(true);
-    if (!to->isAny && !(*to == *deconstTo)) {
-      auto cast = reverseLoop(froms, deconstTo, index);
-      if (cast.size() > 0) {
-        return cast;
-      }
-    }
-    if (!to->isAny && !(*to == *noconstTo)) {
-      auto cast = reverseLoop(froms, noconstTo, index);
-      if (cast.size() > 0) {
-        return cast;
-      }
-    }
+std::chrono::nanoseconds AltaCore::DET::CompatibilityCacheStatistics::estimatedTimeSaved() const {
+  if (misses == 0) return std::chrono::nanoseconds(0);
+  return (missTime / misses) * hits;
+};
 
-    AC_FROM_LOOP;
-      if (from->indirectionLevel() > 0 && to->indirectionLevel() > 0 && from->klass && to->klass && to->klass->hasParent(from->klass)) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::Downcast, to->klass), CC(CCT::Destination) };
-      }
-    AC_FROM_LOOP_END;
+auto AltaCore::DET::Type::compatibilityCacheStatistics() -> CompatibilityCacheStatistics {
+  auto& cache = compatibilityCache();
+  auto result = cache.statistics;
+  result.entries = cache.entries.size();
+  return result;
+};
 
-    AC_FROM_LOOP;
-      if (
-        (
-          (from->referenceLevel() <= 1 && to->referenceLevel() <= 1) ||
-          (from->pointerLevel() <= 1 && to->pointerLevel() == from->pointerLevel())
-        ) &&
-        from->klass &&
-        to->klass &&
-        from->klass->hasParent(to->klass)
-      ) {
-        auto accessorClass = from->klass;
-        CastPath cast;
-        size_t i = 0;
-        while (i < accessorClass->parents.size()) {
-          auto& parent = accessorClass->parents[i];
-          if (parent->id == to->klass->id) {
-            cast.push_back(CC(CCT::Upcast, parent));
-            if (from->referenceLevel() > to->referenceLevel()) {
-              cast.push_back(CC(CCT::Dereference));
-            }
-            break;
-          }
-          if (parent->hasParent(to->klass)) {
-            cast.push_back(CC(CCT::Upcast, parent));
-            i = 0;
-            accessorClass = parent;
-            continue;
-          }
-          ++i;
-        }
-        AC_RETURN_INDEX;
-        cast.push_back(CC(CCT::Destination));
-        return cast;
-      }
-    AC_FROM_LOOP_END;
+void AltaCore::DET::Type::resetCompatibilityCacheStatistics() {
+  compatibilityCache().statistics = CompatibilityCacheStatistics();
+};
 
-    AC_FROM_LOOP;
-      if (from->indirectionLevel() == 0 && to->indirectionLevel() == 0 && from->isOptional && to->nativeTypeName == NativeType::Bool) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::Destination, SCT::OptionalPresent) };
-      }
+size_t AltaCore::DET::Type::compatiblity(const AltaCore::DET::Type& other) const {
+  return cachedCompatibility<size_t>(*this, other, &CompatibilityEntry::score, [&]() {
+    return compatiblityUncached(other);
+  });
+};
 
-      if (to->indirectionLevel() == 0 && to->isOptional && from->pointerLevel() == 1 && from->isAny) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::Destination, SCT::EmptyOptional) };
-      }
+bool AltaCore::DET::Type::isExactlyCompatibleWith(const AltaCore::DET::Type& other) const {
+  // `any` is the one type that isn't exactly compatible with itself
+  if (this == &other && !isAny) return true;
+  // this one's cheap enough to compute that looking up non-canonical types would cost more than it saves
+  if (!isInterned || !other.isInterned) return isExactlyCompatibleWithUncached(other);
+  return cachedCompatibility<bool>(*this, other, &CompatibilityEntry::exactlyCompatible, [&]() {
+    return isExactlyCompatibleWithUncached(other);
+  });
+};
 
-      if (from->indirectionLevel() == 0 && to->indirectionLevel() == 0 && from->isFunction && to->isFunction && from->isRawFunction && !to->isRawFunction) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::Destination, SCT::WrapFunction) };
-      }
+bool AltaCore::DET::Type::isCompatibleWith(const AltaCore::DET::Type& other) const {
+  return cachedCompatibility<bool>(*this, other, &CompatibilityEntry::compatible, [&]() {
+    return isCompatibleWithUncached(other);
+  });
+};
 
-      // make sure to prefer simple dereferences over `from` or `to` casts
-      if (from->referenceLevel() > to->referenceLevel() && from->destroyReferences()->isExactlyCompatibleWith(*to->destroyReferences())) {
-        CastPath path;
-        for (size_t i = from->referenceLevel(); i > to->referenceLevel(); --i) {
-          path.push_back(CC(CCT::Dereference));
-        }
-        path.push_back(CC(CCT::Destination));
-        AC_RETURN_INDEX;
-        return path;
-      }
-    AC_FROM_LOOP_END;
+auto AltaCore::DET::Type::castCacheStatistics() -> CastCacheStatistics {
+  auto& cache = castCache();
+  auto result = cache.statistics;
+  result.entries = cache.entries.size();
+  return result;
+};
 
-    std::function<CastPath(std::shared_ptr<Type>, std::shared_ptr<Type>)> doFromOrToLoop = nullptr;
-    doFromOrToLoop = [&](std::shared_ptr<Type> from, std::shared_ptr<Type> to) -> CastPath {
-      if (from->pointerLevel() == 0 && from->klass) {
-        for (auto& method: from->klass->toCasts) {
-          auto& special = method->returnType;
-          if (*special == *to || *special == *to->deconstify() || *special == *to->deconstify(true)) {
-            return { CC(CCT::To, method), CC(CCT::Destination) };
-          }
-          auto cast = doFromOrToLoop(special, to);
-          if (cast.size() > 0) {
-            cast.insert(cast.begin(), CC(CCT::To, method));
-            return cast;
-          }
-        }
-      }
-      if (to->indirectionLevel() == 0 && to->klass) {
-        for (auto& method: to->klass->fromCasts) {
-          auto& special = method->parameterVariables.front()->type;
-          if (*from == *special || *from == *special->deconstify() || *from == *special->deconstify(true)) {
-            return { CC(CCT::From, method), CC(CCT::Destination) };
-          }
-          auto cast = doFromOrToLoop(from, special);
-          if (cast.size() > 0) {
-            cast.insert(cast.end() - 1, CC(CCT::From, method));
-            return cast;
-          }
-        }
-      }
-      return {};
-    };
-    AC_FROM_LOOP;
-      auto cast = doFromOrToLoop(from, to);
-      if (cast.size() > 0) {
-        AC_RETURN_INDEX;
-        return cast;
-      }
-    AC_FROM_LOOP_END;
+void AltaCore::DET::Type::resetCastCacheStatistics() {
+  castCache().statistics = CastCacheStatistics();
+};
 
-    AC_FROM_LOOP;
-      if (to->isOptional && to->indirectionLevel() == 0) {
-        auto cast = findCast(from, to->optionalTarget, false);
-        if (cast.size() > 0) {
-          cast.insert(cast.end() - 1, CC(CCT::Wrap));
-          AC_RETURN_INDEX;
-          return cast;
-        }
-      }
-    AC_FROM_LOOP_END;
+namespace {
+  using namespace AltaCore;
 
-    AC_FROM_LOOP;
-      if (!from->isUnion() && to->isUnion() && to->indirectionLevel() == 0) {
-        size_t idx = 0;
-        auto cast = loop(from, to->unionOf, &idx);
-        if (cast.size() > 0) {
-          cast.insert(cast.end() - 1, CC(CCT::Widen, to, to->unionOf[idx]));
-        }
-        AC_RETURN_INDEX;
-        return cast;
-      }
-    AC_FROM_LOOP_END;
+  /**
+   * The state for a single `findCast` search
+   *
+   * `loop` searches for a cast from one type to any of several types (returning the index of the
+   * chosen one), while `reverseLoop` searches for a cast from any of several types to a single one.
+   * `fromOrTo` and `reverseFromOrTo` search for chains of user-defined `from`/`to` cast methods.
+   * Since those can refer to each other in cycles, their results are memoized for the duration of
+   * the search, and a query that's already in progress is treated as having no cast. Results that
+   * relied on that (i.e. that hit a query further up the stack) aren't memoized, since they're only
+   * right for as long as that query is still in progress.
+   *
+   * This is deliberately still a recursive search rather than a worklist: `findCast` returns the
+   * cast found by the first rule that matches (in a fixed order), and most rules wrap the result of a
+   * nested search in extra components, so every level has to resume exactly where it left off once
+   * its nested search is done. The memo keeps each `fromOrTo` query on the stack at most once and
+   * `loop` only ever loops back once (see `dontLoopBack`), so the depth is bounded by the number of
+   * distinct types the cast methods involved can reach, not by the number of paths to them.
+   */
+  struct CastSearch {
+    using Type = DET::Type;
+    using Class = DET::Class;
+    using NativeType = DET::NativeType;
+    using CastPath = DET::CastPath;
+    using CC = DET::CastComponent;
+    using CCT = DET::CastComponentType;
+    using SCT = DET::SpecialCastType;
+    using NT = DET::NativeType;
 
-    AC_FROM_LOOP;
-      if (
-        from->indirectionLevel() == 0 &&
-        to->indirectionLevel() == 0 &&
-        from->isNative &&
-        to->isNative &&
-        (
-          from->nativeTypeName == NT::Float ||
-          from->nativeTypeName == NT::Double
-        ) &&
-        (
-          to->nativeTypeName == NT::Float ||
-          to->nativeTypeName == NT::Double
-        )
-      ) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
-      }
-    AC_FROM_LOOP_END;
+    // key = interned `from` and `to`, plus the loop-back guards (which change what `loop` and `reverseLoop` try)
+    struct Query {
+      const Type* from;
+      const Type* to;
+      bool dontLoopBack;
+      bool dontReverseLoopBack;
 
-    AC_FROM_LOOP;
-      if (from->indirectionLevel() == 0 && to->indirectionLevel() == 0 && from->isNative && to->isNative && !from->isAny && !to->isAny) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
-      }
-    AC_FROM_LOOP_END;
+      bool operator ==(const Query& other) const {
+        return from == other.from && to == other.to && dontLoopBack == other.dontLoopBack && dontReverseLoopBack == other.dontReverseLoopBack;
+      };
+    };
 
-    if (manual) {
-      AC_FROM_LOOP;
-        if (from->referenceLevel() == 0 && to->referenceLevel() == 0 && from->pointerLevel() > 0 && to->pointerLevel() > 0) {
-          AC_RETURN_INDEX;
-          return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
-        }
-      AC_FROM_LOOP_END;
+    struct QueryHash {
+      size_t operator ()(const Query& query) const {
+        return (std::hash<const void*>()(query.from) * 31 + std::hash<const void*>()(query.to)) * 4 + (query.dontLoopBack ? 2 : 0) + (query.dontReverseLoopBack ? 1 : 0);
+      };
+    };
+
+    struct Result {
+      CastPath path;
+      // `reverseLoop` leaves `dontReverseLoopBack` changed, so a memoized result has to do the same
+      bool dontReverseLoopBack;
+    };
+
+    struct Memo {
+      std::unordered_map<Query, Result, QueryHash> results;
+      // queries that are still being searched, along with how deep in the stack they are
+      std::unordered_map<Query, size_t, QueryHash> inProgress;
+      // keeps the keys alive for the duration of the search
+      std::vector<std::shared_ptr<Type>> keepAlive;
+    };
+
+    bool manual;
+    bool dontReverseLoopBack = false;
+    std::stack<bool> dontLoopBack;
+
+    // how many memoized queries are currently being searched
+    size_t depth = 0;
+    // the shallowest in-progress query hit by the query currently being searched (`SIZE_MAX` if none)
+    size_t shallowestCycle = SIZE_MAX;
+
+    Memo fromOrToMemo;
+    Memo reverseFromOrToMemo;
+
+    CastSearch(bool _manual):
+      manual(_manual)
+    {
+      dontLoopBack.push(false);
+    };
+
+    CastPath loop(std::shared_ptr<Type> from, std::vector<std::shared_ptr<Type>> tos, size_t* index);
+    CastPath reverseLoop(std::vector<std::shared_ptr<Type>> froms, std::shared_ptr<Type> to, size_t* index);
+    CastPath fromOrTo(std::shared_ptr<Type> from, std::shared_ptr<Type> to);
+    CastPath reverseFromOrTo(std::shared_ptr<Type> from, std::shared_ptr<Type> to);
+
+    private:
+      CastPath memoized(Memo& memo, std::shared_ptr<Type> from, std::shared_ptr<Type> to, CastPath (CastSearch::* search)(std::shared_ptr<Type>, std::shared_ptr<Type>));
+      CastPath fromOrToUncached(std::shared_ptr<Type> from, std::shared_ptr<Type> to);
+      CastPath reverseFromOrToUncached(std::shared_ptr<Type> from, std::shared_ptr<Type> to);
+  };
+};
+
+auto CastSearch::memoized(Memo& memo, std::shared_ptr<Type> from, std::shared_ptr<Type> to, CastPath (CastSearch::* search)(std::shared_ptr<Type>, std::shared_ptr<Type>)) -> CastPath {
+  auto canonicalFrom = from->isInterned ? from : Type::intern(from->copy());
+  auto canonicalTo = to->isInterned ? to : Type::intern(to->copy());
+  Query query { canonicalFrom.get(), canonicalTo.get(), dontLoopBack.top(), dontReverseLoopBack };
+
+  auto it = memo.results.find(query);
+  if (it != memo.results.end()) {
+    dontReverseLoopBack = it->second.dontReverseLoopBack;
+    return it->second.path;
+  }
+
+  auto active = memo.inProgress.find(query);
+  if (active != memo.inProgress.end()) {
+    // we're still working on it further up the stack (i.e. we found a cycle)
+    shallowestCycle = std::min(shallowestCycle, active->second);
+    return {};
+  }
+
+  auto ourDepth = depth++;
+  auto outerCycle = shallowestCycle;
+  shallowestCycle = SIZE_MAX;
+  memo.inProgress[query] = ourDepth;
+
+  auto result = (this->*search)(from, to);
+
+  memo.inProgress.erase(query);
+  --depth;
+
+  if (shallowestCycle >= ourDepth) {
+    // the only cycles we hit (if any) led back to this query, so the result is final
+    memo.keepAlive.push_back(canonicalFrom);
+    memo.keepAlive.push_back(canonicalTo);
+    memo.results[query] = Result { result, dontReverseLoopBack };
+    shallowestCycle = outerCycle;
+  } else {
+    // this result assumed that a query further up has no cast, so the caller's result isn't final either
+    shallowestCycle = std::min(outerCycle, shallowestCycle);
+  }
+
+  return result;
+};
+
+auto CastSearch::fromOrTo(std::shared_ptr<Type> from, std::shared_ptr<Type> to) -> CastPath {
+  return memoized(fromOrToMemo, from, to, &CastSearch::fromOrToUncached);
+};
+
+auto CastSearch::reverseFromOrTo(std::shared_ptr<Type> from, std::shared_ptr<Type> to) -> CastPath {
+  return memoized(reverseFromOrToMemo, from, to, &CastSearch::reverseFromOrToUncached);
+};
+
+auto CastSearch::reverseLoop(std::vector<std::shared_ptr<Type>> froms, std::shared_ptr<Type> to, size_t* index) -> CastPath {
+  #define AC_FROM_LOOP for (size_t i = 0; i < froms.size(); ++i) { auto& from = froms[i];
+  #define AC_FROM_LOOP_END }
+  #define AC_RETURN_INDEX if (index) { *index = i; }
+
+  if (to->isAny && to->pointerLevel() == 0) {
+    return { CC(CCT::Destination) };
+  }
+
+  AC_FROM_LOOP;
+    if (*from == *to) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::Destination) };
     }
+  AC_FROM_LOOP_END;
 
-    AC_FROM_LOOP;
-      if (
-        from->referenceLevel() == 0 &&
-        to->referenceLevel() == 0 &&
-        from->pointerLevel() > 0 &&
-        to->pointerLevel() == 0 &&
-        to->isNative &&
-        (
-          to->nativeTypeName == NT::Integer ||
-          to->nativeTypeName == NT::Byte
-        )
-      ) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
-      }
-    AC_FROM_LOOP_END;
+  decltype(froms) deconstFroms;
+  bool deconstSame = true;
+  AC_FROM_LOOP;
+    auto deconst = from->deconstify();
+    deconstFroms.push_back(deconst);
+    if (!deconst->isAny && !(*deconst == *from)) {
+      deconstSame = false;
+    }
+  AC_FROM_LOOP_END;
 
-    AC_FROM_LOOP;
-      if (from->referenceLevel() == 0 && from->pointerLevel() > 0 && to->indirectionLevel() == 0 && to->isNative && to->nativeTypeName == NT::Bool) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::Destination, SCT::TestPointer) };
-      }
-    AC_FROM_LOOP_END;
+  if (!deconstSame) {
+    auto cast = reverseLoop(deconstFroms, to, index);
+    if (cast.size() > 0) {
+      return cast;
+    }
+  };
 
-    AC_FROM_LOOP;
-      if (!dontReverseLoopBack && from->referenceLevel() > 0) {
-        dontReverseLoopBack = true;
-        auto other = from->dereference();
-        while (other->referenceLevel() >= 0) {
-          auto cast = loop(other, { to }, index);
-          if (cast.size() > 0) {
-            for (size_t i = other->referenceLevel(); i < from->referenceLevel(); ++i) {
-              cast.insert(cast.begin(), CC(CCT::Dereference));
-            }
-            AC_RETURN_INDEX;
-            dontReverseLoopBack = false;
-            return cast;
+  auto deconstTo = to->deconstify();
+  auto noconstTo = to->deconstify(true);
+  if (!to->isAny && !(*to == *deconstTo)) {
+    auto cast = reverseLoop(froms, deconstTo, index);
+    if (cast.size() > 0) {
+      return cast;
+    }
+  }
+  if (!to->isAny && !(*to == *noconstTo)) {
+    auto cast = reverseLoop(froms, noconstTo, index);
+    if (cast.size() > 0) {
+      return cast;
+    }
+  }
+
+  AC_FROM_LOOP;
+    if (from->indirectionLevel() > 0 && to->indirectionLevel() > 0 && from->klass && to->klass && to->klass->hasParent(from->klass)) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::Downcast, to->klass), CC(CCT::Destination) };
+    }
+  AC_FROM_LOOP_END;
+
+  AC_FROM_LOOP;
+    if (
+      (
+        (from->referenceLevel() <= 1 && to->referenceLevel() <= 1) ||
+        (from->pointerLevel() <= 1 && to->pointerLevel() == from->pointerLevel())
+      ) &&
+      from->klass &&
+      to->klass &&
+      from->klass->hasParent(to->klass)
+    ) {
+      auto accessorClass = from->klass;
+      CastPath cast;
+      size_t i = 0;
+      while (i < accessorClass->parents.size()) {
+        auto& parent = accessorClass->parents[i];
+        if (parent->id == to->klass->id) {
+          cast.push_back(CC(CCT::Upcast, parent));
+          if (from->referenceLevel() > to->referenceLevel()) {
+            cast.push_back(CC(CCT::Dereference));
           }
-          if (other->referenceLevel() == 0) break;
+          break;
+        }
+        if (parent->hasParent(to->klass)) {
+          cast.push_back(CC(CCT::Upcast, parent));
+          i = 0;
+          accessorClass = parent;
+          continue;
         }
+        ++i;
       }
-    AC_FROM_LOOP_END;
+      AC_RETURN_INDEX;
+      cast.push_back(CC(CCT::Destination));
+      return cast;
+    }
+  AC_FROM_LOOP_END;
 
-    AC_FROM_LOOP;
-      if (!dontReverseLoopBack && from->referenceLevel() < to->referenceLevel()) {
-        dontReverseLoopBack = true;
-        auto cast = loop(from->reference(), { to }, index);
-        if (cast.size() > 0) {
-          cast.insert(cast.begin(), CC(CCT::Reference));
-          AC_RETURN_INDEX;
-          dontReverseLoopBack = false;
-          return cast;
-        }
-      };
-    AC_FROM_LOOP_END;
+  AC_FROM_LOOP;
+    if (from->indirectionLevel() == 0 && to->indirectionLevel() == 0 && from->isOptional && to->nativeTypeName == NativeType::Bool) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::Destination, SCT::OptionalPresent) };
+    }
 
-    dontReverseLoopBack = false;
+    if (to->indirectionLevel() == 0 && to->isOptional && from->pointerLevel() == 1 && from->isAny) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::Destination, SCT::EmptyOptional) };
+    }
 
-    if (index) *index = SIZE_MAX;
-    return {};
+    if (from->indirectionLevel() == 0 && to->indirectionLevel() == 0 && from->isFunction && to->isFunction && from->isRawFunction && !to->isRawFunction) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::Destination, SCT::WrapFunction) };
+    }
 
-    #undef AC_FROM_LOOP
-    #undef AC_FROM_LOOP_END
-    #undef AC_RETURN_INDEX
-  };
+    // make sure to prefer simple dereferences over `from` or `to` casts
+    if (from->referenceLevel() > to->referenceLevel() && from->destroyReferences()->isExactlyCompatibleWith(*to->destroyReferences())) {
+      CastPath path;
+      for (size_t i = from->referenceLevel(); i > to->referenceLevel(); --i) {
+        path.push_back(CC(CCT::Dereference));
+      }
+      path.push_back(CC(CCT::Destination));
+      AC_RETURN_INDEX;
+      return path;
+    }
+  AC_FROM_LOOP_END;
+  AC_FROM_LOOP;
+    auto cast = reverseFromOrTo(from, to);
+    if (cast.size() > 0) {
+      AC_RETURN_INDEX;
+      return cast;
+    }
+  AC_FROM_LOOP_END;
 
-  std::stack<bool> dontLoopBack;
-  dontLoopBack.push(false);
+  AC_FROM_LOOP;
+    if (to->isOptional && to->indirectionLevel() == 0) {
+      auto cast = Type::findCast(from, to->optionalTarget, false);
+      if (cast.size() > 0) {
+        cast.insert(cast.end() - 1, CC(CCT::Wrap));
+        AC_RETURN_INDEX;
+        return cast;
+      }
+    }
+  AC_FROM_LOOP_END;
 
-  loop = [&loop, &reverseLoop, &manual, &dontLoopBack](std::shared_ptr<Type> from, std::vector<std::shared_ptr<Type>> tos, size_t* index) -> CastPath {
-    if (manual && from->isUnion() && tos.size() == 1 && !tos.front()->isUnion() && from->indirectionLevel() == 0) {
+  AC_FROM_LOOP;
+    if (!from->isUnion() && to->isUnion() && to->indirectionLevel() == 0) {
       size_t idx = 0;
-      auto cast = reverseLoop(from->unionOf, tos.front(), &idx);
+      auto cast = loop(from, to->unionOf, &idx);
       if (cast.size() > 0) {
-        cast.insert(cast.begin(), CC(CCT::Narrow, from->unionOf[idx]));
-        if (index) *index = 0;
-        return cast;
+        cast.insert(cast.end() - 1, CC(CCT::Widen, to, to->unionOf[idx]));
       }
-      if (index) *index = SIZE_MAX;
-      return {};
+      AC_RETURN_INDEX;
+      return cast;
     }
+  AC_FROM_LOOP_END;
 
-    #define AC_TO_LOOP for (size_t i = 0; i < tos.size(); ++i) { auto& to = tos[i];
-    #define AC_TO_LOOP_END }
-    #define AC_RETURN_INDEX if (index) { *index = i; }
+  AC_FROM_LOOP;
+    if (
+      from->indirectionLevel() == 0 &&
+      to->indirectionLevel() == 0 &&
+      from->isNative &&
+      to->isNative &&
+      (
+        from->nativeTypeName == NT::Float ||
+        from->nativeTypeName == NT::Double
+      ) &&
+      (
+        to->nativeTypeName == NT::Float ||
+        to->nativeTypeName == NT::Double
+      )
+    ) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
+    }
+  AC_FROM_LOOP_END;
 
-    auto saveManual = [&]() {
-      auto tmp = manual;
-      manual = false;
-      return tmp;
-    };
-    auto restoreManual = [&](bool man) {
-      manual = man;
-    };
+  AC_FROM_LOOP;
+    if (from->indirectionLevel() == 0 && to->indirectionLevel() == 0 && from->isNative && to->isNative && !from->isAny && !to->isAny) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
+    }
+  AC_FROM_LOOP_END;
 
-    AC_TO_LOOP;
-      if (*from == *to) {
+  if (manual) {
+    AC_FROM_LOOP;
+      if (from->referenceLevel() == 0 && to->referenceLevel() == 0 && from->pointerLevel() > 0 && to->pointerLevel() > 0) {
         AC_RETURN_INDEX;
-        return { CC(CCT::Destination) };
+        return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
       }
-    AC_TO_LOOP_END;
+    AC_FROM_LOOP_END;
+  }
 
-    if (from->isAny && from->pointerLevel() == 1) {
-      AC_TO_LOOP;
-        if (to->indirectionLevel() == 0 && to->isOptional && from->pointerLevel() == 1 && from->isAny) {
-          AC_RETURN_INDEX;
-          return { CC(CCT::Destination, SCT::EmptyOptional) };
-        }
-        if (to->pointerLevel() > 0) {
-          AC_RETURN_INDEX;
-          return { CC(CCT::Destination) };
-        }
-      AC_TO_LOOP_END;
+  AC_FROM_LOOP;
+    if (
+      from->referenceLevel() == 0 &&
+      to->referenceLevel() == 0 &&
+      from->pointerLevel() > 0 &&
+      to->pointerLevel() == 0 &&
+      to->isNative &&
+      (
+        to->nativeTypeName == NT::Integer ||
+        to->nativeTypeName == NT::Byte
+      )
+    ) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
     }
+  AC_FROM_LOOP_END;
 
-    decltype(tos) deconstTos;
-    decltype(tos) noconstTos;
-    bool deconstSame = true;
-    bool noconstSame = true;
-    AC_TO_LOOP;
-      auto deconst = to->deconstify();
-      auto noconst = to->deconstify(true);
-      deconstTos.push_back(deconst);
-      noconstTos.push_back(noconst);
-      if (!deconst->isAny && !(*deconst == *to)) {
-        deconstSame = false;
-      }
-      if (!noconst->isAny && !(*noconst == *to)) {
-        noconstSame = false;
+  AC_FROM_LOOP;
+    if (from->referenceLevel() == 0 && from->pointerLevel() > 0 && to->indirectionLevel() == 0 && to->isNative && to->nativeTypeName == NT::Bool) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::Destination, SCT::TestPointer) };
+    }
+  AC_FROM_LOOP_END;
+
+  AC_FROM_LOOP;
+    if (!dontReverseLoopBack && from->referenceLevel() > 0) {
+      dontReverseLoopBack = true;
+      auto other = from->dereference();
+      while (other->referenceLevel() >= 0) {
+        auto cast = loop(other, { to }, index);
+        if (cast.size() > 0) {
+          for (size_t i = other->referenceLevel(); i < from->referenceLevel(); ++i) {
+            cast.insert(cast.begin(), CC(CCT::Dereference));
+          }
+          AC_RETURN_INDEX;
+          dontReverseLoopBack = false;
+          return cast;
+        }
+        if (other->referenceLevel() == 0) break;
+        other = other->dereference();
       }
-    AC_TO_LOOP_END;
+    }
+  AC_FROM_LOOP_END;
 
-    if (!deconstSame) {
-      auto cast = loop(from, deconstTos, index);
+  AC_FROM_LOOP;
+    if (!dontReverseLoopBack && from->referenceLevel() < to->referenceLevel()) {
+      dontReverseLoopBack = true;
+      auto cast = loop(from->reference(), { to }, index);
       if (cast.size() > 0) {
+        cast.insert(cast.begin(), CC(CCT::Reference));
+        AC_RETURN_INDEX;
+        dontReverseLoopBack = false;
         return cast;
       }
     };
+  AC_FROM_LOOP_END;
+
+  dontReverseLoopBack = false;
+
+  if (index) *index = SIZE_MAX;
+  return {};
 
-    if (!noconstSame) {
-      auto cast = loop(from, noconstTos, index);
+  #undef AC_FROM_LOOP
+  #undef AC_FROM_LOOP_END
+  #undef AC_RETURN_INDEX
+};
+
+auto CastSearch::reverseFromOrToUncached(std::shared_ptr<Type> from, std::shared_ptr<Type> to) -> CastPath {
+  if (from->pointerLevel() == 0 && from->klass) {
+    for (auto& method: from->klass->toCasts) {
+      auto& special = method->returnType;
+      if (*special == *to || *special == *to->deconstify() || *special == *to->deconstify(true)) {
+        return { CC(CCT::To, method), CC(CCT::Destination) };
+      }
+      auto cast = reverseFromOrTo(special, to);
       if (cast.size() > 0) {
+        cast.insert(cast.begin(), CC(CCT::To, method));
         return cast;
       }
-    };
-
-    auto deconstFrom = from->deconstify();
-    if (!deconstFrom->isAny && !(*from == *deconstFrom)) {
-      auto cast = loop(deconstFrom, tos, index);
+    }
+  }
+  if (to->indirectionLevel() == 0 && to->klass) {
+    for (auto& method: to->klass->fromCasts) {
+      auto& special = method->parameterVariables.front()->type;
+      if (*from == *special || *from == *special->deconstify() || *from == *special->deconstify(true)) {
+        return { CC(CCT::From, method), CC(CCT::Destination) };
+      }
+      auto cast = reverseFromOrTo(from, special);
       if (cast.size() > 0) {
+        cast.insert(cast.end() - 1, CC(CCT::From, method));
         return cast;
       }
     }
+  }
+  return {};
+};
 
-    AC_TO_LOOP;
-      if (from->indirectionLevel() > 0 && to->indirectionLevel() > 0 && from->referenceLevel() == to->referenceLevel() && from->klass && to->klass && to->klass->hasParent(from->klass)) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::Downcast, to->klass), CC(CCT::Destination) };
-      }
-    AC_TO_LOOP_END;
+  #define AC_CAST_FROM_LOOP if (from->pointerLevel() == 0 && from->klass) {\
+      for (auto& method: from->klass->toCasts) {\
+        auto& special = method->returnType;
+  #define AC_CAST_FROM_LOOP_END }}
+  #define AC_CAST_TO_LOOP if (to->indirectionLevel() == 0 && to->klass) {\
+      for (auto& method: to->klass->fromCasts) {\
+        auto& special = method->parameterVariables.front()->type;
+  #define AC_CAST_TO_LOOP_END }}
+
+auto CastSearch::loop(std::shared_ptr<Type> from, std::vector<std::shared_ptr<Type>> tos, size_t* index) -> CastPath {
+  if (manual && from->isUnion() && tos.size() == 1 && !tos.front()->isUnion() && from->indirectionLevel() == 0) {
+    size_t idx = 0;
+    auto cast = reverseLoop(from->unionOf, tos.front(), &idx);
+    if (cast.size() > 0) {
+      cast.insert(cast.begin(), CC(CCT::Narrow, from->unionOf[idx]));
+      if (index) *index = 0;
+      return cast;
+    }
+    if (index) *index = SIZE_MAX;
+    return {};
+  }
 
-    AC_TO_LOOP;
-      if (
-        (
-          (
-            (from->referenceLevel() <= 1 && to->referenceLevel() <= 1) ||
-            (from->pointerLevel() <= 1)
-          ) &&
-          (to->pointerLevel() == from->pointerLevel())
-        ) &&
-        from->klass &&
-        to->klass &&
-        from->klass->hasParent(to->klass)
-      ) {
-        auto accessorClass = from->klass;
-        CastPath cast;
-        size_t i = 0;
-        while (i < accessorClass->parents.size()) {
-          auto& parent = accessorClass->parents[i];
-          if (parent->id == to->klass->id) {
-            cast.push_back(CC(CCT::Upcast, parent));
-            if (from->referenceLevel() > to->referenceLevel()) {
-              cast.push_back(CC(CCT::Dereference));
-            }
-            break;
-          }
-          if (parent->hasParent(to->klass)) {
-            cast.push_back(CC(CCT::Upcast, parent));
-            i = 0;
-            accessorClass = parent;
-            continue;
-          }
-          ++i;
-        }
-        AC_RETURN_INDEX;
-        cast.push_back(CC(CCT::Destination));
-        return cast;
-      }
-    AC_TO_LOOP_END;
+  #define AC_TO_LOOP for (size_t i = 0; i < tos.size(); ++i) { auto& to = tos[i];
+  #define AC_TO_LOOP_END }
+  #define AC_RETURN_INDEX if (index) { *index = i; }
 
-    AC_TO_LOOP;
-      if (from->indirectionLevel() == 0 && to->indirectionLevel() == 0 && from->isOptional && to->nativeTypeName == NativeType::Bool) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::Destination, SCT::OptionalPresent) };
-      }
+  auto saveManual = [&]() {
+    auto tmp = manual;
+    manual = false;
+    return tmp;
+  };
+  auto restoreManual = [&](bool man) {
+    manual = man;
+  };
 
+  AC_TO_LOOP;
+    if (*from == *to) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::Destination) };
+    }
+  AC_TO_LOOP_END;
+
+  if (from->isAny && from->pointerLevel() == 1) {
+    AC_TO_LOOP;
       if (to->indirectionLevel() == 0 && to->isOptional && from->pointerLevel() == 1 && from->isAny) {
         AC_RETURN_INDEX;
         return { CC(CCT::Destination, SCT::EmptyOptional) };
       }
-
-      if (from->indirectionLevel() == 0 && to->indirectionLevel() == 0 && from->isFunction && to->isFunction && from->isRawFunction && !to->isRawFunction) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::Destination, SCT::WrapFunction) };
-      }
-
-      // make sure to prefer simple dereferences over `from` or `to` casts
-      if (from->referenceLevel() > to->referenceLevel() && from->destroyReferences()->isExactlyCompatibleWith(*to->destroyReferences())) {
-        CastPath path;
-        for (size_t i = from->referenceLevel(); i > to->referenceLevel(); --i) {
-          path.push_back(CC(CCT::Dereference));
-        }
-        path.push_back(CC(CCT::Destination));
+      if (to->pointerLevel() > 0) {
         AC_RETURN_INDEX;
-        return path;
-      }
-    AC_TO_LOOP_END;
-
-    std::function<CastPath(std::shared_ptr<Type>, std::shared_ptr<Type>)> doFromOrToLoop = nullptr;
-
-    #define AC_CAST_FROM_LOOP if (from->pointerLevel() == 0 && from->klass) {\
-        for (auto& method: from->klass->toCasts) {\
-          auto& special = method->returnType;
-    #define AC_CAST_FROM_LOOP_END }}
-    #define AC_CAST_TO_LOOP if (to->indirectionLevel() == 0 && to->klass) {\
-        for (auto& method: to->klass->fromCasts) {\
-          auto& special = method->parameterVariables.front()->type;
-    #define AC_CAST_TO_LOOP_END }}
-
-    doFromOrToLoop = [&](std::shared_ptr<Type> from, std::shared_ptr<Type> to) -> CastPath {
-      // simple equality
-      if (*from == *to) {
-        return { CC(CCT::Destination) };
-      }
-      if (from->pointerLevel() == 1 && from->isAny && to->pointerLevel() == 1) {
         return { CC(CCT::Destination) };
       }
+    AC_TO_LOOP_END;
+  }
 
-      // basic iteration
-      AC_CAST_FROM_LOOP;
-        if (*special == *to || *special == *to->deconstify() || *special == *to->deconstify(true)) {
-          return { CC(CCT::To, method), CC(CCT::Destination) };
-        }
-      AC_CAST_FROM_LOOP_END;
-      AC_CAST_TO_LOOP;
-        if (*from == *special || *from == *special->deconstify() || *from == *special->deconstify(true)) {
-          return { CC(CCT::From, method), CC(CCT::Destination) };
-        }
-      AC_CAST_TO_LOOP_END;
-
-      // native iteration - floating-point
-      AC_CAST_FROM_LOOP;
-        if (
-          special->indirectionLevel() == 0 &&
-          to->indirectionLevel() == 0 &&
-          special->isNative &&
-          to->isNative &&
-          (
-            special->nativeTypeName == NT::Float ||
-            special->nativeTypeName == NT::Double
-          ) &&
-          (
-            to->nativeTypeName == NT::Float ||
-            to->nativeTypeName == NT::Double
-          )
-        ) {
-          return { CC(CCT::To, method), CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
-        }
-      AC_CAST_FROM_LOOP_END;
-      AC_CAST_TO_LOOP;
-        if (
-          from->indirectionLevel() == 0 &&
-          special->indirectionLevel() == 0 &&
-          from->isNative &&
-          special->isNative &&
-          (
-            from->nativeTypeName == NT::Float ||
-            from->nativeTypeName == NT::Double
-          ) &&
-          (
-            special->nativeTypeName == NT::Float ||
-            special->nativeTypeName == NT::Double
-          )
-        ) {
-          return { CC(CCT::SimpleCoercion, special), CC(CCT::From, method), CC(CCT::Destination) };
-        }
-      AC_CAST_TO_LOOP_END;
+  decltype(tos) deconstTos;
+  decltype(tos) noconstTos;
+  bool deconstSame = true;
+  bool noconstSame = true;
+  AC_TO_LOOP;
+    auto deconst = to->deconstify();
+    auto noconst = to->deconstify(true);
+    deconstTos.push_back(deconst);
+    noconstTos.push_back(noconst);
+    if (!deconst->isAny && !(*deconst == *to)) {
+      deconstSame = false;
+    }
+    if (!noconst->isAny && !(*noconst == *to)) {
+      noconstSame = false;
+    }
+  AC_TO_LOOP_END;
 
-      // native iteration
-      AC_CAST_FROM_LOOP;
-        if (special->indirectionLevel() == 0 && to->indirectionLevel() == 0 && special->isNative && to->isNative && !special->isAny && !to->isAny) {
-          return { CC(CCT::To, method), CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
-        }
-      AC_CAST_FROM_LOOP_END;
-      AC_CAST_TO_LOOP;
-        if (from->indirectionLevel() == 0 && special->indirectionLevel() == 0 && from->isNative && special->isNative && !from->isAny && !special->isAny) {
-          return { CC(CCT::SimpleCoercion, special), CC(CCT::From, method), CC(CCT::Destination) };
-        }
-      AC_CAST_TO_LOOP_END;
+  if (!deconstSame) {
+    auto cast = loop(from, deconstTos, index);
+    if (cast.size() > 0) {
+      return cast;
+    }
+  };
 
-      // child iteration
-      AC_CAST_FROM_LOOP;
-        if (special->indirectionLevel() > 0 && to->indirectionLevel() > 0 && special->referenceLevel() == to->referenceLevel() && special->klass && to->klass && to->klass->hasParent(special->klass)) {
-          return { CC(CCT::To, method), CC(CCT::Downcast, to->klass), CC(CCT::Destination) };
-        }
-      AC_CAST_FROM_LOOP_END;
-      AC_CAST_TO_LOOP;
-        if (from->indirectionLevel() > 0 && special->indirectionLevel() > 0 && from->referenceLevel() == special->referenceLevel() && from->klass && special->klass && special->klass->hasParent(from->klass)) {
-          return { CC(CCT::Downcast, special->klass), CC(CCT::From, method), CC(CCT::Destination) };
-        }
-      AC_CAST_TO_LOOP_END;
-
-      // parent iteration
-      AC_CAST_FROM_LOOP;
-        if (
-          (
-            (
-              (special->referenceLevel() <= 1 && to->referenceLevel() <= 1) ||
-              (special->pointerLevel() <= 1)
-            ) &&
-            (to->pointerLevel() == special->pointerLevel())
-          ) &&
-          special->klass &&
-          to->klass &&
-          special->klass->hasParent(to->klass)
-        ) {
-          auto accessorClass = special->klass;
-          CastPath cast;
-          cast.push_back(CC(CCT::To, method));
-          size_t i = 0;
-          while (i < accessorClass->parents.size()) {
-            auto& parent = accessorClass->parents[i];
-            if (parent->id == to->klass->id) {
-              cast.push_back(CC(CCT::Upcast, parent));
-              if (special->referenceLevel() > to->referenceLevel()) {
-                cast.push_back(CC(CCT::Dereference));
-              }
-              break;
-            }
-            if (parent->hasParent(to->klass)) {
-              cast.push_back(CC(CCT::Upcast, parent));
-              i = 0;
-              accessorClass = parent;
-              continue;
-            }
-            ++i;
-          }
-          cast.push_back(CC(CCT::Destination));
-          return cast;
-        }
-      AC_CAST_FROM_LOOP_END;
-      AC_CAST_TO_LOOP;
-        if (
-          (
-            (
-              (from->referenceLevel() <= 1 && special->referenceLevel() <= 1) ||
-              (from->pointerLevel() <= 1)
-            ) &&
-            (special->pointerLevel() == from->pointerLevel())
-          ) &&
-          from->klass &&
-          special->klass &&
-          from->klass->hasParent(special->klass)
-        ) {
-          auto accessorClass = from->klass;
-          CastPath cast;
-          size_t i = 0;
-          while (i < accessorClass->parents.size()) {
-            auto& parent = accessorClass->parents[i];
-            if (parent->id == special->klass->id) {
-              cast.push_back(CC(CCT::Upcast, parent));
-              if (from->referenceLevel() > special->referenceLevel()) {
-                cast.push_back(CC(CCT::Dereference));
-              }
-              break;
-            }
-            if (parent->hasParent(special->klass)) {
-              cast.push_back(CC(CCT::Upcast, parent));
-              i = 0;
-              accessorClass = parent;
-              continue;
-            }
-            ++i;
-          }
-          cast.push_back(CC(CCT::From, method));
-          cast.push_back(CC(CCT::Destination));
-          return cast;
-        }
-      AC_CAST_TO_LOOP_END;
+  if (!noconstSame) {
+    auto cast = loop(from, noconstTos, index);
+    if (cast.size() > 0) {
+      return cast;
+    }
+  };
 
-      // reference iteration
-      AC_CAST_FROM_LOOP;
-        size_t maxToRefLevel = 0;
-        if (to->referenceLevel() > maxToRefLevel) {
-          maxToRefLevel = to->referenceLevel();
-        }
+  auto deconstFrom = from->deconstify();
+  if (!deconstFrom->isAny && !(*from == *deconstFrom)) {
+    auto cast = loop(deconstFrom, tos, index);
+    if (cast.size() > 0) {
+      return cast;
+    }
+  }
 
-        if (special->referenceLevel() < maxToRefLevel) {
-          auto cast = doFromOrToLoop(special->reference(), to);
-          if (cast.size() > 0) {
-            cast.insert(cast.begin(), CC(CCT::Reference));
-            cast.insert(cast.begin(), CC(CCT::To, method));
-            return cast;
-          }
-        };
-      AC_CAST_FROM_LOOP_END;
-      AC_CAST_TO_LOOP;
-        size_t maxToRefLevel = 0;
-        if (special->referenceLevel() > maxToRefLevel) {
-          maxToRefLevel = special->referenceLevel();
-        }
+  AC_TO_LOOP;
+    if (from->indirectionLevel() > 0 && to->indirectionLevel() > 0 && from->referenceLevel() == to->referenceLevel() && from->klass && to->klass && to->klass->hasParent(from->klass)) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::Downcast, to->klass), CC(CCT::Destination) };
+    }
+  AC_TO_LOOP_END;
 
-        if (from->referenceLevel() < maxToRefLevel) {
-          auto cast = doFromOrToLoop(from->reference(), special);
-          if (cast.size() > 0) {
-            cast.insert(cast.begin(), CC(CCT::Reference));
-            cast.insert(cast.end() - 1, CC(CCT::From, method));
-            return cast;
-          }
-        };
-      AC_CAST_TO_LOOP_END;
-
-      // union iteration
-      AC_CAST_FROM_LOOP;
-        if (!special->isUnion() && to->isUnion() && to->indirectionLevel() == 0) {
-          for (auto& otherTo: to->unionOf) {
-            auto cast = doFromOrToLoop(special, otherTo);
-            if (cast.size() > 0) {
-              cast.insert(cast.begin(), CC(CCT::To, method));
-              cast.insert(cast.end() - 1, CC(CCT::Widen, to, otherTo));
-              return cast;
-            }
-          }
-        }
-      AC_CAST_FROM_LOOP_END;
-      AC_CAST_TO_LOOP;
-        if (!from->isUnion() && special->isUnion() && special->indirectionLevel() == 0) {
-          for (auto& otherTo: special->unionOf) {
-            auto cast = doFromOrToLoop(from, otherTo);
-            if (cast.size() > 0) {
-              cast.insert(cast.end() - 1, CC(CCT::Widen, special, otherTo));
-              cast.insert(cast.end() - 1, CC(CCT::From, method));
-              return cast;
-            }
+  AC_TO_LOOP;
+    if (
+      (
+        (
+          (from->referenceLevel() <= 1 && to->referenceLevel() <= 1) ||
+          (from->pointerLevel() <= 1)
+        ) &&
+        (to->pointerLevel() == from->pointerLevel())
+      ) &&
+      from->klass &&
+      to->klass &&
+      from->klass->hasParent(to->klass)
+    ) {
+      auto accessorClass = from->klass;
+      CastPath cast;
+      size_t i = 0;
+      while (i < accessorClass->parents.size()) {
+        auto& parent = accessorClass->parents[i];
+        if (parent->id == to->klass->id) {
+          cast.push_back(CC(CCT::Upcast, parent));
+          if (from->referenceLevel() > to->referenceLevel()) {
+            cast.push_back(CC(CCT::Dereference));
           }
+          break;
         }
-      AC_CAST_TO_LOOP_END;
-
-      // recursive iteration
-      AC_CAST_FROM_LOOP;
-        auto cast = doFromOrToLoop(special, to);
-        if (cast.size() > 0) {
-          cast.insert(cast.begin(), CC(CCT::To, method));
-          return cast;
-        }
-      AC_CAST_FROM_LOOP_END;
-      AC_CAST_TO_LOOP;
-        auto cast = doFromOrToLoop(from, special);
-        if (cast.size() > 0) {
-          cast.insert(cast.end() - 1, CC(CCT::From, method));
-          return cast;
+        if (parent->hasParent(to->klass)) {
+          cast.push_back(CC(CCT::Upcast, parent));
+          i = 0;
+          accessorClass = parent;
+          continue;
         }
-      AC_CAST_TO_LOOP_END;
-
-      // parent from-to iteration
-      AC_CAST_FROM_LOOP;
-        if (special->klass) {
-          std::queue<std::vector<std::shared_ptr<Class>>> nextUp;
-          for (auto& parent: special->klass->parents) {
-            nextUp.push({ parent });
-          }
-          while (nextUp.size() > 0) {
-            auto curr = nextUp.front();
-            nextUp.pop();
-            for (auto& parent: curr.back()->parents) {
-              auto copy = curr;
-              copy.push_back(parent);
-              nextUp.push(copy);
-            }
-            auto cast = doFromOrToLoop(std::make_shared<Type>(curr.back()), to);
-            if (cast.size() > 0) {
-              for (auto& parent: curr) {
-                cast.insert(cast.begin(), CC(CCT::Upcast, parent));
-              }
-              return cast;
-            }
+        ++i;
+      }
+      AC_RETURN_INDEX;
+      cast.push_back(CC(CCT::Destination));
+      return cast;
+    }
+  AC_TO_LOOP_END;
+
+  AC_TO_LOOP;
+    if (from->indirectionLevel() == 0 && to->indirectionLevel() == 0 && from->isOptional && to->nativeTypeName == NativeType::Bool) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::Destination, SCT::OptionalPresent) };
+    }
+
+    if (to->indirectionLevel() == 0 && to->isOptional && from->pointerLevel() == 1 && from->isAny) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::Destination, SCT::EmptyOptional) };
+    }
+
+    if (from->indirectionLevel() == 0 && to->indirectionLevel() == 0 && from->isFunction && to->isFunction && from->isRawFunction && !to->isRawFunction) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::Destination, SCT::WrapFunction) };
+    }
+
+    // make sure to prefer simple dereferences over `from` or `to` casts
+    if (from->referenceLevel() > to->referenceLevel() && from->destroyReferences()->isExactlyCompatibleWith(*to->destroyReferences())) {
+      CastPath path;
+      for (size_t i = from->referenceLevel(); i > to->referenceLevel(); --i) {
+        path.push_back(CC(CCT::Dereference));
+      }
+      path.push_back(CC(CCT::Destination));
+      AC_RETURN_INDEX;
+      return path;
+    }
+  AC_TO_LOOP_END;
+  AC_TO_LOOP;
+    auto cast = fromOrTo(from, to);
+    if (cast.size() > 0) {
+      AC_RETURN_INDEX;
+      return cast;
+    }
+  AC_TO_LOOP_END;
+  AC_TO_LOOP;
+    if (from->klass && from->pointerLevel() == 0) {
+      std::queue<std::vector<std::shared_ptr<Class>>> nextUp;
+      // a class that's already been queued was reached by a shorter path, so there's
+      // nothing new to find by going through it again (e.g. in diamond hierarchies)
+      std::unordered_set<std::string> queued;
+      for (auto& parent: from->klass->parents) {
+        if (!queued.insert(parent->id).second) continue;
+        nextUp.push({ parent });
+      }
+      while (nextUp.size() > 0) {
+        auto curr = nextUp.front();
+        nextUp.pop();
+        for (auto& parent: curr.back()->parents) {
+          if (!queued.insert(parent->id).second) continue;
+          auto copy = curr;
+          copy.push_back(parent);
+          nextUp.push(copy);
+        }
+        auto cast = fromOrTo(std::make_shared<Type>(curr.back()), to);
+        if (cast.size() > 0) {
+          for (auto& parent: curr) {
+            cast.insert(cast.begin(), CC(CCT::Upcast, parent));
           }
+          AC_RETURN_INDEX;
+          return cast;
         }
-      AC_CAST_FROM_LOOP_END;
+      }
+    }
+  AC_TO_LOOP_END;
 
-      return {};
-    };
-    AC_TO_LOOP;
-      auto cast = doFromOrToLoop(from, to);
+  AC_TO_LOOP;
+    if (to->isOptional && to->indirectionLevel() == 0) {
+      auto cast = Type::findCast(from, to->optionalTarget, false);
       if (cast.size() > 0) {
+        cast.insert(cast.end() - 1, CC(CCT::Wrap));
         AC_RETURN_INDEX;
         return cast;
       }
-    AC_TO_LOOP_END;
-    AC_TO_LOOP;
-      if (from->klass && from->pointerLevel() == 0) {
-        std::queue<std::vector<std::shared_ptr<Class>>> nextUp;
-        for (auto& parent: from->klass->parents) {
-          nextUp.push({ parent });
-        }
-        while (nextUp.size() > 0) {
-          auto curr = nextUp.front();
-          nextUp.pop();
-          for (auto& parent: curr.back()->parents) {
-            auto copy = curr;
-            copy.push_back(parent);
-            nextUp.push(copy);
-          }
-          auto cast = doFromOrToLoop(std::make_shared<Type>(curr.back()), to);
-          if (cast.size() > 0) {
-            for (auto& parent: curr) {
-              cast.insert(cast.begin(), CC(CCT::Upcast, parent));
-            }
-            AC_RETURN_INDEX;
-            return cast;
-          }
-        }
-      }
-    AC_TO_LOOP_END;
+    }
+  AC_TO_LOOP_END;
 
-    AC_TO_LOOP;
-      if (to->isOptional && to->indirectionLevel() == 0) {
-        auto cast = findCast(from, to->optionalTarget, false);
-        if (cast.size() > 0) {
-          cast.insert(cast.end() - 1, CC(CCT::Wrap));
-          AC_RETURN_INDEX;
-          return cast;
-        }
+  AC_TO_LOOP;
+    if (!from->isUnion() && to->isUnion() && to->indirectionLevel() == 0) {
+      size_t idx = 0;
+      auto manu = saveManual();
+      auto cast = loop(from, to->unionOf, &idx);
+      restoreManual(manu);
+      if (cast.size() > 0) {
+        cast.insert(cast.end() - 1, CC(CCT::Widen, to, to->unionOf[idx]));
       }
-    AC_TO_LOOP_END;
+      AC_RETURN_INDEX;
+      return cast;
+    }
+  AC_TO_LOOP_END;
 
-    AC_TO_LOOP;
-      if (!from->isUnion() && to->isUnion() && to->indirectionLevel() == 0) {
+  AC_TO_LOOP;
+    if (from->isUnion() && from->pointerLevel() == 0 && to->isUnion() && to->indirectionLevel() == 0) {
+      std::vector<std::pair<size_t, CastPath>> multicast;
+      for (size_t j = 0; j < from->unionOf.size(); ++j) {
         size_t idx = 0;
         auto manu = saveManual();
-        auto cast = loop(from, to->unionOf, &idx);
+        auto cast = loop(from->unionOf[j], to->unionOf, &idx);
         restoreManual(manu);
-        if (cast.size() > 0) {
-          cast.insert(cast.end() - 1, CC(CCT::Widen, to, to->unionOf[idx]));
+        if (cast.size() == 0) {
+          idx = SIZE_MAX;
         }
-        AC_RETURN_INDEX;
-        return cast;
+        multicast.emplace_back(idx, cast);
       }
-    AC_TO_LOOP_END;
+      auto tmp = CC(CCT::Multicast, multicast);
+      tmp.target = to;
+      return { tmp, CC(CCT::Destination) };
+    }
+  AC_TO_LOOP_END;
 
-    AC_TO_LOOP;
-      if (from->isUnion() && from->pointerLevel() == 0 && to->isUnion() && to->indirectionLevel() == 0) {
-        std::vector<std::pair<size_t, CastPath>> multicast;
-        for (size_t j = 0; j < from->unionOf.size(); ++j) {
-          size_t idx = 0;
-          auto manu = saveManual();
-          auto cast = loop(from->unionOf[j], to->unionOf, &idx);
-          restoreManual(manu);
-          if (cast.size() == 0) {
-            idx = SIZE_MAX;
-          }
-          multicast.emplace_back(idx, cast);
-        }
-        auto tmp = CC(CCT::Multicast, multicast);
-        tmp.target = to;
-        return { tmp, CC(CCT::Destination) };
-      }
-    AC_TO_LOOP_END;
+  AC_TO_LOOP;
+    if (
+      from->indirectionLevel() == 0 &&
+      to->indirectionLevel() == 0 &&
+      from->isNative &&
+      to->isNative &&
+      (
+        from->nativeTypeName == NT::Float ||
+        from->nativeTypeName == NT::Double
+      ) &&
+      (
+        to->nativeTypeName == NT::Float ||
+        to->nativeTypeName == NT::Double
+      )
+    ) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
+    }
+  AC_TO_LOOP_END;
 
-    AC_TO_LOOP;
-      if (
-        from->indirectionLevel() == 0 &&
-        to->indirectionLevel() == 0 &&
-        from->isNative &&
-        to->isNative &&
+  AC_TO_LOOP;
+    if (
+      from->indirectionLevel() == 0 &&
+      to->indirectionLevel() == 0 &&
+      from->isNative &&
+      to->isNative &&
+      (
         (
           from->nativeTypeName == NT::Float ||
           from->nativeTypeName == NT::Double
-        ) &&
+        ) ||
         (
           to->nativeTypeName == NT::Float ||
           to->nativeTypeName == NT::Double
         )
-      ) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
-      }
-    AC_TO_LOOP_END;
+      )
+    ) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
+    }
+  AC_TO_LOOP_END;
 
-    AC_TO_LOOP;
-      if (
-        from->indirectionLevel() == 0 &&
-        to->indirectionLevel() == 0 &&
-        from->isNative &&
-        to->isNative &&
-        (
-          (
-            from->nativeTypeName == NT::Float ||
-            from->nativeTypeName == NT::Double
-          ) ||
-          (
-            to->nativeTypeName == NT::Float ||
-            to->nativeTypeName == NT::Double
-          )
-        )
-      ) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
-      }
-    AC_TO_LOOP_END;
+  AC_TO_LOOP;
+    if (from->indirectionLevel() == 0 && to->indirectionLevel() == 0 && from->isNative && to->isNative && !from->isAny && !to->isAny) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
+    }
+  AC_TO_LOOP_END;
 
+  if (manual) {
     AC_TO_LOOP;
-      if (from->indirectionLevel() == 0 && to->indirectionLevel() == 0 && from->isNative && to->isNative && !from->isAny && !to->isAny) {
+      if (from->referenceLevel() == 0 && to->referenceLevel() == 0 && from->pointerLevel() > 0 && to->pointerLevel() > 0) {
         AC_RETURN_INDEX;
         return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
       }
     AC_TO_LOOP_END;
+  }
 
-    if (manual) {
-      AC_TO_LOOP;
-        if (from->referenceLevel() == 0 && to->referenceLevel() == 0 && from->pointerLevel() > 0 && to->pointerLevel() > 0) {
-          AC_RETURN_INDEX;
-          return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
-        }
-      AC_TO_LOOP_END;
+  AC_TO_LOOP;
+    if (
+      from->referenceLevel() == 0 &&
+      to->referenceLevel() == 0 &&
+      from->pointerLevel() > 0 &&
+      to->pointerLevel() == 0 &&
+      to->isNative &&
+      (
+        to->nativeTypeName == NT::Integer ||
+        to->nativeTypeName == NT::Byte ||
+        to->nativeTypeName == NT::UserDefined
+      )
+    ) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
     }
+  AC_TO_LOOP_END;
 
-    AC_TO_LOOP;
-      if (
-        from->referenceLevel() == 0 &&
-        to->referenceLevel() == 0 &&
-        from->pointerLevel() > 0 &&
-        to->pointerLevel() == 0 &&
-        to->isNative &&
-        (
-          to->nativeTypeName == NT::Integer ||
-          to->nativeTypeName == NT::Byte ||
-          to->nativeTypeName == NT::UserDefined
-        )
-      ) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
-      }
-    AC_TO_LOOP_END;
+  AC_TO_LOOP;
+    if (
+      from->referenceLevel() == 0 &&
+      to->referenceLevel() == 0 &&
+      from->pointerLevel() == 0 &&
+      to->pointerLevel() > 0 &&
+      from->isNative &&
+      (
+        from->nativeTypeName == NT::Integer ||
+        from->nativeTypeName == NT::Byte ||
+        from->nativeTypeName == NT::UserDefined
+      )
+    ) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
+    }
+  AC_TO_LOOP_END;
 
-    AC_TO_LOOP;
-      if (
-        from->referenceLevel() == 0 &&
-        to->referenceLevel() == 0 &&
-        from->pointerLevel() == 0 &&
-        to->pointerLevel() > 0 &&
-        from->isNative &&
-        (
-          from->nativeTypeName == NT::Integer ||
-          from->nativeTypeName == NT::Byte ||
-          from->nativeTypeName == NT::UserDefined
-        )
-      ) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
-      }
-    AC_TO_LOOP_END;
+  AC_TO_LOOP;
+    if (from->referenceLevel() == 0 && from->pointerLevel() > 0 && to->indirectionLevel() == 0 && to->isNative && to->nativeTypeName == NT::Bool) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::Destination, SCT::TestPointer) };
+    }
+  AC_TO_LOOP_END;
 
-    AC_TO_LOOP;
-      if (from->referenceLevel() == 0 && from->pointerLevel() > 0 && to->indirectionLevel() == 0 && to->isNative && to->nativeTypeName == NT::Bool) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::Destination, SCT::TestPointer) };
+  if (!dontLoopBack.top() && from->referenceLevel() > 0) {
+    dontLoopBack.push(true);
+    auto other = from->dereference();
+    while (other->referenceLevel() >= 0) {
+      auto cast = loop(other, tos, index);
+      if (cast.size() > 0) {
+        for (size_t i = other->referenceLevel(); i < from->referenceLevel(); ++i) {
+          cast.insert(cast.begin(), CC(CCT::Dereference));
+        }
+        dontLoopBack.pop();
+        return cast;
       }
-    AC_TO_LOOP_END;
+      if (other->referenceLevel() == 0) break;
+      other = other->dereference();
+    }
+    dontLoopBack.pop();
+  }
 
-    if (!dontLoopBack.top() && from->referenceLevel() > 0) {
-      dontLoopBack.push(true);
-      auto other = from->dereference();
-      while (other->referenceLevel() >= 0) {
-        auto cast = loop(other, tos, index);
-        if (cast.size() > 0) {
-          for (size_t i = other->referenceLevel(); i < from->referenceLevel(); ++i) {
-            cast.insert(cast.begin(), CC(CCT::Dereference));
+  size_t maxToRefLevel = 0;
+  AC_TO_LOOP;
+    if (to->referenceLevel() > maxToRefLevel) {
+      maxToRefLevel = to->referenceLevel();
+    }
+  AC_TO_LOOP_END;
+
+  if (!dontLoopBack.top() && from->referenceLevel() < maxToRefLevel) {
+    dontLoopBack.push(true);
+    auto cast = loop(from->reference(), tos, index);
+    if (cast.size() > 0) {
+      cast.insert(cast.begin(), CC(CCT::Reference));
+      dontLoopBack.pop();
+      return cast;
+    }
+    dontLoopBack.pop();
+  };
+
+  AC_TO_LOOP;
+    if (to->isAny && to->pointerLevel() == 0) {
+      AC_RETURN_INDEX;
+      return { CC(CCT::Destination) };
+    }
+  AC_TO_LOOP_END;
+
+  if (
+    manual &&
+    tos.size() == 1 &&
+    (
+      (from->isNative && tos.front()->isNative) ||
+      (from->pointerLevel() > 0 && tos.front()->pointerLevel() > 0) ||
+      (from->isNative && tos.front()->pointerLevel() > 0) ||
+      (from->pointerLevel() > 0 && tos.front()->isNative)
+    )
+  ) {
+    return { CC(CCT::SimpleCoercion, tos.front()), CC(CCT::Destination) };
+  }
+
+  if (index) *index = SIZE_MAX;
+  return {};
+
+  #undef AC_TO_LOOP
+  #undef AC_TO_LOOP_END
+  #undef AC_RETURN_INDEX
+};
+
+auto CastSearch::fromOrToUncached(std::shared_ptr<Type> from, std::shared_ptr<Type> to) -> CastPath {
+  // simple equality
+  if (*from == *to) {
+    return { CC(CCT::Destination) };
+  }
+  if (from->pointerLevel() == 1 && from->isAny && to->pointerLevel() == 1) {
+    return { CC(CCT::Destination) };
+  }
+
+  // basic iteration
+  AC_CAST_FROM_LOOP;
+    if (*special == *to || *special == *to->deconstify() || *special == *to->deconstify(true)) {
+      return { CC(CCT::To, method), CC(CCT::Destination) };
+    }
+  AC_CAST_FROM_LOOP_END;
+  AC_CAST_TO_LOOP;
+    if (*from == *special || *from == *special->deconstify() || *from == *special->deconstify(true)) {
+      return { CC(CCT::From, method), CC(CCT::Destination) };
+    }
+  AC_CAST_TO_LOOP_END;
+
+  // native iteration - floating-point
+  AC_CAST_FROM_LOOP;
+    if (
+      special->indirectionLevel() == 0 &&
+      to->indirectionLevel() == 0 &&
+      special->isNative &&
+      to->isNative &&
+      (
+        special->nativeTypeName == NT::Float ||
+        special->nativeTypeName == NT::Double
+      ) &&
+      (
+        to->nativeTypeName == NT::Float ||
+        to->nativeTypeName == NT::Double
+      )
+    ) {
+      return { CC(CCT::To, method), CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
+    }
+  AC_CAST_FROM_LOOP_END;
+  AC_CAST_TO_LOOP;
+    if (
+      from->indirectionLevel() == 0 &&
+      special->indirectionLevel() == 0 &&
+      from->isNative &&
+      special->isNative &&
+      (
+        from->nativeTypeName == NT::Float ||
+        from->nativeTypeName == NT::Double
+      ) &&
+      (
+        special->nativeTypeName == NT::Float ||
+        special->nativeTypeName == NT::Double
+      )
+    ) {
+      return { CC(CCT::SimpleCoercion, special), CC(CCT::From, method), CC(CCT::Destination) };
+    }
+  AC_CAST_TO_LOOP_END;
+
+  // native iteration
+  AC_CAST_FROM_LOOP;
+    if (special->indirectionLevel() == 0 && to->indirectionLevel() == 0 && special->isNative && to->isNative && !special->isAny && !to->isAny) {
+      return { CC(CCT::To, method), CC(CCT::SimpleCoercion, to), CC(CCT::Destination) };
+    }
+  AC_CAST_FROM_LOOP_END;
+  AC_CAST_TO_LOOP;
+    if (from->indirectionLevel() == 0 && special->indirectionLevel() == 0 && from->isNative && special->isNative && !from->isAny && !special->isAny) {
+      return { CC(CCT::SimpleCoercion, special), CC(CCT::From, method), CC(CCT::Destination) };
+    }
+  AC_CAST_TO_LOOP_END;
+
+  // child iteration
+  AC_CAST_FROM_LOOP;
+    if (special->indirectionLevel() > 0 && to->indirectionLevel() > 0 && special->referenceLevel() == to->referenceLevel() && special->klass && to->klass && to->klass->hasParent(special->klass)) {
+      return { CC(CCT::To, method), CC(CCT::Downcast, to->klass), CC(CCT::Destination) };
+    }
+  AC_CAST_FROM_LOOP_END;
+  AC_CAST_TO_LOOP;
+    if (from->indirectionLevel() > 0 && special->indirectionLevel() > 0 && from->referenceLevel() == special->referenceLevel() && from->klass && special->klass && special->klass->hasParent(from->klass)) {
+      return { CC(CCT::Downcast, special->klass), CC(CCT::From, method), CC(CCT::Destination) };
+    }
+  AC_CAST_TO_LOOP_END;
+
+  // parent iteration
+  AC_CAST_FROM_LOOP;
+    if (
+      (
+        (
+          (special->referenceLevel() <= 1 && to->referenceLevel() <= 1) ||
+          (special->pointerLevel() <= 1)
+        ) &&
+        (to->pointerLevel() == special->pointerLevel())
+      ) &&
+      special->klass &&
+      to->klass &&
+      special->klass->hasParent(to->klass)
+    ) {
+      auto accessorClass = special->klass;
+      CastPath cast;
+      cast.push_back(CC(CCT::To, method));
+      size_t i = 0;
+      while (i < accessorClass->parents.size()) {
+        auto& parent = accessorClass->parents[i];
+        if (parent->id == to->klass->id) {
+          cast.push_back(CC(CCT::Upcast, parent));
+          if (special->referenceLevel() > to->referenceLevel()) {
+            cast.push_back(CC(CCT::Dereference));
           }
-          dontLoopBack.pop();
-          return cast;
+          break;
         }
-        if (other->referenceLevel() == 0) break;
-        other = other->dereference();
+        if (parent->hasParent(to->klass)) {
+          cast.push_back(CC(CCT::Upcast, parent));
+          i = 0;
+          accessorClass = parent;
+          continue;
+        }
+        ++i;
       }
-      dontLoopBack.pop();
+      cast.push_back(CC(CCT::Destination));
+      return cast;
+    }
+  AC_CAST_FROM_LOOP_END;
+  AC_CAST_TO_LOOP;
+    if (
+      (
+        (
+          (from->referenceLevel() <= 1 && special->referenceLevel() <= 1) ||
+          (from->pointerLevel() <= 1)
+        ) &&
+        (special->pointerLevel() == from->pointerLevel())
+      ) &&
+      from->klass &&
+      special->klass &&
+      from->klass->hasParent(special->klass)
+    ) {
+      auto accessorClass = from->klass;
+      CastPath cast;
+      size_t i = 0;
+      while (i < accessorClass->parents.size()) {
+        auto& parent = accessorClass->parents[i];
+        if (parent->id == special->klass->id) {
+          cast.push_back(CC(CCT::Upcast, parent));
+          if (from->referenceLevel() > special->referenceLevel()) {
+            cast.push_back(CC(CCT::Dereference));
+          }
+          break;
+        }
+        if (parent->hasParent(special->klass)) {
+          cast.push_back(CC(CCT::Upcast, parent));
+          i = 0;
+          accessorClass = parent;
+          continue;
+        }
+        ++i;
+      }
+      cast.push_back(CC(CCT::From, method));
+      cast.push_back(CC(CCT::Destination));
+      return cast;
     }
+  AC_CAST_TO_LOOP_END;
 
+  // reference iteration
+  AC_CAST_FROM_LOOP;
     size_t maxToRefLevel = 0;
-    AC_TO_LOOP;
-      if (to->referenceLevel() > maxToRefLevel) {
-        maxToRefLevel = to->referenceLevel();
-      }
-    AC_TO_LOOP_END;
+    if (to->referenceLevel() > maxToRefLevel) {
+      maxToRefLevel = to->referenceLevel();
+    }
 
-    if (!dontLoopBack.top() && from->referenceLevel() < maxToRefLevel) {
-      dontLoopBack.push(true);
-      auto cast = loop(from->reference(), tos, index);
+    if (special->referenceLevel() < maxToRefLevel) {
+      auto cast = fromOrTo(special->reference(), to);
       if (cast.size() > 0) {
         cast.insert(cast.begin(), CC(CCT::Reference));
-        dontLoopBack.pop();
+        cast.insert(cast.begin(), CC(CCT::To, method));
         return cast;
       }
-      dontLoopBack.pop();
     };
+  AC_CAST_FROM_LOOP_END;
+  AC_CAST_TO_LOOP;
+    size_t maxToRefLevel = 0;
+    if (special->referenceLevel() > maxToRefLevel) {
+      maxToRefLevel = special->referenceLevel();
+    }
 
-    AC_TO_LOOP;
-      if (to->isAny && to->pointerLevel() == 0) {
-        AC_RETURN_INDEX;
-        return { CC(CCT::Destination) };
+    if (from->referenceLevel() < maxToRefLevel) {
+      auto cast = fromOrTo(from->reference(), special);
+      if (cast.size() > 0) {
+        cast.insert(cast.begin(), CC(CCT::Reference));
+        cast.insert(cast.end() - 1, CC(CCT::From, method));
+        return cast;
       }
-    AC_TO_LOOP_END;
+    };
+  AC_CAST_TO_LOOP_END;
 
-    if (
-      manual &&
-      tos.size() == 1 &&
-      (
-        (from->isNative && tos.front()->isNative) ||
-        (from->pointerLevel() > 0 && tos.front()->pointerLevel() > 0) ||
-        (from->isNative && tos.front()->pointerLevel() > 0) ||
-        (from->pointerLevel() > 0 && tos.front()->isNative)
-      )
-    ) {
-      return { CC(CCT::SimpleCoercion, tos.front()), CC(CCT::Destination) };
+  // union iteration
+  AC_CAST_FROM_LOOP;
+    if (!special->isUnion() && to->isUnion() && to->indirectionLevel() == 0) {
+      for (auto& otherTo: to->unionOf) {
+        auto cast = fromOrTo(special, otherTo);
+        if (cast.size() > 0) {
+          cast.insert(cast.begin(), CC(CCT::To, method));
+          cast.insert(cast.end() - 1, CC(CCT::Widen, to, otherTo));
+          return cast;
+        }
+      }
+    }
+  AC_CAST_FROM_LOOP_END;
+  AC_CAST_TO_LOOP;
+    if (!from->isUnion() && special->isUnion() && special->indirectionLevel() == 0) {
+      for (auto& otherTo: special->unionOf) {
+        auto cast = fromOrTo(from, otherTo);
+        if (cast.size() > 0) {
+          cast.insert(cast.end() - 1, CC(CCT::Widen, special, otherTo));
+          cast.insert(cast.end() - 1, CC(CCT::From, method));
+          return cast;
+        }
+      }
+    }
+  AC_CAST_TO_LOOP_END;
+
+  // recursive iteration
+  AC_CAST_FROM_LOOP;
+    auto cast = fromOrTo(special, to);
+    if (cast.size() > 0) {
+      cast.insert(cast.begin(), CC(CCT::To, method));
+      return cast;
+    }
+  AC_CAST_FROM_LOOP_END;
+  AC_CAST_TO_LOOP;
+    auto cast = fromOrTo(from, special);
+    if (cast.size() > 0) {
+      cast.insert(cast.end() - 1, CC(CCT::From, method));
+      return cast;
+    }
+  AC_CAST_TO_LOOP_END;
+
+  // parent from-to iteration
+  AC_CAST_FROM_LOOP;
+    if (special->klass) {
+      std::queue<std::vector<std::shared_ptr<Class>>> nextUp;
+      // a class that's already been queued was reached by a shorter path, so there's
+      // nothing new to find by going through it again (e.g. in diamond hierarchies)
+      std::unordered_set<std::string> queued;
+      for (auto& parent: special->klass->parents) {
+        if (!queued.insert(parent->id).second) continue;
+        nextUp.push({ parent });
+      }
+      while (nextUp.size() > 0) {
+        auto curr = nextUp.front();
+        nextUp.pop();
+        for (auto& parent: curr.back()->parents) {
+          if (!queued.insert(parent->id).second) continue;
+          auto copy = curr;
+          copy.push_back(parent);
+          nextUp.push(copy);
+        }
+        auto cast = fromOrTo(std::make_shared<Type>(curr.back()), to);
+        if (cast.size() > 0) {
+          for (auto& parent: curr) {
+            cast.insert(cast.begin(), CC(CCT::Upcast, parent));
+          }
+          return cast;
+        }
+      }
     }
+  AC_CAST_FROM_LOOP_END;
 
-    if (index) *index = SIZE_MAX;
-    return {};
+  return {};
+};
 
-    #undef AC_TO_LOOP
-    #undef AC_TO_LOOP_END
-    #undef AC_RETURN_INDEX
-  };
-  return loop(from, { to }, nullptr);
+#undef AC_CAST_FROM_LOOP
+#undef AC_CAST_FROM_LOOP_END
+#undef AC_CAST_TO_LOOP
+#undef AC_CAST_TO_LOOP_END
+
+auto AltaCore::DET::Type::findCastUncached(std::shared_ptr<Type> from, std::shared_ptr<Type> to, bool manual) -> CastPath {
+  CastSearch search(manual);
+  return search.loop(from, { to }, nullptr);
 };
 
-size_t AltaCore::DET::Type::compatiblity(const AltaCore::DET::Type& other) const {
+size_t AltaCore::DET::Type::compatiblityUncached(const AltaCore::DET::Type& other) const {
   if (other.isAccessor) return compatiblity(*other.returnType);
   size_t compat = SIZE_MAX - 5;
 
@@ -1548,30 +2147,10 @@ size_t AltaCore::DET::Type::compatiblity(const AltaCore::DET::Type& other) const
   if (isExactlyCompatibleWith(*other.deconstify())) return SIZE_MAX - 1;
   if (deconstify()->isExactlyCompatibleWith(other)) return SIZE_MAX - 2;
 
-  auto nonConstPtrTo = other.deconstify();
-  for (size_t i = 0; i < nonConstPtrTo->modifiers.size(); ++i) {
-    auto& mod = nonConstPtrTo->modifiers[i];
-    if (mod & (uint8_t)AltaCore::DET::TypeModifierFlag::Constant) {
-      mod &= ~((uint8_t)AltaCore::DET::TypeModifierFlag::Constant);
-    }
-    if (mod == 0) {
-      nonConstPtrTo->modifiers.erase(nonConstPtrTo->modifiers.begin() + i);
-      --i;
-    }
-  }
+  auto nonConstPtrTo = other.deconstify(true);
   if (isExactlyCompatibleWith(*nonConstPtrTo)) return SIZE_MAX - 3;
 
-  auto nonConstPtrFrom = deconstify();
-  for (size_t i = 0; i < nonConstPtrFrom->modifiers.size(); ++i) {
-    auto& mod = nonConstPtrFrom->modifiers[i];
-    if (mod & (uint8_t)AltaCore::DET::TypeModifierFlag::Constant) {
-      mod &= ~((uint8_t)AltaCore::DET::TypeModifierFlag::Constant);
-    }
-    if (mod == 0) {
-      nonConstPtrFrom->modifiers.erase(nonConstPtrFrom->modifiers.begin() + i);
-      --i;
-    }
-  }
+  auto nonConstPtrFrom = deconstify(true);
   if (nonConstPtrFrom->isExactlyCompatibleWith(other)) return SIZE_MAX - 4;
 
   if (other.pointerLevel() == 0 && other.klass) {
@@ -1603,17 +2182,8 @@ size_t AltaCore::DET::Type::compatiblity(const AltaCore::DET::Type& other) const
     compat -= 1;
   }
 
-  if (modifiers.size() == other.modifiers.size()) {
-    bool modsEqual = true;
-    for (size_t i = 0; i < modifiers.size(); i++) {
-      if (modifiers[i] != other.modifiers[i]) {
-        modsEqual = false;
-        break;
-      }
-    }
-    if (!modsEqual) {
-      compat -= 1;
-    }
+  if (modifiers.size() == other.modifiers.size() && modifiers != other.modifiers) {
+    compat -= 1;
   }
 
   if (isFunction) {
@@ -1755,7 +2325,7 @@ bool AltaCore::DET::Type::commonCompatiblity(const AltaCore::DET::Type& other, b
   return true;
 };
 
-bool AltaCore::DET::Type::isExactlyCompatibleWith(const AltaCore::DET::Type& other) const {
+bool AltaCore::DET::Type::isExactlyCompatibleWithUncached(const AltaCore::DET::Type& other) const {
   if (isAccessor != other.isAccessor) {
     if (other.isAccessor) return isExactlyCompatibleWith(*other.returnType);
     return returnType->isExactlyCompatibleWith(other);
@@ -1783,10 +2353,7 @@ bool AltaCore::DET::Type::isExactlyCompatibleWith(const AltaCore::DET::Type& oth
   }
 
   // here, we care about *exact* compatability, and that includes all modifiers
-  if (modifiers.size() != other.modifiers.size()) return false;
-  for (size_t i = 0; i < modifiers.size(); i++) {
-    if (modifiers[i] != other.modifiers[i]) return false;
-  }
+  if (modifiers != other.modifiers) return false;
 
   if (isFunction) {
     if (!returnType->isExactlyCompatibleWith(*other.returnType)) return false;
@@ -1804,7 +2371,47 @@ bool AltaCore::DET::Type::isExactlyCompatibleWith(const AltaCore::DET::Type& oth
   return true;
 };
 
-bool AltaCore::DET::Type::isCompatibleWith(const AltaCore::DET::Type& other) const {
+size_t AltaCore::DET::Type::exactCompatibilityHash() const {
+  auto combine = [](size_t seed, size_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+  };
+
+  // accessors are exactly compatible with whatever their return type is
+  if (isAccessor) return returnType->exactCompatibilityHash();
+  // never exactly compatible with anything
+  if (isAny) return 1;
+
+  size_t result = 2;
+  for (auto modifier: modifiers) {
+    result = combine(result, modifier);
+  }
+
+  if (isOptional) {
+    return combine(combine(result, 3), optionalTarget->exactCompatibilityHash());
+  }
+  if (isUnion()) {
+    // members can match up in any order (and not necessarily one-to-one), so only their number counts
+    return combine(combine(result, 4), unionOf.size());
+  }
+  if (isFunction) {
+    // parameters are left out, since a shorter parameter list can match a longer one
+    return combine(combine(combine(result, 5), returnType->exactCompatibilityHash()), isRawFunction);
+  }
+  if (isNative) {
+    return combine(combine(combine(result, 6), static_cast<size_t>(nativeTypeName)), std::hash<std::string>()(userDefinedName));
+  }
+  return combine(combine(result, 7), klass ? std::hash<std::string>()(klass->id) : 0);
+};
+
+size_t AltaCore::DET::Type::exactCompatibilityHash(const std::vector<std::shared_ptr<Type>>& types) {
+  size_t result = 17;
+  for (auto& type: types) {
+    result = result * 31 + type->exactCompatibilityHash();
+  }
+  return result;
+};
+
+bool AltaCore::DET::Type::isCompatibleWithUncached(const AltaCore::DET::Type& other) const {
   if (other.isAccessor) return isCompatibleWith(*other.returnType);
   if (other.referenceLevel() > 0) return isCompatibleWith(*other.destroyReferences());
   if (referenceLevel() > 0) return destroyReferences()->isCompatibleWith(other);
@@ -5,6 +5,8 @@
 #include <locale>
 #include <codecvt>
 #include <filesystem>
+#include <mutex>
+#include "../include/altacore/simple-map.hpp"
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <windows.h>
@@ -20,19 +22,157 @@
 #include <string.h>
 #endif
 
-bool AltaCore::Filesystem::exists(AltaCore::Filesystem::Path path) {
+namespace {
+  using AltaCore::Filesystem::StatCache;
+
+  std::string currentDirectory() {
+#if defined(_WIN32) || defined(_WIN64)
+    auto requiredBufferLength = GetCurrentDirectory(0, NULL);
+    auto buf = std::make_unique<char[]>(requiredBufferLength);
+    GetCurrentDirectory(requiredBufferLength, buf.get());
+    return std::string(buf.get());
+#else
+    char tmp[MAXPATHLEN] = {0};
+    return (getcwd(tmp, MAXPATHLEN) ? std::string(tmp) : std::string());
+#endif
+  };
+
+  StatCache::Entry statPath(const std::string& path) {
+    // sure, Windows has regular ol' `stat`, too,
+    // but Windows c++ api documentation recommends
+    // `_stat` instead. it's fully compatible with
+    // stat for our purposes here so ¯\_(ツ)_/¯
+#if defined(_WIN32) || defined(_WIN64)
+    const auto statFunc = _stat;
+    typedef struct _stat statStruct;
+#else
+    const auto statFunc = stat;
+    typedef struct stat statStruct;
+#endif
+
+    StatCache::Entry entry;
+    statStruct buf;
+    if (statFunc(path.c_str(), &buf) != 0) return entry;
+
+    entry.exists = true;
+    entry.isDirectory = buf.st_mode & S_IFDIR;
+    // use nanosecond precision where we can get it, so that quick successive edits are still noticed
 #if defined(_WIN32) || defined(_WIN64)
-  const auto statFunc = _stat;
-  typedef struct _stat statStruct;
+    entry.modificationTime = static_cast<int64_t>(buf.st_mtime) * 1000000000;
+#elif defined(__APPLE__)
+    entry.modificationTime = static_cast<int64_t>(buf.st_mtimespec.tv_sec) * 1000000000 + buf.st_mtimespec.tv_nsec;
 #else
-  const auto statFunc = stat;
-  typedef struct stat statStruct;
+    entry.modificationTime = static_cast<int64_t>(buf.st_mtim.tv_sec) * 1000000000 + buf.st_mtim.tv_nsec;
 #endif
+    return entry;
+  };
+
+  struct StatCacheState {
+    std::mutex mutex;
+    bool hasCwd = false;
+    std::string cwd;
+    AltaCore::Filesystem::Path cwdPath;
+    ALTACORE_MAP<std::string, StatCache::Entry> entries;
+    StatCache::Statistics statistics;
+  };
+
+  StatCacheState& statCache() {
+    static StatCacheState state;
+    return state;
+  };
+
+  // expects the lock to be held
+  const AltaCore::Filesystem::Path& cachedCwdPath(StatCacheState& state) {
+    if (!state.hasCwd) {
+      state.cwd = currentDirectory();
+      state.cwdPath = AltaCore::Filesystem::Path(state.cwd);
+      state.hasCwd = true;
+    }
+    return state.cwdPath;
+  };
+
+  // expects the lock to be held
+  std::string cacheKey(StatCacheState& state, const AltaCore::Filesystem::Path& path) {
+    // absolute paths don't need the cwd (and `absolutify` doesn't normalize them)
+    return (path.isAbsolute() ? path.normalize() : path.absolutify(cachedCwdPath(state))).toString();
+  };
+};
+
+bool AltaCore::Filesystem::StatCache::enabled = true;
+
+std::string AltaCore::Filesystem::StatCache::cwd() {
+  if (!enabled) return currentDirectory();
+  auto& state = statCache();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  cachedCwdPath(state);
+  return state.cwd;
+};
+
+auto AltaCore::Filesystem::StatCache::lookup(const Path& path) -> Entry {
+  if (!enabled) return statPath(path.absolutify().toString());
+  auto& state = statCache();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  auto key = cacheKey(state, path);
+  auto it = state.entries.find(key);
+  if (it != state.entries.end()) {
+    ++state.statistics.hits;
+    return it->second;
+  }
+  ++state.statistics.misses;
+  auto entry = statPath(key);
+  state.entries[key] = entry;
+  return entry;
+};
+
+auto AltaCore::Filesystem::StatCache::refresh(const Path& path) -> Entry {
+  if (!enabled) return statPath(path.absolutify().toString());
+  auto& state = statCache();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  auto key = cacheKey(state, path);
+  ++state.statistics.misses;
+  auto entry = statPath(key);
+  state.entries[key] = entry;
+  return entry;
+};
+
+void AltaCore::Filesystem::StatCache::invalidate() {
+  auto& state = statCache();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.hasCwd = false;
+  state.entries.clear();
+  ++state.statistics.invalidations;
+};
+
+void AltaCore::Filesystem::StatCache::invalidate(const Path& path) {
+  auto& state = statCache();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  auto key = cacheKey(state, path);
+  // (roots already end with a separator)
+  auto prefix = (!key.empty() && key.back() == platformSeparator) ? key : key + platformSeparator;
+  for (auto it = state.entries.begin(); it != state.entries.end();) {
+    if (it->first == key || it->first.compare(0, prefix.size(), prefix) == 0) {
+      it = state.entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  ++state.statistics.invalidations;
+};
 
-  auto str = path.absolutify().toString();
-  auto cstrPath = str.c_str();
-  statStruct buf;
-  return (statFunc(cstrPath, &buf) == 0);
+auto AltaCore::Filesystem::StatCache::statistics() -> Statistics {
+  auto& state = statCache();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  return state.statistics;
+};
+
+void AltaCore::Filesystem::StatCache::resetStatistics() {
+  auto& state = statCache();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.statistics = Statistics();
+};
+
+bool AltaCore::Filesystem::exists(AltaCore::Filesystem::Path path) {
+  return StatCache::lookup(path).exists;
 };
 
 bool AltaCore::Filesystem::mkdirp(AltaCore::Filesystem::Path path) {
@@ -40,10 +180,12 @@ bool AltaCore::Filesystem::mkdirp(AltaCore::Filesystem::Path path) {
   // backwards and until we reach the first existent path (or a root)
   // and then create recursively starting there
   // but ¯\_(ツ)_/¯
-  auto refPath = path.absolutify();
-  path.components.clear();
-  for (auto& component: refPath.components) {
-    path.push(component);
+  std::vector<Path> parents;
+  for (auto parent = path.absolutify(); parent.hasComponents(); parent = parent.dirname()) {
+    parents.push_back(parent);
+  }
+  for (auto it = parents.rbegin(); it != parents.rend(); ++it) {
+    auto& path = *it;
     if (!path.exists()) {
 #if defined(_WIN32) || defined(_WIN64)
       const auto mkdirFunc = _mkdir;
@@ -52,6 +194,7 @@ bool AltaCore::Filesystem::mkdirp(AltaCore::Filesystem::Path path) {
 #endif
       auto str = path.toString();
       auto ok = mkdirFunc(str.c_str()) == 0;
+      StatCache::invalidate(path);
       // we already checked for existence, but
       // just in case, let's make sure that wasn't the error
       if (!ok && errno != EEXIST) return false;
@@ -61,15 +204,7 @@ bool AltaCore::Filesystem::mkdirp(AltaCore::Filesystem::Path path) {
 };
 
 std::string AltaCore::Filesystem::cwd() {
-#if defined(_WIN32) || defined(_WIN64)
-  auto requiredBufferLength = GetCurrentDirectory(0, NULL);
-  auto buf = std::make_unique<char[]>(requiredBufferLength);
-  GetCurrentDirectory(requiredBufferLength, buf.get());
-  return std::string(buf.get());
-#else
-  char tmp[MAXPATHLEN] = {0};
-  return (getcwd(tmp, MAXPATHLEN) ? std::string(tmp) : std::string());
-#endif
+  return StatCache::cwd();
 };
 
 void AltaCore::Filesystem::copyFile(AltaCore::Filesystem::Path source, AltaCore::Filesystem::Path destination) {
@@ -78,6 +213,9 @@ void AltaCore::Filesystem::copyFile(AltaCore::Filesystem::Path source, AltaCore:
 
   // thank you, Martin York! see https://stackoverflow.com/a/10195497
   destinationStream << sourceStream.rdbuf();
+  destinationStream.close();
+
+  StatCache::invalidate(destination);
 };
 
 std::vector<AltaCore::Filesystem::Path> AltaCore::Filesystem::getDirectoryListing(AltaCore::Filesystem::Path directory, bool recursive) {
@@ -111,30 +249,62 @@ void AltaCore::Filesystem::copyDirectory(AltaCore::Filesystem::Path source, Alta
   }
 };
 
+namespace {
+  size_t hashRoot(bool hasRoot, std::string_view root) {
+    // effective hasing method according to
+    // https://stackoverflow.com/a/17017281
+    size_t res = 17;
+    res = (res * 31) + std::hash<bool>()(hasRoot);
+    res = (res * 31) + std::hash<std::string_view>()(root);
+    return res;
+  };
+};
+
 AltaCore::Filesystem::Path::Path() {};
+AltaCore::Filesystem::Path::Path(std::string path) {
+  static const std::string_view defaultSeparators[] = { "/", "\\" };
+  parse(path, defaultSeparators, 2);
+};
 AltaCore::Filesystem::Path::Path(std::string path, std::vector<std::string> separators) {
-  std::vector<size_t> separatorLengths;
+  std::vector<std::string_view> views(separators.begin(), separators.end());
+  parse(path, views.data(), views.size());
+};
+AltaCore::Filesystem::Path::Path(std::string path, std::string separator) {
+  std::string_view view = separator;
+  parse(path, &view, 1);
+};
+
+void AltaCore::Filesystem::Path::parse(std::string_view path, const std::string_view* separators, size_t separatorCount) {
   size_t startOfLatestComponent = 0;
   size_t endOfLatestComponent = 0;
   bool hasContent = false;
+  bool isFirst = true;
 
-  for (auto& separator: separators) {
-    separatorLengths.push_back(separator.length());
-  }
+  // the first component decides whether we have a root
+  auto add = [&](std::string_view component) {
+    if (isFirst) {
+      isFirst = false;
+      if (component.empty() || component.back() == ':') {
+        setRoot(component);
+        return;
+      }
+    }
+    append(component);
+  };
 
   for (size_t i = 0; i < path.length(); i++) {
     bool found = false;
-    for (size_t j = 0; j < separators.size(); j++) {
+    for (size_t j = 0; j < separatorCount; j++) {
       auto& separator = separators[j];
-      auto& separatorLength = separatorLengths[j];
+      auto separatorLength = separator.length();
       bool ok = false;
       if (path[i] == separator[0]) {
         for (size_t j = i, k = 1; j < path.length(); j++, k++) {
           if (k >= separatorLength) {
             if (hasContent) {
-              components.push_back(path.substr(startOfLatestComponent, endOfLatestComponent - startOfLatestComponent + 1));
+              add(path.substr(startOfLatestComponent, endOfLatestComponent - startOfLatestComponent + 1));
             } else {
-              components.push_back(std::string());
+              add(std::string_view());
             }
             i = j;
             startOfLatestComponent = i + 1;
@@ -158,56 +328,122 @@ AltaCore::Filesystem::Path::Path(std::string path, std::vector<std::string> sepa
   }
 
   if (hasContent) {
-    components.push_back(path.substr(startOfLatestComponent, endOfLatestComponent - startOfLatestComponent + 1));
+    add(path.substr(startOfLatestComponent, endOfLatestComponent - startOfLatestComponent + 1));
   }
+};
 
-  if (components.size() > 0) {
-    if (components[0] == "") {
-      hasRoot = true;
-      root = "";
-      components.erase(components.begin());
-    } else if (components[0][components[0].length() - 1] == ':') {
-      hasRoot = true;
-      root = components[0];
-      components.erase(components.begin());
-    }
+auto AltaCore::Filesystem::Path::own() -> Data& {
+  if (!data) {
+    data = std::make_shared<Data>();
+    data->rootHash = hashRoot(false, std::string_view());
+  } else if (data.use_count() > 1) {
+    auto copy = std::make_shared<Data>();
+    copy->text = data->text.substr(0, end());
+    copy->hasRoot = data->hasRoot;
+    copy->rootLength = data->rootLength;
+    copy->rootHash = data->rootHash;
+    copy->components.assign(data->components.begin(), data->components.begin() + count);
+    data = std::move(copy);
+  } else if (count < data->components.size()) {
+    // nobody else is using the rest of the buffer, so we can just drop it
+    data->text.resize(end());
+    data->components.resize(count);
+  }
+  return *data;
+};
+
+void AltaCore::Filesystem::Path::setRoot(std::string_view root) {
+  // only ever used on paths without any components
+  auto& self = own();
+  self.text.assign(root.data(), root.size());
+  self.text += platformSeparator;
+  self.hasRoot = true;
+  self.rootLength = root.size();
+  self.rootHash = hashRoot(true, root);
+};
+
+void AltaCore::Filesystem::Path::append(std::string_view component) {
+  auto& self = own();
+  if (count > 0) {
+    self.text += platformSeparator;
+  }
+  auto previousHash = (count > 0) ? self.components.back().hash : self.rootHash;
+  Component entry;
+  entry.start = self.text.size();
+  self.text.append(component.data(), component.size());
+  entry.end = self.text.size();
+  entry.hash = (previousHash * 31) + std::hash<std::string_view>()(component);
+  self.components.push_back(entry);
+  ++count;
+};
+
+size_t AltaCore::Filesystem::Path::end() const {
+  if (!data) return 0;
+  if (count > 0) return data->components[count - 1].end;
+  return data->hasRoot ? data->rootLength + 1 : 0;
+};
+
+size_t AltaCore::Filesystem::Path::hash() const {
+  if (!data) return hashRoot(false, std::string_view());
+  return (count > 0) ? data->components[count - 1].hash : data->rootHash;
+};
+
+std::string_view AltaCore::Filesystem::Path::root() const {
+  if (!data) return std::string_view();
+  return std::string_view(data->text).substr(0, data->rootLength);
+};
+
+size_t AltaCore::Filesystem::Path::componentCount() const {
+  return count;
+};
+
+std::string_view AltaCore::Filesystem::Path::component(size_t index) const {
+  auto& entry = data->components[index];
+  return std::string_view(data->text).substr(entry.start, entry.end - entry.start);
+};
+
+std::vector<std::string> AltaCore::Filesystem::Path::components() const {
+  std::vector<std::string> result;
+  result.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    result.emplace_back(component(i));
   }
+  return result;
 };
-AltaCore::Filesystem::Path::Path(std::string _path, std::string _separator):
-  AltaCore::Filesystem::Path::Path(_path, std::vector<std::string> { _separator })
-  {};
 
 void AltaCore::Filesystem::Path::absolutifyInPlace(AltaCore::Filesystem::Path relativeTo) {
   // btw, we're free to modify `relativeTo` directly, since it's passed in by value
-  if (hasRoot) return;
-  for (auto& component: components) {
+  if (isAbsolute()) return;
+  for (size_t i = 0; i < count; i++) {
+    auto component = this->component(i);
     if (component == ".") {
       // ignore
     } else if (component == "..") {
-      if (relativeTo.components.size() > 0) {
-        relativeTo.components.pop_back();
+      if (relativeTo.count > 0) {
+        relativeTo.count--;
       }
     } else if (!component.empty()) {
-      relativeTo.components.push_back(component);
+      relativeTo.append(component);
     }
   }
-  hasRoot = relativeTo.hasRoot;
-  root = relativeTo.root;
-  components = relativeTo.components;
+  *this = std::move(relativeTo);
 };
 
 AltaCore::Filesystem::Path AltaCore::Filesystem::Path::normalize() const {
-  auto newPath = Path(*this);
-  newPath.components.clear();
-  for (auto& component: components) {
+  Path newPath;
+  if (isAbsolute()) {
+    newPath.setRoot(root());
+  }
+  for (size_t i = 0; i < count; i++) {
+    auto component = this->component(i);
     if (component == ".") {
       // ignore
     } else if (component == "..") {
-      if (newPath.components.size() > 0) {
-        newPath.components.pop_back();
+      if (newPath.count > 0) {
+        newPath.count--;
       }
     } else if (!component.empty()) {
-      newPath.components.push_back(component);
+      newPath.append(component);
     }
   }
   return newPath;
@@ -216,47 +452,58 @@ AltaCore::Filesystem::Path AltaCore::Filesystem::Path::normalize() const {
 AltaCore::Filesystem::Path AltaCore::Filesystem::Path::absolutify(AltaCore::Filesystem::Path relativeTo) const {
   // btw, we're free to modify `relativeTo` directly, since it's passed in by value
   auto newPath = Path(*this);
-  newPath.absolutifyInPlace(relativeTo);
+  newPath.absolutifyInPlace(std::move(relativeTo));
   return newPath;
 };
 AltaCore::Filesystem::Path AltaCore::Filesystem::Path::absolutify(std::string relativeTo) const {
   return absolutify(Path(relativeTo));
 };
+AltaCore::Filesystem::Path AltaCore::Filesystem::Path::absolutify() const {
+  // absolute paths don't need the cwd at all
+  if (isAbsolute()) return *this;
+  return absolutify(Path(cwd()));
+};
 
 AltaCore::Filesystem::Path AltaCore::Filesystem::Path::relativeTo(AltaCore::Filesystem::Path other) const {
-  auto newPath = absolutify();
+  auto self = absolutify();
   other = other.absolutify();
-  while (newPath.components.size() > 0 && other.components.size() > 0 && newPath.components[0] == other.components[0]) {
-    newPath.shift();
-    other.shift();
+  size_t common = 0;
+  while (common < self.count && common < other.count && self.component(common) == other.component(common)) {
+    common++;
   }
-  if (other.components.size() > 0) {
-    other.shift();
+  // the last component of `other` is its basename, so it doesn't count
+  auto parents = (other.count > common) ? other.count - common - 1 : 0;
+  Path newPath;
+  for (size_t i = 0; i < parents; i++) {
+    newPath.append("..");
   }
-  for (auto& component: other.components) {
-    newPath.unshift("..");
+  for (size_t i = common; i < self.count; i++) {
+    newPath.append(self.component(i));
   }
-  newPath.hasRoot = false;
-  newPath.root = "";
   return newPath;
 };
 
 std::string AltaCore::Filesystem::Path::toString(std::string separator) const {
+  if (separator.size() == 1 && separator[0] == platformSeparator) {
+    if (!data) return std::string();
+    return data->text.substr(0, end());
+  }
+
   std::string result;
 
-  if (hasRoot) {
-    result += root;
+  if (isAbsolute()) {
+    result += root();
     result += separator;
   }
 
   bool isFirst = true;
-  for (auto& component: components) {
+  for (size_t i = 0; i < count; i++) {
     if (isFirst) {
       isFirst = false;
     } else {
       result += separator;
     }
-    result += component;
+    result += component(i);
   }
 
   return result;
@@ -267,125 +514,117 @@ std::string AltaCore::Filesystem::Path::toString(char separator) const {
 
 std::string AltaCore::Filesystem::Path::basename() const {
   if (!hasComponents()) return "";
-  auto size = components.size();
-  if (size < 1) return "";
-  return components[size - 1];
+  return std::string(component(count - 1));
 };
 
 std::string AltaCore::Filesystem::Path::filename() const {
   if (!hasComponents()) return "";
-  auto base = basename();
+  auto base = component(count - 1);
   auto pos = base.find_last_of('.');
-  if (pos == std::string::npos) return base;
-  return base.substr(0, pos);
+  if (pos == std::string::npos) return std::string(base);
+  return std::string(base.substr(0, pos));
 };
 
 AltaCore::Filesystem::Path AltaCore::Filesystem::Path::dirname() const {
   if (!hasComponents()) return Path();
   auto newPath = Path(*this);
-  newPath.components.pop_back();
+  newPath.count--;
   return newPath;
 };
 
 std::string AltaCore::Filesystem::Path::extname() const {
   if (!hasComponents()) return "";
-  auto base = basename();
-  return base.substr(base.find_last_of('.') + 1); // doesn't include the '.'
+  auto base = component(count - 1);
+  return std::string(base.substr(base.find_last_of('.') + 1)); // doesn't include the '.'
 };
 
 AltaCore::Filesystem::Path AltaCore::Filesystem::Path::uproot() const {
-  auto newPath = Path(*this);
-  newPath.hasRoot = false;
-  newPath.root = "";
+  if (!isAbsolute()) return *this;
+  Path newPath;
+  for (size_t i = 0; i < count; i++) {
+    newPath.append(component(i));
+  }
   return newPath;
 };
 
 void AltaCore::Filesystem::Path::push(std::string component) {
   if (component.empty()) return;
-  return components.push_back(component);
+  append(component);
 };
 std::string AltaCore::Filesystem::Path::pop() {
   if (!hasComponents()) return "";
-  auto component = components[components.size() - 1];
-  components.pop_back();
+  auto component = std::string(this->component(count - 1));
+  count--;
   return component;
 };
 void AltaCore::Filesystem::Path::unshift(std::string component) {
   if (component.empty()) return;
-  components.insert(components.begin(), component);
+  Path newPath;
+  if (isAbsolute()) {
+    newPath.setRoot(root());
+  }
+  newPath.append(component);
+  for (size_t i = 0; i < count; i++) {
+    newPath.append(this->component(i));
+  }
+  *this = std::move(newPath);
 };
 std::string AltaCore::Filesystem::Path::shift() {
   if (!hasComponents()) return "";
-  auto component = components[0];
-  components.erase(components.begin());
+  auto component = std::string(this->component(0));
+  Path newPath;
+  if (isAbsolute()) {
+    newPath.setRoot(root());
+  }
+  for (size_t i = 1; i < count; i++) {
+    newPath.append(this->component(i));
+  }
+  *this = std::move(newPath);
   return component;
 };
 
 bool AltaCore::Filesystem::Path::isValid() const {
-  return (hasRoot || components.size() > 0);
+  return (isAbsolute() || count > 0);
 };
 bool AltaCore::Filesystem::Path::isEmpty() const {
   return !isValid();
 };
 bool AltaCore::Filesystem::Path::isRoot() const {
-  return (hasRoot && components.size() == 0);
+  return (isAbsolute() && count == 0);
 };
 bool AltaCore::Filesystem::Path::hasComponents() const {
-  return components.size() > 0;
+  return count > 0;
 };
 bool AltaCore::Filesystem::Path::exists() const {
   if (!isValid()) return false;
-
-  // sure, Windows has regular ol' `stat`, too,
-  // but Windows c++ api documentation recommends
-  // `_stat` instead. it's fully compatible with
-  // stat for our purposes here so ¯\_(ツ)_/¯
-#if defined(_WIN32) || defined(_WIN64)
-  const auto statFunc = _stat;
-  typedef struct _stat statStruct;
-#else
-  const auto statFunc = stat;
-  typedef struct stat statStruct;
-#endif
-
-  auto path = absolutify().toString();
-  auto cstrPath = path.c_str();
-  statStruct buf;
-  return (statFunc(cstrPath, &buf) == 0);
+  return StatCache::lookup(*this).exists;
 };
 bool AltaCore::Filesystem::Path::isDirectory() const {
-  // see `Path().exists` for the rationale for using `_stat` instead of `stat` on Windows
-#if defined(_WIN32) || defined(_WIN64)
-  const auto statFunc = _stat;
-  typedef struct _stat statStruct;
-#else
-  const auto statFunc = stat;
-  typedef struct stat statStruct;
-#endif
-
-  auto path = absolutify().toString();
-  auto cstrPath = path.c_str();
-  statStruct buf;
-  if (statFunc(cstrPath, &buf) != 0) return false;
-  return buf.st_mode & S_IFDIR;
+  return StatCache::lookup(*this).isDirectory;
 };
 bool AltaCore::Filesystem::Path::isAbsolute() const {
-  return hasRoot;
+  return data && data->hasRoot;
+};
+int64_t AltaCore::Filesystem::Path::modificationTime() const {
+  return StatCache::lookup(*this).modificationTime;
 };
 
 bool AltaCore::Filesystem::Path::hasParentDirectory(const AltaCore::Filesystem::Path& other) const {
-  if (hasRoot != other.hasRoot) return false;
-  if (root != other.root) return false;
-  if (other.components.size() > components.size()) return false;
-  for (size_t i = 0; i < other.components.size(); i++) {
-    if (other.components[i] != components[i]) return false;
-  }
-  return true;
+  if (isAbsolute() != other.isAbsolute()) return false;
+  if (root() != other.root()) return false;
+  if (other.count > count) return false;
+  if (data == other.data) return true;
+  // `other` is a parent iff our prefix of the same length is the same path
+  auto prefix = Path(*this);
+  prefix.count = other.count;
+  return prefix == other;
 };
 
 AltaCore::Filesystem::Path AltaCore::Filesystem::Path::operator /(const AltaCore::Filesystem::Path& rhs) const {
   auto newPath = Path(*this);
-  newPath.components.insert(newPath.components.end(), rhs.components.begin(), rhs.components.end());
+  for (size_t i = 0; i < rhs.count; i++) {
+    newPath.append(rhs.component(i));
+  }
   return newPath;
 };
 
@@ -396,20 +635,23 @@ AltaCore::Filesystem::Path AltaCore::Filesystem::Path::operator /(const std::str
 AltaCore::Filesystem::Path AltaCore::Filesystem::Path::operator +(const std::string& rhs) const {
   auto newPath = Path(*this);
   if (!newPath.hasComponents()) {
-    newPath.components.push_back(rhs);
+    newPath.append(rhs);
   } else {
-    auto& base = newPath.components[newPath.components.size() - 1];
-    base += rhs;
+    auto base = std::string(component(count - 1)) + rhs;
+    newPath.count--;
+    newPath.append(base);
   }
   return newPath;
 };
 
 bool AltaCore::Filesystem::Path::operator ==(const AltaCore::Filesystem::Path& rhs) const {
-  if (hasRoot != rhs.hasRoot) return false;
-  if (root != rhs.root) return false;
-  if (components.size() != rhs.components.size()) return false;
-  for (size_t i = 0; i < rhs.components.size(); i++) {
-    if (components[i] != rhs.components[i]) return false;
+  if (count != rhs.count) return false;
+  if (isAbsolute() != rhs.isAbsolute()) return false;
+  if (data == rhs.data) return true;
+  if (hash() != rhs.hash()) return false;
+  if (root() != rhs.root()) return false;
+  for (size_t i = 0; i < count; i++) {
+    if (component(i) != rhs.component(i)) return false;
   }
   return true;
 };
@@ -419,21 +661,18 @@ AltaCore::Filesystem::Path::operator bool() const {
 };
 
 bool AltaCore::Filesystem::Path::operator <(const AltaCore::Filesystem::Path& rhs) const {
-  if (hasRoot != rhs.hasRoot && hasRoot) return false;
+  if (isAbsolute() != rhs.isAbsolute() && isAbsolute()) return false;
 
-  if (hasRoot) {
-    auto comp = root.compare(rhs.root);
+  if (isAbsolute()) {
+    auto comp = root().compare(rhs.root());
     if (comp < 0) return true;
     if (comp > 0) return false;
   }
 
-  if (components.size() > rhs.components.size()) return false;
+  if (count > rhs.count) return false;
 
-  for (size_t i = 0; i < components.size(); i++) {
-    auto& comp1 = components[i];
-    auto& comp2 = rhs.components[i];
-
-    auto comparison = comp1.compare(comp2);
+  for (size_t i = 0; i < count; i++) {
+    auto comparison = component(i).compare(rhs.component(i));
     if (comparison < 0) return true;
     if (comparison > 0) return false;
   }
@@ -445,13 +684,6 @@ bool AltaCore::Filesystem::Path::operator <(const AltaCore::Filesystem::Path& rh
 // create a `std::hash` specialization to allow `AltaCore::Filesystem::Path`s
 // to be used as keys in `std::unordered_map`s
 std::size_t std::hash<AltaCore::Filesystem::Path>::operator()(const AltaCore::Filesystem::Path& path) const {
-  // effective hasing method according to
-  // https://stackoverflow.com/a/17017281
-  size_t res = 17;
-  res = (res * 31) + hash<bool>()(path.hasRoot);
-  res = (res * 31) + hash<std::string>()(path.root);
-  for (auto& component: path.components) {
-    res = (res * 31) + hash<std::string>()(component);
-  }
-  return res;
+  // every prefix's hash is computed as the path is built
+  return path.hash();
 };
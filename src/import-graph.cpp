@@ -0,0 +1,314 @@
+#include "../include/altacore/import-graph.hpp"
+#include "../include/altacore/modules.hpp"
+#include "../include/altacore/ast/root-node.hpp"
+#include "../include/altacore/ast/import-statement.hpp"
+#include "../include/altacore/ast/export-statement.hpp"
+#include "../include/altacore/det/module.hpp"
+#include "../include/altacore/detail-handles.hpp"
+#include "../include/altacore/simple-map.hpp"
+#include "../include/altacore/concurrency.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace {
+  using AltaCore::Modules::ImportGraph;
+
+  void addDependency(ImportGraph::Node& node, size_t dependency) {
+    if (std::find(node.dependencies.begin(), node.dependencies.end(), dependency) == node.dependencies.end()) {
+      node.dependencies.push_back(dependency);
+    }
+  };
+
+  /**
+   * Tarjan's algorithm, with an explicit stack so that long import chains can't overflow the native one
+   *
+   * Tarjan's algorithm finishes a component only after every component reachable from it,
+   * so the components come out dependencies-first.
+   */
+  void findComponents(ImportGraph& graph) {
+    const size_t unvisited = SIZE_MAX;
+    auto count = graph.nodes.size();
+    std::vector<size_t> order(count, unvisited);
+    std::vector<size_t> lowLink(count, 0);
+    std::vector<bool> onStack(count, false);
+    std::vector<size_t> stack;
+    size_t nextOrder = 0;
+
+    struct Frame {
+      size_t node;
+      size_t next;
+    };
+    std::vector<Frame> frames;
+
+    for (size_t start = 0; start < count; start++) {
+      if (order[start] != unvisited) continue;
+
+      auto enter = [&](size_t node) {
+        order[node] = lowLink[node] = nextOrder++;
+        stack.push_back(node);
+        onStack[node] = true;
+        frames.push_back(Frame { node, 0 });
+      };
+      enter(start);
+
+      while (frames.size() > 0) {
+        auto node = frames.back().node;
+        auto& dependencies = graph.nodes[node].dependencies;
+
+        if (frames.back().next < dependencies.size()) {
+          auto dependency = dependencies[frames.back().next++];
+          if (order[dependency] == unvisited) {
+            // careful: `enter` invalidates references into `frames`
+            enter(dependency);
+          } else if (onStack[dependency]) {
+            lowLink[node] = std::min(lowLink[node], order[dependency]);
+          }
+          continue;
+        }
+
+        frames.pop_back();
+        if (frames.size() > 0) {
+          auto parent = frames.back().node;
+          lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+        }
+
+        if (lowLink[node] != order[node]) continue;
+
+        ImportGraph::Component component;
+        size_t member;
+        do {
+          member = stack.back();
+          stack.pop_back();
+          onStack[member] = false;
+          graph.nodes[member].component = graph.components.size();
+          component.members.push_back(member);
+        } while (member != node);
+        std::sort(component.members.begin(), component.members.end(), [&](size_t lhs, size_t rhs) {
+          return order[lhs] < order[rhs];
+        });
+        graph.components.push_back(std::move(component));
+      }
+    }
+
+    for (size_t i = 0; i < graph.components.size(); i++) {
+      auto& component = graph.components[i];
+      for (auto member: component.members) {
+        for (auto dependency: graph.nodes[member].dependencies) {
+          auto target = graph.nodes[dependency].component;
+          if (target == i) continue;
+          if (std::find(component.dependencies.begin(), component.dependencies.end(), target) != component.dependencies.end()) continue;
+          component.dependencies.push_back(target);
+          graph.components[target].dependents.push_back(i);
+        }
+      }
+    }
+  };
+};
+
+auto AltaCore::Modules::ImportGraph::fromAST(std::shared_ptr<AST::RootNode> root, Filesystem::Path path) -> ImportGraph {
+  ImportGraph graph;
+  ALTACORE_MAP<std::string, size_t> indices;
+
+  auto nodeFor = [&](std::shared_ptr<AST::RootNode> root, const Filesystem::Path& path) -> size_t {
+    auto key = path.absolutify().toString();
+    auto it = indices.find(key);
+    if (it != indices.end()) return it->second;
+    auto index = graph.nodes.size();
+    indices[key] = index;
+    Node node;
+    node.path = path;
+    node.root = root;
+    if (root && root->info) {
+      node.module = root->info->module;
+    }
+    graph.nodes.push_back(std::move(node));
+    return index;
+  };
+
+  nodeFor(root, path);
+
+  // `nodes` grows as we go, so this visits every module exactly once
+  for (size_t i = 0; i < graph.nodes.size(); i++) {
+    auto modulePath = graph.nodes[i].path;
+    auto moduleRoot = graph.nodes[i].root;
+
+    auto import = [&](const std::string& request) {
+      Filesystem::Path dependencyPath;
+      std::shared_ptr<AST::RootNode> dependencyRoot = nullptr;
+      try {
+        dependencyPath = resolve(request, modulePath);
+        dependencyRoot = parseModule(request, modulePath);
+      } catch (const std::exception&) {
+        // detailing will run into (and report) the same problem
+        return;
+      }
+      if (!dependencyRoot) return;
+      auto dependency = nodeFor(dependencyRoot, dependencyPath);
+      // the `_internal` package doesn't import itself
+      if (dependency == i) return;
+      addDependency(graph.nodes[i], dependency);
+    };
+
+    // every module implicitly imports the `_internal` package first (see `AST::RootNode::detail`)
+    import("@internal@");
+
+    if (!moduleRoot) continue;
+    for (auto& statement: moduleRoot->statements) {
+      if (auto importStatement = std::dynamic_pointer_cast<AST::ImportStatement>(statement)) {
+        import(importStatement->request);
+      } else if (auto exportStatement = std::dynamic_pointer_cast<AST::ExportStatement>(statement)) {
+        if (exportStatement->externalTarget) {
+          import(exportStatement->externalTarget->request);
+        }
+      }
+    }
+  }
+
+  findComponents(graph);
+  return graph;
+};
+
+auto AltaCore::Modules::ImportGraph::fromModule(std::shared_ptr<DET::Module> module) -> ImportGraph {
+  ImportGraph graph;
+  ALTACORE_MAP<std::string, size_t> indices;
+
+  auto nodeFor = [&](std::shared_ptr<DET::Module> module) -> size_t {
+    auto it = indices.find(module->id);
+    if (it != indices.end()) return it->second;
+    auto index = graph.nodes.size();
+    indices[module->id] = index;
+    Node node;
+    node.path = module->path;
+    node.root = module->ast.lock();
+    node.module = module;
+    graph.nodes.push_back(std::move(node));
+    return index;
+  };
+
+  nodeFor(module);
+
+  for (size_t i = 0; i < graph.nodes.size(); i++) {
+    auto current = graph.nodes[i].module;
+    for (auto& dependency: current->dependencies) {
+      if (!dependency) continue;
+      auto index = nodeFor(dependency);
+      if (index == i) continue;
+      addDependency(graph.nodes[i], index);
+    }
+  }
+
+  findComponents(graph);
+  return graph;
+};
+
+void AltaCore::Modules::ImportGraph::run(std::function<void(const Component& component)> task, size_t workerCount) const {
+  if (workerCount == 0) {
+    workerCount = std::thread::hardware_concurrency();
+  }
+  if (workerCount == 0) {
+    workerCount = 1;
+  }
+  if (workerCount > components.size()) {
+    workerCount = components.size();
+  }
+
+  // `components` is already sorted dependencies-first, so a single worker can just go in order
+  if (workerCount <= 1) {
+    for (auto& component: components) {
+      task(component);
+    }
+    return;
+  }
+
+  std::mutex mutex;
+  std::condition_variable wakeUp;
+  std::deque<size_t> ready;
+  std::vector<size_t> waitingOn(components.size());
+  size_t finished = 0;
+  bool stopped = false;
+  std::exception_ptr error = nullptr;
+
+  for (size_t i = 0; i < components.size(); i++) {
+    waitingOn[i] = components[i].dependencies.size();
+    if (waitingOn[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+
+  auto work = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      wakeUp.wait(lock, [&]() {
+        return stopped || ready.size() > 0 || finished == components.size();
+      });
+      if (stopped || ready.empty()) break;
+
+      auto index = ready.front();
+      ready.pop_front();
+
+      lock.unlock();
+      std::exception_ptr taskError = nullptr;
+      try {
+        task(components[index]);
+      } catch (...) {
+        taskError = std::current_exception();
+      }
+      lock.lock();
+
+      ++finished;
+      if (taskError) {
+        if (!error) {
+          error = taskError;
+        }
+        stopped = true;
+      } else {
+        for (auto dependent: components[index].dependents) {
+          if (--waitingOn[dependent] == 0) {
+            ready.push_back(dependent);
+          }
+        }
+      }
+      wakeUp.notify_all();
+    }
+  };
+
+  // the calling thread does its share of the work, too
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < workerCount; i++) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto& worker: workers) {
+    worker.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+};
+
+void AltaCore::Modules::ImportGraph::detail(std::string rootModuleName, size_t workerCount) {
+  // only bother with all the synchronization if there's actually going to be more than one worker
+  // (`run` picks the same number of workers)
+  auto workers = workerCount == 0 ? std::thread::hardware_concurrency() : workerCount;
+  Concurrency::ConcurrentDetailing concurrent(std::min<size_t>(workers, components.size()) > 1);
+
+  run([&](const Component& component) {
+    Concurrency::DetailingSection section;
+    for (auto member: component.members) {
+      auto& node = nodes[member];
+      if (!node.root) continue;
+      // the rest of the component is usually detailed through the first member's imports.
+      // everything except the root module is an import, so it can come from a snapshot, too
+      if (!node.root->info && (member == 0 || !node.root->rehydrate(node.path))) {
+        node.root->detail(node.path, member == 0 ? rootModuleName : "");
+      }
+      node.module = node.root->info->module;
+    }
+  }, workerCount);
+};
@@ -0,0 +1,549 @@
+#include "../include/altacore/memory.hpp"
+#include "../include/altacore/ast.hpp"
+#include "../include/altacore/det.hpp"
+#include "../include/altacore/detail-handles.hpp"
+#include "../include/altacore/parser.hpp"
+#include "../include/altacore/modules.hpp"
+#include "../include/altacore/visitor.hpp"
+#include <typeindex>
+#include <unordered_map>
+#include <sstream>
+#include <functional>
+
+namespace {
+  using namespace AltaCore;
+
+  struct KindInfo {
+    std::string name;
+    size_t size;
+  };
+
+  // heap storage owned by a string, if it doesn't fit in the small string buffer
+  size_t stringBytes(const std::string& value) {
+    static const size_t inlineCapacity = std::string().capacity();
+    return (value.capacity() > inlineCapacity) ? value.capacity() + 1 : 0;
+  };
+
+  std::string moduleKey(const Filesystem::Path& path) {
+    if (!path) return "";
+    return path.isAbsolute() ? path.toString() : path.absolutify().toString();
+  };
+
+#define AC_AST_SIZE(x) case AST::NodeType::x: return sizeof(AST::x);
+
+  size_t astSize(AST::NodeType type) {
+    switch (type) {
+      AC_AST_SIZE(Node)
+      AC_AST_SIZE(StatementNode)
+      AC_AST_SIZE(ExpressionNode)
+      AC_AST_SIZE(RootNode)
+      AC_AST_SIZE(ExpressionStatement)
+      AC_AST_SIZE(Type)
+      AC_AST_SIZE(Parameter)
+      AC_AST_SIZE(BlockNode)
+      AC_AST_SIZE(FunctionDefinitionNode)
+      AC_AST_SIZE(ReturnDirectiveNode)
+      AC_AST_SIZE(IntegerLiteralNode)
+      AC_AST_SIZE(VariableDefinitionExpression)
+      AC_AST_SIZE(Accessor)
+      AC_AST_SIZE(Fetch)
+      AC_AST_SIZE(AssignmentExpression)
+      AC_AST_SIZE(BooleanLiteralNode)
+      AC_AST_SIZE(BinaryOperation)
+      AC_AST_SIZE(ImportStatement)
+      AC_AST_SIZE(FunctionCallExpression)
+      AC_AST_SIZE(StringLiteralNode)
+      AC_AST_SIZE(FunctionDeclarationNode)
+      AC_AST_SIZE(AttributeNode)
+      AC_AST_SIZE(LiteralNode)
+      AC_AST_SIZE(AttributeStatement)
+      AC_AST_SIZE(ConditionalStatement)
+      AC_AST_SIZE(ConditionalExpression)
+      AC_AST_SIZE(ClassDefinitionNode)
+      AC_AST_SIZE(ClassStatementNode)
+      AC_AST_SIZE(ClassMemberDefinitionStatement)
+      AC_AST_SIZE(ClassMethodDefinitionStatement)
+      AC_AST_SIZE(ClassSpecialMethodDefinitionStatement)
+      AC_AST_SIZE(ClassInstantiationExpression)
+      AC_AST_SIZE(PointerExpression)
+      AC_AST_SIZE(DereferenceExpression)
+      AC_AST_SIZE(WhileLoopStatement)
+      AC_AST_SIZE(CastExpression)
+      AC_AST_SIZE(ClassReadAccessorDefinitionStatement)
+      AC_AST_SIZE(CharacterLiteralNode)
+      AC_AST_SIZE(TypeAliasStatement)
+      AC_AST_SIZE(SubscriptExpression)
+      AC_AST_SIZE(RetrievalNode)
+      AC_AST_SIZE(SuperClassFetch)
+      AC_AST_SIZE(InstanceofExpression)
+      AC_AST_SIZE(Generic)
+      AC_AST_SIZE(ForLoopStatement)
+      AC_AST_SIZE(RangedForLoopStatement)
+      AC_AST_SIZE(UnaryOperation)
+      AC_AST_SIZE(SizeofOperation)
+      AC_AST_SIZE(FloatingPointLiteralNode)
+      AC_AST_SIZE(StructureDefinitionStatement)
+      AC_AST_SIZE(ExportStatement)
+      AC_AST_SIZE(VariableDeclarationStatement)
+      AC_AST_SIZE(AliasStatement)
+      AC_AST_SIZE(DeleteStatement)
+      AC_AST_SIZE(ControlDirective)
+      AC_AST_SIZE(TryCatchBlock)
+      AC_AST_SIZE(ThrowStatement)
+      AC_AST_SIZE(NullptrExpression)
+      AC_AST_SIZE(CodeLiteralNode)
+      AC_AST_SIZE(BitfieldDefinitionNode)
+      AC_AST_SIZE(LambdaExpression)
+      AC_AST_SIZE(SpecialFetchExpression)
+      AC_AST_SIZE(ClassOperatorDefinitionStatement)
+      AC_AST_SIZE(EnumerationDefinitionNode)
+      AC_AST_SIZE(YieldExpression)
+      AC_AST_SIZE(AssertionStatement)
+      AC_AST_SIZE(AwaitExpression)
+      AC_AST_SIZE(VoidExpression)
+    }
+    return sizeof(AST::Node);
+  };
+
+#undef AC_AST_SIZE
+
+#define AC_DET_SIZE(x) case DET::NodeType::x: return sizeof(DET::x);
+
+  size_t detSize(DET::NodeType type) {
+    switch (type) {
+      AC_DET_SIZE(Node)
+      AC_DET_SIZE(Module)
+      AC_DET_SIZE(Scope)
+      AC_DET_SIZE(ScopeItem)
+      AC_DET_SIZE(Function)
+      AC_DET_SIZE(Type)
+      AC_DET_SIZE(Variable)
+      AC_DET_SIZE(Alias)
+      AC_DET_SIZE(Namespace)
+      AC_DET_SIZE(Class)
+    }
+    return sizeof(DET::Node);
+  };
+
+#undef AC_DET_SIZE
+
+  // detail handles don't know their own type, so we identify them by their dynamic type instead
+#define AC_DH_KIND(x) { std::type_index(typeid(DH::x)), KindInfo { #x, sizeof(DH::x) } },
+
+  const std::unordered_map<std::type_index, KindInfo>& detailHandleKinds() {
+    static const std::unordered_map<std::type_index, KindInfo> kinds = {
+      AC_DH_KIND(Node)
+      AC_DH_KIND(StatementNode)
+      AC_DH_KIND(ClassStatementNode)
+      AC_DH_KIND(ExpressionNode)
+      AC_DH_KIND(LiteralNode)
+      AC_DH_KIND(NullptrExpression)
+      AC_DH_KIND(VoidExpression)
+      AC_DH_KIND(BooleanLiteralNode)
+      AC_DH_KIND(IntegerLiteralNode)
+      AC_DH_KIND(StringLiteralNode)
+      AC_DH_KIND(CharacterLiteralNode)
+      AC_DH_KIND(FloatingPointLiteralNode)
+      AC_DH_KIND(RetrievalNode)
+      AC_DH_KIND(Accessor)
+      AC_DH_KIND(AssignmentExpression)
+      AC_DH_KIND(AttributeNode)
+      AC_DH_KIND(AttributeStatement)
+      AC_DH_KIND(BinaryOperation)
+      AC_DH_KIND(UnaryOperation)
+      AC_DH_KIND(BlockNode)
+      AC_DH_KIND(CastExpression)
+      AC_DH_KIND(ClassDefinitionNode)
+      AC_DH_KIND(GenericClassInstantiationDefinitionNode)
+      AC_DH_KIND(ClassInstantiationExpression)
+      AC_DH_KIND(ClassMemberDefinitionStatement)
+      AC_DH_KIND(ClassMethodDefinitionStatement)
+      AC_DH_KIND(ClassReadAccessorDefinitionStatement)
+      AC_DH_KIND(ClassSpecialMethodDefinitionStatement)
+      AC_DH_KIND(ClassOperatorDefinitionStatement)
+      AC_DH_KIND(ConditionalExpression)
+      AC_DH_KIND(ConditionalStatement)
+      AC_DH_KIND(DereferenceExpression)
+      AC_DH_KIND(ExpressionStatement)
+      AC_DH_KIND(Fetch)
+      AC_DH_KIND(FunctionCallExpression)
+      AC_DH_KIND(FunctionDeclarationNode)
+      AC_DH_KIND(FunctionDefinitionNode)
+      AC_DH_KIND(GenericFunctionInstantiationDefinitionNode)
+      AC_DH_KIND(ImportStatement)
+      AC_DH_KIND(Parameter)
+      AC_DH_KIND(PointerExpression)
+      AC_DH_KIND(ReturnDirectiveNode)
+      AC_DH_KIND(RootNode)
+      AC_DH_KIND(TypeAliasStatement)
+      AC_DH_KIND(Type)
+      AC_DH_KIND(VariableDefinitionExpression)
+      AC_DH_KIND(WhileLoopStatement)
+      AC_DH_KIND(ForLoopStatement)
+      AC_DH_KIND(RangedForLoopStatement)
+      AC_DH_KIND(SubscriptExpression)
+      AC_DH_KIND(SuperClassFetch)
+      AC_DH_KIND(InstanceofExpression)
+      AC_DH_KIND(Generic)
+      AC_DH_KIND(SizeofOperation)
+      AC_DH_KIND(StructureDefinitionStatement)
+      AC_DH_KIND(ExportStatement)
+      AC_DH_KIND(VariableDeclarationStatement)
+      AC_DH_KIND(AliasStatement)
+      AC_DH_KIND(DeleteStatement)
+      AC_DH_KIND(TryCatchBlock)
+      AC_DH_KIND(ThrowStatement)
+      AC_DH_KIND(CodeLiteralNode)
+      AC_DH_KIND(BitfieldDefinitionNode)
+      AC_DH_KIND(LambdaExpression)
+      AC_DH_KIND(SpecialFetchExpression)
+      AC_DH_KIND(EnumerationDefinitionNode)
+      AC_DH_KIND(YieldExpression)
+      AC_DH_KIND(AssertionStatement)
+      AC_DH_KIND(AwaitExpression)
+    };
+    return kinds;
+  };
+
+#undef AC_DH_KIND
+
+  class ASTCounter: public AST::Visitor {
+    public:
+      std::unordered_set<const void*>& seen;
+      std::map<AST::NodeType, Memory::Usage>& usage;
+
+      ASTCounter(std::unordered_set<const void*>& _seen, std::map<AST::NodeType, Memory::Usage>& _usage):
+        seen(_seen),
+        usage(_usage)
+        {};
+
+      virtual AST::VisitAction enter(NodePointer node) {
+        if (!seen.insert(node.get()).second) {
+          return AST::VisitAction::SkipChildren;
+        }
+        auto type = node->nodeType();
+        usage[type].add(astSize(type) + stringBytes(node->id));
+        return AST::VisitAction::Continue;
+      };
+  };
+
+  class DetailCounter: public DH::Visitor {
+    public:
+      std::unordered_set<const void*>& seen;
+      std::map<std::string, Memory::Usage>& usage;
+
+      DetailCounter(std::unordered_set<const void*>& _seen, std::map<std::string, Memory::Usage>& _usage):
+        seen(_seen),
+        usage(_usage)
+        {};
+
+      virtual DH::VisitAction enter(NodePointer node) {
+        if (!seen.insert(node.get()).second) {
+          return DH::VisitAction::SkipChildren;
+        }
+        auto& kinds = detailHandleKinds();
+        auto& raw = *node;
+        auto kind = kinds.find(std::type_index(typeid(raw)));
+        if (kind == kinds.end()) {
+          usage[typeid(raw).name()].add(sizeof(DH::Node) + stringBytes(node->id));
+        } else {
+          usage[kind->second.name].add(kind->second.size + stringBytes(node->id));
+        }
+        return DH::VisitAction::Continue;
+      };
+  };
+
+  std::string escapeJSON(const std::string& value) {
+    std::stringstream result;
+    for (auto character: value) {
+      switch (character) {
+        case '"': result << "\\\""; break;
+        case '\\': result << "\\\\"; break;
+        case '\n': result << "\\n"; break;
+        case '\r': result << "\\r"; break;
+        case '\t': result << "\\t"; break;
+        default: {
+          if (static_cast<unsigned char>(character) < 0x20) {
+            static const char* const hex = "0123456789abcdef";
+            result << "\\u00" << hex[(character >> 4) & 0xf] << hex[character & 0xf];
+          } else {
+            result << character;
+          }
+        }
+      }
+    }
+    return result.str();
+  };
+
+  void writeUsage(std::stringstream& output, const Memory::Usage& usage) {
+    output << "{\"instances\":" << usage.instances << ",\"bytes\":" << usage.bytes << "}";
+  };
+
+  template<typename Key>
+  void writeUsageMap(std::stringstream& output, const std::map<Key, Memory::Usage>& usages, std::function<std::string(const Key&)> nameOf) {
+    output << "{";
+    bool first = true;
+    for (auto& [key, usage]: usages) {
+      if (!first) output << ",";
+      first = false;
+      output << "\"" << escapeJSON(nameOf(key)) << "\":";
+      writeUsage(output, usage);
+    }
+    output << "}";
+  };
+
+  template<typename Key>
+  void mergeInto(std::map<Key, Memory::Usage>& target, const std::map<Key, Memory::Usage>& source) {
+    for (auto& [key, usage]: source) {
+      target[key] += usage;
+    }
+  };
+
+  template<typename Key>
+  Memory::Usage sumOf(const std::map<Key, Memory::Usage>& usages) {
+    Memory::Usage result;
+    for (auto& [key, usage]: usages) {
+      result += usage;
+    }
+    return result;
+  };
+
+  std::string astName(const AST::NodeType& type) {
+    return AST::NodeType_names[static_cast<size_t>(type)];
+  };
+  std::string detName(const DET::NodeType& type) {
+    return DET::NodeType_names[static_cast<size_t>(type)];
+  };
+  std::string plainName(const std::string& name) {
+    return name;
+  };
+
+  void writeBreakdown(std::stringstream& output, const std::map<AST::NodeType, Memory::Usage>& ast, const std::map<std::string, Memory::Usage>& detailHandles, const std::map<DET::NodeType, Memory::Usage>& det, const Memory::Usage& tokens, const Memory::Usage& importCache) {
+    output << "\"ast\":";
+    writeUsageMap<AST::NodeType>(output, ast, astName);
+    output << ",\"detailHandles\":";
+    writeUsageMap<std::string>(output, detailHandles, plainName);
+    output << ",\"det\":";
+    writeUsageMap<DET::NodeType>(output, det, detName);
+    output << ",\"tokens\":";
+    writeUsage(output, tokens);
+    output << ",\"importCache\":";
+    writeUsage(output, importCache);
+  };
+};
+
+void AltaCore::Memory::Usage::add(size_t _bytes, size_t _instances) {
+  bytes += _bytes;
+  instances += _instances;
+};
+
+AltaCore::Memory::Usage& AltaCore::Memory::Usage::operator+=(const Usage& other) {
+  bytes += other.bytes;
+  instances += other.instances;
+  return *this;
+};
+
+AltaCore::Memory::Usage AltaCore::Memory::ModuleUsage::total() const {
+  Usage result;
+  result += sumOf(ast);
+  result += sumOf(detailHandles);
+  result += sumOf(det);
+  result += tokens;
+  result += importCache;
+  return result;
+};
+
+AltaCore::Memory::ModuleUsage& AltaCore::Memory::Report::moduleFor(AltaCore::Filesystem::Path modulePath) {
+  auto key = moduleKey(modulePath);
+  auto it = modules.find(key);
+  if (it == modules.end()) {
+    it = modules.emplace(key, ModuleUsage()).first;
+    it->second.path = modulePath;
+  }
+  return it->second;
+};
+
+void AltaCore::Memory::Report::addAST(std::shared_ptr<AST::Node> root, AltaCore::Filesystem::Path modulePath) {
+  if (!root) return;
+  ASTCounter counter(seen, moduleFor(modulePath).ast);
+  counter.visit(root);
+};
+
+void AltaCore::Memory::Report::addDetails(std::shared_ptr<DH::Node> root, AltaCore::Filesystem::Path modulePath) {
+  if (!root) return;
+  DetailCounter counter(seen, moduleFor(modulePath).detailHandles);
+  counter.visit(root);
+};
+
+void AltaCore::Memory::Report::addModule(std::shared_ptr<DET::Module> module) {
+  if (!module) return;
+
+  auto& usage = moduleFor(module->path);
+  usage.name = module->name;
+
+  std::vector<std::shared_ptr<DET::Node>> pending { module };
+
+  auto push = [&](std::shared_ptr<DET::Node> node) {
+    if (node) pending.push_back(node);
+  };
+  auto pushAll = [&](const auto& nodes) {
+    for (auto& node: nodes) push(node);
+  };
+
+  while (pending.size() > 0) {
+    auto node = pending.back();
+    pending.pop_back();
+
+    if (!seen.insert(node.get()).second) continue;
+
+    auto type = node->nodeType();
+    usage.det[type].add(detSize(type) + stringBytes(node->id));
+
+    // only follow edges to things this module owns;
+    // everything else is counted along with its own module
+    if (auto mod = std::dynamic_pointer_cast<DET::Module>(node)) {
+      push(mod->scope);
+      push(mod->exports);
+    } else if (auto scope = std::dynamic_pointer_cast<DET::Scope>(node)) {
+      pushAll(scope->items);
+      pushAll(scope->childScopes);
+      pushAll(scope->typesThrown);
+    } else if (auto func = std::dynamic_pointer_cast<DET::Function>(node)) {
+      push(func->scope);
+      push(func->returnType);
+      for (auto& param: func->parameters) {
+        push(std::get<1>(param));
+      }
+      pushAll(func->parameterVariables);
+      pushAll(func->genericArguments);
+      push(func->generatorParameterType);
+      push(func->generatorReturnType);
+      push(func->coroutineReturnType);
+    } else if (auto klass = std::dynamic_pointer_cast<DET::Class>(node)) {
+      push(klass->scope);
+      pushAll(klass->genericArguments);
+      push(klass->suspendableInput);
+      push(klass->suspendableOutput);
+    } else if (auto ns = std::dynamic_pointer_cast<DET::Namespace>(node)) {
+      push(ns->scope);
+      pushAll(ns->hoistedFunctionalTypes);
+      push(ns->underlyingEnumerationType);
+    } else if (auto var = std::dynamic_pointer_cast<DET::Variable>(node)) {
+      push(var->type);
+    } else if (auto type = std::dynamic_pointer_cast<DET::Type>(node)) {
+      push(type->returnType);
+      for (auto& param: type->parameters) {
+        push(std::get<1>(param));
+      }
+      pushAll(type->unionOf);
+      push(type->optionalTarget);
+    }
+  }
+};
+
+void AltaCore::Memory::Report::addTokens(const std::vector<Lexer::Token>& tokens, AltaCore::Filesystem::Path modulePath) {
+  if (!seen.insert(&tokens).second) return;
+  auto& usage = moduleFor(modulePath).tokens;
+  size_t bytes = tokens.capacity() * sizeof(Lexer::Token);
+  for (auto& token: tokens) {
+    bytes += stringBytes(token.raw);
+  }
+  usage.add(bytes, tokens.size());
+};
+
+void AltaCore::Memory::Report::addParser(const Parser::Parser& parser, AltaCore::Filesystem::Path modulePath) {
+  addTokens(parser.getTokens(), modulePath);
+  addTokens(parser.getOriginalTokens(), modulePath);
+};
+
+void AltaCore::Memory::Report::addImportCache() {
+  for (auto& [key, root]: Modules::importCache) {
+    Filesystem::Path path(key);
+    auto& usage = moduleFor(path);
+    usage.importCache.add(sizeof(std::pair<const std::string, std::shared_ptr<AST::RootNode>>) + sizeof(void*) + stringBytes(key));
+
+    addAST(root, path);
+    if (root && root->info) {
+      addDetails(root->info, path);
+      addModule(root->info->module);
+    }
+  }
+};
+
+std::map<AltaCore::AST::NodeType, AltaCore::Memory::Usage> AltaCore::Memory::Report::astTotals() const {
+  std::map<AST::NodeType, Usage> result;
+  for (auto& [path, usage]: modules) {
+    mergeInto(result, usage.ast);
+  }
+  return result;
+};
+
+std::map<std::string, AltaCore::Memory::Usage> AltaCore::Memory::Report::detailHandleTotals() const {
+  std::map<std::string, Usage> result;
+  for (auto& [path, usage]: modules) {
+    mergeInto(result, usage.detailHandles);
+  }
+  return result;
+};
+
+std::map<AltaCore::DET::NodeType, AltaCore::Memory::Usage> AltaCore::Memory::Report::detTotals() const {
+  std::map<DET::NodeType, Usage> result;
+  for (auto& [path, usage]: modules) {
+    mergeInto(result, usage.det);
+  }
+  return result;
+};
+
+AltaCore::Memory::Usage AltaCore::Memory::Report::tokenTotal() const {
+  Usage result;
+  for (auto& [path, usage]: modules) {
+    result += usage.tokens;
+  }
+  return result;
+};
+
+AltaCore::Memory::Usage AltaCore::Memory::Report::importCacheTotal() const {
+  Usage result;
+  for (auto& [path, usage]: modules) {
+    result += usage.importCache;
+  }
+  return result;
+};
+
+AltaCore::Memory::Usage AltaCore::Memory::Report::total() const {
+  Usage result;
+  for (auto& [path, usage]: modules) {
+    result += usage.total();
+  }
+  return result;
+};
+
+std::string AltaCore::Memory::Report::toJSON() const {
+  std::stringstream output;
+
+  output << "{\"total\":";
+  writeUsage(output, total());
+  output << ",";
+  writeBreakdown(output, astTotals(), detailHandleTotals(), detTotals(), tokenTotal(), importCacheTotal());
+
+  output << ",\"modules\":[";
+  bool first = true;
+  for (auto& [path, usage]: modules) {
+    if (!first) output << ",";
+    first = false;
+    output << "{\"name\":\"" << escapeJSON(usage.name) << "\",\"path\":\"" << escapeJSON(path) << "\",\"total\":";
+    writeUsage(output, usage.total());
+    output << ",";
+    writeBreakdown(output, usage.ast, usage.detailHandles, usage.det, usage.tokens, usage.importCache);
+    output << "}";
+  }
+  output << "]}";
+
+  return output.str();
+};
+
+AltaCore::Memory::Report AltaCore::Memory::collect() {
+  Report report;
+  report.addImportCache();
+  return report;
+};
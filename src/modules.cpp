@@ -1,6 +1,15 @@
 #include "../include/altacore.hpp"
 #include <yaml-cpp/yaml.h>
 #include <fstream>
+#include <sstream>
+#include <iterator>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace {
+  std::shared_ptr<AltaCore::AST::RootNode> loadModule(AltaCore::Filesystem::Path modPath);
+};
 
 namespace AltaCore {
   namespace Modules {
@@ -10,38 +19,416 @@ namespace AltaCore {
     ALTACORE_MAP<std::string, std::shared_ptr<AltaCore::AST::RootNode>> importCache;
     ALTACORE_MAP<std::string, Parser::PrepoExpression> defaultDefinitions;
     ALTACORE_MAP<std::string, Parser::PrepoExpression>* parsingDefinitions = &defaultDefinitions;
+    RetentionPolicy retentionPolicy;
+    bool revalidateResolutions = false;
     std::function<std::shared_ptr<AST::RootNode>(std::string importRequest, Filesystem::Path requestingModulePath)> parseModule = [](std::string importRequest, Filesystem::Path requestingModulePath) -> std::shared_ptr<AST::RootNode> {
-      auto modPath = resolve(importRequest, requestingModulePath);
-      if (importCache.find(modPath.absolutify().toString()) != importCache.end()) {
-        return importCache[modPath.absolutify().toString()];
+      return loadModule(resolve(importRequest, requestingModulePath));
+    };
+  };
+};
+
+namespace {
+  using namespace AltaCore;
+
+  struct InFlightParse {
+    std::thread::id owner;
+    std::shared_future<std::shared_ptr<AST::RootNode>> result;
+  };
+
+  struct ImportCacheState {
+    // guards `Modules::importCache`, too
+    std::mutex mutex;
+    ALTACORE_MAP<std::string, std::shared_ptr<InFlightParse>> inFlight;
+    // the module each thread is waiting on another thread to parse (so we can catch import cycles)
+    ALTACORE_MAP<std::thread::id, std::string> waiting;
+    Modules::ImportCacheStatistics statistics;
+  };
+
+  ImportCacheState& importCacheState() {
+    static ImportCacheState state;
+    return state;
+  };
+
+  // for every load in progress on this thread, how much of it was spent loading the modules it imports
+  thread_local std::vector<std::chrono::nanoseconds> nestedLoadTimes;
+
+  // the imports made by the module this thread is currently parsing, for its AST cache entry
+  thread_local std::vector<ASTCache::ImportRecord>* recordedImports = nullptr;
+
+  std::shared_ptr<AST::RootNode> parseUncached(Filesystem::Path modPath, const std::string& modKey) {
+    using namespace Modules;
+
+    std::ifstream file(modKey, std::ios::binary);
+
+    if (!file.is_open()) {
+      throw std::runtime_error("oh no.");
+    }
+
+    std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+
+    // the key has to be computed before parsing, since parsing can add new definitions
+    ASTCache::CacheKey cacheKey(modPath, source, *parsingDefinitions);
+    std::vector<ASTCache::ImportRecord> imports;
+    auto root = ASTCache::load(cacheKey, *parsingDefinitions, imports);
+
+    if (root) {
+      // parsing the module would've parsed the modules it imports (with whatever was defined at each import),
+      // so do that now. otherwise, they'd be parsed later on with our final definitions instead
+      auto finalDefinitions = *parsingDefinitions;
+      try {
+        for (auto& import: imports) {
+          *parsingDefinitions = *import.definitions;
+          parseModule(import.request, modPath);
+        }
+      } catch (...) {
+        *parsingDefinitions = finalDefinitions;
+        throw;
       }
-      std::ifstream file(modPath.absolutify().toString());
+      *parsingDefinitions = finalDefinitions;
+    } else {
+      std::istringstream stream(source);
       std::string line;
       Lexer::Lexer lexer(modPath);
 
-      if (!file.is_open()) {
-        throw std::runtime_error("oh no.");
-      }
-
-      while (std::getline(file, line)) {
-        if (file.peek() != EOF) {
+      while (std::getline(stream, line)) {
+        if (stream.peek() != EOF) {
           line += "\n";
         }
         lexer.feed(line);
       }
 
-      file.close();
-
-      Parser::Parser parser(lexer.tokens, *parsingDefinitions, modPath);
-      parser.parse();
-      auto root = std::dynamic_pointer_cast<AST::RootNode>(*parser.root);
+      // the lexer's copy of the tokens isn't needed anymore
+      Parser::Parser parser(std::move(lexer.tokens), *parsingDefinitions, modPath);
+      auto outerImports = recordedImports;
+      recordedImports = &imports;
+      try {
+        parser.parse();
+      } catch (...) {
+        recordedImports = outerImports;
+        throw;
+      }
+      recordedImports = outerImports;
+      root = std::dynamic_pointer_cast<AST::RootNode>(*parser.root);
       //root->detail(modPath);
 
-      importCache[modPath.absolutify().toString()] = root;
+      if (root) {
+        ASTCache::store(cacheKey, root, *parsingDefinitions, imports);
+      }
+    }
+
+    if (root) {
+      root->cacheKey = cacheKey;
+    }
+
+    return root;
+  };
+
+  // expects the lock to be held
+  bool waitWouldDeadlock(ImportCacheState& state, std::thread::id owner) {
+    auto self = std::this_thread::get_id();
+    while (owner != self) {
+      auto waitingOn = state.waiting.find(owner);
+      if (waitingOn == state.waiting.end()) return false;
+      auto parse = state.inFlight.find(waitingOn->second);
+      if (parse == state.inFlight.end()) return false;
+      owner = parse->second->owner;
+    }
+    return true;
+  };
 
+  std::shared_ptr<AST::RootNode> loadModule(Filesystem::Path modPath) {
+    using namespace Modules;
+
+    auto modKey = modPath.absolutify().toString();
+    auto& state = importCacheState();
+    auto started = std::chrono::steady_clock::now();
+
+    // whatever happens here counts as time spent on imports for the load that got us here (if any)
+    auto finish = [&]() {
+      if (nestedLoadTimes.size() > 0) {
+        nestedLoadTimes.back() += std::chrono::steady_clock::now() - started;
+      }
+    };
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+
+    auto cached = importCache.find(modKey);
+    if (cached != importCache.end()) {
+      ++state.statistics.hits;
+      return cached->second;
+    }
+
+    auto pending = state.inFlight.find(modKey);
+    if (pending != state.inFlight.end()) {
+      auto parse = pending->second;
+      if (waitWouldDeadlock(state, parse->owner)) {
+        throw ModuleError("circular import while parsing " + modKey);
+      }
+
+      ++state.statistics.waits;
+      state.waiting[std::this_thread::get_id()] = modKey;
+      lock.unlock();
+
+      std::shared_ptr<AST::RootNode> root = nullptr;
+      std::exception_ptr error = nullptr;
+      try {
+        root = parse->result.get();
+      } catch (...) {
+        error = std::current_exception();
+      }
+
+      lock.lock();
+      state.waiting.erase(std::this_thread::get_id());
+      lock.unlock();
+
+      finish();
+      if (error) {
+        std::rethrow_exception(error);
+      }
       return root;
+    }
+
+    ++state.statistics.misses;
+    auto parse = std::make_shared<InFlightParse>();
+    std::promise<std::shared_ptr<AST::RootNode>> promise;
+    parse->owner = std::this_thread::get_id();
+    parse->result = promise.get_future().share();
+    state.inFlight[modKey] = parse;
+    lock.unlock();
+
+    nestedLoadTimes.push_back(std::chrono::nanoseconds(0));
+    std::shared_ptr<AST::RootNode> root = nullptr;
+    try {
+      root = parseUncached(modPath, modKey);
+    } catch (...) {
+      nestedLoadTimes.pop_back();
+
+      // failures aren't cached; whoever asks next gets to try again
+      lock.lock();
+      state.inFlight.erase(modKey);
+      lock.unlock();
+
+      promise.set_exception(std::current_exception());
+      finish();
+      throw;
+    }
+    auto nested = nestedLoadTimes.back();
+    nestedLoadTimes.pop_back();
+    auto elapsed = std::chrono::steady_clock::now() - started;
+
+    lock.lock();
+    importCache[modKey] = root;
+    state.inFlight.erase(modKey);
+    state.statistics.parseLatencies[modKey] = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed) - nested;
+    lock.unlock();
+
+    promise.set_value(root);
+    finish();
+    return root;
+  };
+
+  class GenericTemplateFinder: public AST::Visitor {
+    public:
+      bool found = false;
+
+      virtual AST::VisitAction enter(NodePointer node) {
+        if (auto func = std::dynamic_pointer_cast<AST::FunctionDefinitionNode>(node)) {
+          found = func->generics.size() > 0;
+        } else if (auto klass = std::dynamic_pointer_cast<AST::ClassDefinitionNode>(node)) {
+          found = klass->generics.size() > 0;
+        }
+        return found ? AST::VisitAction::Stop : AST::VisitAction::Continue;
+      };
+  };
+
+  bool containsGenericTemplate(std::shared_ptr<AST::Node> node) {
+    GenericTemplateFinder finder;
+    finder.visit(node);
+    return finder.found;
+  };
+
+  class DetailReleaser: public DH::Visitor {
+    public:
+      bool releaseInputScopes;
+      bool releaseGenericInstantiations;
+
+      DetailReleaser(bool _releaseInputScopes, bool _releaseGenericInstantiations):
+        releaseInputScopes(_releaseInputScopes),
+        releaseGenericInstantiations(_releaseGenericInstantiations)
+        {};
+
+      virtual DH::VisitAction enter(NodePointer node) {
+        // this has to happen before the node's children are collected,
+        // otherwise we'd just end up walking the bodies we're about to drop
+        if (releaseGenericInstantiations) {
+          if (auto func = std::dynamic_pointer_cast<DH::FunctionDefinitionNode>(node)) {
+            for (auto& inst: func->genericInstantiations) {
+              inst->body = nullptr;
+            }
+          } else if (auto klass = std::dynamic_pointer_cast<DH::ClassDefinitionNode>(node)) {
+            for (auto& inst: klass->genericInstantiations) {
+              inst->statements.clear();
+            }
+          }
+        }
+        if (releaseInputScopes) {
+          node->inputScope = nullptr;
+        }
+        return DH::VisitAction::Continue;
+      };
+  };
+};
+
+AltaCore::Modules::RetentionPolicy AltaCore::Modules::RetentionPolicy::keepAll() {
+  return RetentionPolicy();
+};
+
+AltaCore::Modules::RetentionPolicy AltaCore::Modules::RetentionPolicy::releaseAll() {
+  RetentionPolicy policy;
+  policy.releaseAST = true;
+  policy.releaseDetails = true;
+  policy.releaseInputScopes = true;
+  policy.releaseGenericInstantiations = true;
+  policy.pruneInternedTypes = true;
+  return policy;
+};
+
+void AltaCore::Modules::finishModule(std::shared_ptr<AST::RootNode> root) {
+  if (!root || !root->info) return;
+
+  auto& policy = retentionPolicy;
+  auto info = root->info;
+
+  std::vector<std::shared_ptr<AST::StatementNode>> keptStatements;
+  std::vector<std::shared_ptr<DH::StatementNode>> keptDetails;
+
+  // `root->statements[i]` and `info->statements[i]` have to keep describing the same statement,
+  // so a statement is only dropped entirely when both halves go; otherwise, whichever half
+  // is released leaves a `nullptr` in its place
+  auto keep = [&](std::shared_ptr<AST::StatementNode> stmt, std::shared_ptr<DH::StatementNode> det) {
+    if (!stmt && !det) return;
+    keptStatements.push_back(stmt);
+    keptDetails.push_back(det);
+  };
+
+  for (size_t i = 0; i < root->statements.size(); i++) {
+    auto& stmt = root->statements[i];
+    auto det = (i < info->statements.size()) ? info->statements[i] : nullptr;
+
+    // generic templates have to stay intact (AST, detail handles, input scopes and all)
+    // so that they can still be instantiated; we can only drop their instantiations' bodies
+    if (stmt && containsGenericTemplate(stmt)) {
+      if (det) {
+        DetailReleaser(false, policy.releaseGenericInstantiations).visit(det);
+      }
+      keep(stmt, det);
+      continue;
+    }
+
+    if (det && !policy.releaseDetails) {
+      DetailReleaser(policy.releaseInputScopes, policy.releaseGenericInstantiations).visit(det);
+    }
+    keep(policy.releaseAST ? nullptr : stmt, policy.releaseDetails ? nullptr : det);
+  }
+
+  // there shouldn't be more detail handles than statements, but let's not lose any if there are
+  for (size_t i = root->statements.size(); i < info->statements.size(); i++) {
+    if (!policy.releaseDetails && info->statements[i]) {
+      keptDetails.push_back(info->statements[i]);
+    }
+  }
+
+  root->statements = std::move(keptStatements);
+  info->statements = std::move(keptDetails);
+  root->statements.shrink_to_fit();
+  info->statements.shrink_to_fit();
+
+  if (policy.pruneInternedTypes) {
+    DET::Type::pruneInterned();
+  }
+};
+
+void AltaCore::Modules::finishModule(AltaCore::Filesystem::Path modulePath) {
+  if (auto root = findImport(modulePath)) {
+    finishModule(root);
+  }
+};
+
+auto AltaCore::Modules::parseImport(std::string importRequest, Filesystem::Path requestingModulePath) -> std::shared_ptr<AST::RootNode> {
+  if (recordedImports) {
+    recordedImports->push_back(ASTCache::ImportRecord { importRequest, std::make_shared<ASTCache::Definitions>(*parsingDefinitions) });
+  }
+  return parseModule(importRequest, requestingModulePath);
+};
+
+auto AltaCore::Modules::findImport(Filesystem::Path modulePath) -> std::shared_ptr<AST::RootNode> {
+  auto key = modulePath.absolutify().toString();
+  auto& state = importCacheState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  auto it = importCache.find(key);
+  if (it == importCache.end()) return nullptr;
+  return it->second;
+};
+
+auto AltaCore::Modules::importCacheStatistics() -> ImportCacheStatistics {
+  auto& state = importCacheState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  return state.statistics;
+};
+
+void AltaCore::Modules::resetImportCacheStatistics() {
+  auto& state = importCacheState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.statistics = ImportCacheStatistics();
+};
+
+namespace {
+  using AltaCore::Filesystem::Path;
+
+  struct ResolutionCache {
+    // requesting directory + '\0' + import request -> resolved module path
+    ALTACORE_MAP<std::string, Path> entries;
+    std::mutex mutex;
+    // what the entries were resolved with
+    std::vector<Path> prioritySearchPaths;
+    std::vector<Path> searchPaths;
+    Path standardLibraryPath;
+    AltaCore::Modules::ResolutionCacheStatistics statistics;
+
+    void clear() {
+      if (!entries.empty()) {
+        ++statistics.invalidations;
+        entries.clear();
+      }
     };
   };
+
+  ResolutionCache& resolutionCache() {
+    static ResolutionCache cache;
+    return cache;
+  };
+
+  AltaCore::Filesystem::Path resolveUncached(std::string importRequest, AltaCore::Filesystem::Path relativeTo);
+
+  struct CachedPackageInfo {
+    int64_t modificationTime;
+    AltaCore::Modules::PackageInfo info;
+  };
+
+  struct PackageInfoCache {
+    // module or directory -> the manifest `findInfo` found for it (or an empty path if there wasn't one)
+    ALTACORE_MAP<std::string, Path> manifests;
+    // manifest -> its parsed contents
+    ALTACORE_MAP<std::string, CachedPackageInfo> packages;
+    std::mutex mutex;
+    AltaCore::Modules::PackageInfoCacheStatistics statistics;
+  };
+
+  PackageInfoCache& packageInfoCache() {
+    static PackageInfoCache cache;
+    return cache;
+  };
 };
 
 AltaCore::Modules::PackageInfo::PackageInfo() {
@@ -51,14 +438,36 @@ AltaCore::Modules::PackageInfo::PackageInfo() {
 };
 
 AltaCore::Filesystem::Path AltaCore::Modules::findInfo(AltaCore::Filesystem::Path moduleOrPackagePath) {
+  auto& cache = packageInfoCache();
+  auto& manifests = cache.manifests;
+  std::lock_guard<std::mutex> lock(cache.mutex);
+
+  // everything we checked on the way up ends up with the same answer
+  std::vector<std::string> visited;
+  Filesystem::Path result;
+
   while (!moduleOrPackagePath.isRoot()) {
+    auto key = moduleOrPackagePath.toString();
+    auto it = manifests.find(key);
+    if (it != manifests.end()) {
+      result = it->second;
+      break;
+    }
+    visited.push_back(std::move(key));
+
     auto infoPath = moduleOrPackagePath / "package.alta.yaml";
     if (infoPath.exists()) {
-      return infoPath;
+      result = infoPath;
+      break;
     }
     moduleOrPackagePath.pop();
   }
-  return Filesystem::Path();
+
+  for (auto& key: visited) {
+    manifests[key] = result;
+  }
+
+  return result;
 };
 
 AltaCore::Modules::PackageInfo AltaCore::Modules::getInfo(AltaCore::Filesystem::Path moduleOrPackagePath, bool _findInfo) {
@@ -69,7 +478,21 @@ AltaCore::Modules::PackageInfo AltaCore::Modules::getInfo(AltaCore::Filesystem::
       throw PackageInformationNotFoundError();
     }
   }
-  auto yamlRoot = YAML::LoadFile(infoPath.toString());
+
+  auto& cache = packageInfoCache();
+  auto key = infoPath.toString();
+  auto modificationTime = infoPath.modificationTime();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto cached = cache.packages.find(key);
+    if (cached != cache.packages.end() && modificationTime >= 0 && cached->second.modificationTime == modificationTime) {
+      ++cache.statistics.hits;
+      return cached->second.info;
+    }
+    ++cache.statistics.misses;
+  }
+
+  auto yamlRoot = YAML::LoadFile(key);
   if (!yamlRoot["name"]) {
     throw InvalidPackageInformationError();
   }
@@ -131,168 +554,193 @@ AltaCore::Modules::PackageInfo AltaCore::Modules::getInfo(AltaCore::Filesystem::
       info.targets.push_back(targetInfo);
     }
   }
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.packages[key] = CachedPackageInfo { modificationTime, info };
   return info;
 };
 
-AltaCore::Filesystem::Path AltaCore::Modules::resolve(std::string importRequest, AltaCore::Filesystem::Path relativeTo) {
-  using namespace Filesystem;
+void AltaCore::Modules::invalidatePackageInfo() {
+  auto& cache = packageInfoCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.manifests.clear();
+    cache.packages.clear();
+  }
+  Filesystem::StatCache::invalidate();
+};
 
+auto AltaCore::Modules::packageInfoCacheStatistics() -> PackageInfoCacheStatistics {
+  auto& cache = packageInfoCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  return cache.statistics;
+};
+
+void AltaCore::Modules::resetPackageInfoCacheStatistics() {
+  auto& cache = packageInfoCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.statistics = PackageInfoCacheStatistics();
+};
+
+AltaCore::Filesystem::Path AltaCore::Modules::resolve(std::string importRequest, AltaCore::Filesystem::Path relativeTo) {
   if (importRequest == "@internal@") {
     return standardLibraryPath / "_internal" / "main.alta";
   }
 
-  relativeTo = relativeTo.normalize();
-  auto origRelativeTo = relativeTo;
-  auto importPath = Path(importRequest, std::string(1, '/'));
+  // a module resolves imports exactly like the directory it's in
+  auto directory = relativeTo.normalize();
+  if (!directory.isDirectory()) {
+    directory = directory.dirname();
+  }
+
+  auto key = directory.toString();
+  key += '\0';
+  key += importRequest;
 
-  if (importPath.components.size() > 0 && !importPath.isAbsolute() && importPath.components[0] == "@internal@") {
-    importPath.shift();
-    importPath = standardLibraryPath / "_internal" / importPath;
+  auto& cache = resolutionCache();
+  std::unique_lock<std::mutex> lock(cache.mutex);
+
+  if (
+    !(cache.standardLibraryPath == standardLibraryPath) ||
+    cache.prioritySearchPaths != prioritySearchPaths ||
+    cache.searchPaths != searchPaths
+  ) {
+    cache.clear();
+    cache.prioritySearchPaths = prioritySearchPaths;
+    cache.searchPaths = searchPaths;
+    cache.standardLibraryPath = standardLibraryPath;
   }
 
-  if (importPath.extname() == "alta") {
-    // resolve locally
-    if (!relativeTo.isDirectory()) {
-      relativeTo = relativeTo.dirname();
-    }
-    auto truePath = importPath.absolutify(relativeTo);
-    if (truePath.exists()) {
-      return truePath;
+  auto it = cache.entries.find(key);
+  if (it != cache.entries.end() && (!revalidateResolutions || Filesystem::StatCache::refresh(it->second).exists)) {
+    ++cache.statistics.hits;
+    return it->second;
+  }
+  ++cache.statistics.misses;
+  lock.unlock();
+
+  auto result = resolveUncached(importRequest, relativeTo);
+
+  lock.lock();
+  cache.entries[key] = result;
+  return result;
+};
+
+void AltaCore::Modules::invalidateResolutions() {
+  auto& cache = resolutionCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.clear();
+  }
+  Filesystem::StatCache::invalidate();
+};
+
+auto AltaCore::Modules::resolutionCacheStatistics() -> ResolutionCacheStatistics {
+  auto& cache = resolutionCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  return cache.statistics;
+};
+
+void AltaCore::Modules::resetResolutionCacheStatistics() {
+  auto& cache = resolutionCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.statistics = ResolutionCacheStatistics();
+};
+
+namespace {
+  AltaCore::Filesystem::Path resolveUncached(std::string importRequest, AltaCore::Filesystem::Path relativeTo) {
+    using namespace AltaCore::Filesystem;
+    using namespace AltaCore::Modules;
+
+    relativeTo = relativeTo.normalize();
+    auto origRelativeTo = relativeTo;
+    auto importPath = Path(importRequest, std::string(1, '/'));
+
+    if (importPath.componentCount() > 0 && !importPath.isAbsolute() && importPath.component(0) == "@internal@") {
+      importPath.shift();
+      importPath = standardLibraryPath / "_internal" / importPath;
     }
-    // try the priority search paths
-    for (auto& path: prioritySearchPaths) {
-      auto maybePath = path / importPath;
-      if (maybePath.exists()) {
-        if (maybePath.isDirectory()) {
-          auto info = getInfo(maybePath);
-          if (info.main.isValid()) {
-            maybePath = info.main;
-          } else {
-            continue;
-          }
-        }
-        return maybePath.normalize();
-      } else if ((maybePath = maybePath + ".alta").exists()) {
-        return maybePath.normalize();
+
+    if (importPath.extname() == "alta") {
+      // resolve locally
+      if (!relativeTo.isDirectory()) {
+        relativeTo = relativeTo.dirname();
       }
-    }
-    // try resolving it in a package
-    while (!relativeTo.isRoot()) {
-      auto modFilePath = (relativeTo / "alta-packages" / importPath).normalize();
-      if (modFilePath.exists()) {
-        return modFilePath;
+      auto truePath = importPath.absolutify(relativeTo);
+      if (truePath.exists()) {
+        return truePath;
       }
-      relativeTo.pop();
-    }
-    // try the regular search paths
-    for (auto& path: searchPaths) {
-      auto maybePath = path / importPath;
-      if (maybePath.exists()) {
-        if (maybePath.isDirectory()) {
-          auto info = getInfo(maybePath);
-          if (info.main.isValid()) {
-            maybePath = info.main;
-          } else {
-            continue;
+      // try the priority search paths
+      for (auto& path: prioritySearchPaths) {
+        auto maybePath = path / importPath;
+        if (maybePath.exists()) {
+          if (maybePath.isDirectory()) {
+            auto info = getInfo(maybePath);
+            if (info.main.isValid()) {
+              maybePath = info.main;
+            } else {
+              continue;
+            }
           }
+          return maybePath.normalize();
+        } else if ((maybePath = maybePath + ".alta").exists()) {
+          return maybePath.normalize();
         }
-        return maybePath.normalize();
-      } else if ((maybePath = maybePath + ".alta").exists()) {
-        return maybePath.normalize();
       }
-    }
-  } else if (importPath.components.size() > 1 && (importPath.components[0] == "." || importPath.components[0] == "..")) {
-    // resolve locally
-    if (!relativeTo.isDirectory()) {
-      relativeTo = relativeTo.dirname();
-    }
-    auto truePath = importPath.absolutify(relativeTo);
-    if (truePath.exists() && truePath.isDirectory()) {
-      try {
-        auto info = getInfo(truePath);
-        if (info.root == truePath) {
-          if (info.main.isValid()) {
-            return info.main;
-          }
-        }
-        if ((truePath / "main.alta").exists()) {
-          return truePath / "main.alta";
-        }
-      } catch (PackageInformationNotFoundError e) {
-        if ((truePath / "main.alta").exists()) {
-          return truePath / "main.alta";
+      // try resolving it in a package
+      while (!relativeTo.isRoot()) {
+        auto modFilePath = (relativeTo / "alta-packages" / importPath).normalize();
+        if (modFilePath.exists()) {
+          return modFilePath;
         }
+        relativeTo.pop();
       }
-    } else if (truePath.exists()) {
-      return truePath;
-    } else if ((truePath + ".alta").exists()) {
-      return truePath + ".alta";
-    }
-  } else {
-    // try the priority search paths (they're the most important)
-    for (auto& path: prioritySearchPaths) {
-      auto maybePath = path / importPath;
-      if (maybePath.exists()) {
-        if (maybePath.isDirectory()) {
-          try {
+      // try the regular search paths
+      for (auto& path: searchPaths) {
+        auto maybePath = path / importPath;
+        if (maybePath.exists()) {
+          if (maybePath.isDirectory()) {
             auto info = getInfo(maybePath);
-            if (info.root == maybePath) {
-              if (info.main.isValid()) {
-                maybePath = info.main;
-              }
-            }
-            if ((maybePath / "main.alta").exists()) {
-              maybePath = maybePath / "main.alta";
-            } else {
-              continue;
-            }
-          } catch (PackageInformationNotFoundError e) {
-            if ((maybePath / "main.alta").exists()) {
-              maybePath = maybePath / "main.alta";
+            if (info.main.isValid()) {
+              maybePath = info.main;
             } else {
               continue;
             }
           }
+          return maybePath.normalize();
+        } else if ((maybePath = maybePath + ".alta").exists()) {
+          return maybePath.normalize();
         }
-        return maybePath.normalize();
-      } else if ((maybePath = maybePath + ".alta").exists()) {
-        return maybePath.normalize();
       }
-    }
-    // try stdlib next (it has the next highest precedence)
-    auto stdlibResolved = importPath.absolutify(standardLibraryPath);
-    if (stdlibResolved.exists()) {
-      auto info = getInfo(stdlibResolved); // stdlibResolved should be a package path, not a module path
-      if (info.main) {
-        return info.main;
+    } else if (importPath.componentCount() > 1 && (importPath.component(0) == "." || importPath.component(0) == "..")) {
+      // resolve locally
+      if (!relativeTo.isDirectory()) {
+        relativeTo = relativeTo.dirname();
       }
-      // welp, this shouldn't ever happen. but just in case...
-      return stdlibResolved / "main.alta";
-    } else if ((stdlibResolved = stdlibResolved + ".alta").exists()) {
-      return stdlibResolved;
-    } else {
-      // otherwise, try finding the module in a package
-      while (!relativeTo.isRoot()) {
-        auto modFolderPath = relativeTo / "alta-packages" / importPath;
-        if (modFolderPath.exists()) {
-          auto info = getInfo(modFolderPath);
-          if (info.root == modFolderPath) {
+      auto truePath = importPath.absolutify(relativeTo);
+      if (truePath.exists() && truePath.isDirectory()) {
+        try {
+          auto info = getInfo(truePath);
+          if (info.root == truePath) {
             if (info.main.isValid()) {
               return info.main;
             }
           }
-          if ((modFolderPath / "main.alta").exists()) {
-            return modFolderPath / "main.alta";
+          if ((truePath / "main.alta").exists()) {
+            return truePath / "main.alta";
+          }
+        } catch (PackageInformationNotFoundError e) {
+          if ((truePath / "main.alta").exists()) {
+            return truePath / "main.alta";
           }
         }
-        auto modFilePath = modFolderPath + ".alta";
-        if (modFilePath.exists()) {
-          return modFilePath;
-        }
-        relativeTo.pop();
+      } else if (truePath.exists()) {
+        return truePath;
+      } else if ((truePath + ".alta").exists()) {
+        return truePath + ".alta";
       }
-      // finally, try the regular search paths
-      for (auto& path: searchPaths) {
+    } else {
+      // try the priority search paths (they're the most important)
+      for (auto& path: prioritySearchPaths) {
         auto maybePath = path / importPath;
         if (maybePath.exists()) {
           if (maybePath.isDirectory()) {
@@ -321,8 +769,71 @@ AltaCore::Filesystem::Path AltaCore::Modules::resolve(std::string importRequest,
           return maybePath.normalize();
         }
       }
+      // try stdlib next (it has the next highest precedence)
+      auto stdlibResolved = importPath.absolutify(standardLibraryPath);
+      if (stdlibResolved.exists()) {
+        auto info = getInfo(stdlibResolved); // stdlibResolved should be a package path, not a module path
+        if (info.main) {
+          return info.main;
+        }
+        // welp, this shouldn't ever happen. but just in case...
+        return stdlibResolved / "main.alta";
+      } else if ((stdlibResolved = stdlibResolved + ".alta").exists()) {
+        return stdlibResolved;
+      } else {
+        // otherwise, try finding the module in a package
+        while (!relativeTo.isRoot()) {
+          auto modFolderPath = relativeTo / "alta-packages" / importPath;
+          if (modFolderPath.exists()) {
+            auto info = getInfo(modFolderPath);
+            if (info.root == modFolderPath) {
+              if (info.main.isValid()) {
+                return info.main;
+              }
+            }
+            if ((modFolderPath / "main.alta").exists()) {
+              return modFolderPath / "main.alta";
+            }
+          }
+          auto modFilePath = modFolderPath + ".alta";
+          if (modFilePath.exists()) {
+            return modFilePath;
+          }
+          relativeTo.pop();
+        }
+        // finally, try the regular search paths
+        for (auto& path: searchPaths) {
+          auto maybePath = path / importPath;
+          if (maybePath.exists()) {
+            if (maybePath.isDirectory()) {
+              try {
+                auto info = getInfo(maybePath);
+                if (info.root == maybePath) {
+                  if (info.main.isValid()) {
+                    maybePath = info.main;
+                  }
+                }
+                if ((maybePath / "main.alta").exists()) {
+                  maybePath = maybePath / "main.alta";
+                } else {
+                  continue;
+                }
+              } catch (PackageInformationNotFoundError e) {
+                if ((maybePath / "main.alta").exists()) {
+                  maybePath = maybePath / "main.alta";
+                } else {
+                  continue;
+                }
+              }
+            }
+            return maybePath.normalize();
+          } else if ((maybePath = maybePath + ".alta").exists()) {
+            return maybePath.normalize();
+          }
+        }
+      }
     }
-  }
 
-  throw ModuleResolutionError(origRelativeTo, importRequest);
+    throw ModuleResolutionError(origRelativeTo, importRequest);
+  };
 };
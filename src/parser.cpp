@@ -610,7 +610,7 @@ namespace AltaCore {
 
     Parser::Parser(std::vector<Token> _tokens, ALTACORE_MAP<std::string, PrepoExpression>& _definitions, Filesystem::Path _filePath):
       tokens(_tokens),
-      originalTokens(_tokens),
+      originalTokens(std::move(_tokens)),
       definitions(_definitions),
       filePath(_filePath),
       relexer(filePath)
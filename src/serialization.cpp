@@ -0,0 +1,209 @@
+#include "../include/altacore/serialization.hpp"
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <cstring>
+#include <cstdio>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <sys/types.h>
+#include <sys/stat.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+uint64_t AltaCore::Serialization::hash(const char* data, size_t size, uint64_t seed) {
+  auto result = seed;
+  for (size_t i = 0; i < size; i++) {
+    result ^= static_cast<uint8_t>(data[i]);
+    result *= 0x100000001b3ULL;
+  }
+  return result;
+};
+
+uint64_t AltaCore::Serialization::hash(const std::string& data, uint64_t seed) {
+  return hash(data.data(), data.size(), seed);
+};
+
+void AltaCore::Serialization::Writer::writeVarint(uint64_t value) {
+  while (value >= 0x80) {
+    buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<char>(value));
+};
+
+void AltaCore::Serialization::Writer::writeBool(bool value) {
+  buffer.push_back(value ? 1 : 0);
+};
+
+void AltaCore::Serialization::Writer::writeRaw(const char* data, size_t size) {
+  buffer.append(data, size);
+};
+
+void AltaCore::Serialization::Writer::writeString(const std::string& value) {
+  auto it = strings.find(value);
+  if (it != strings.end()) {
+    writeVarint(it->second + 1);
+    return;
+  }
+  auto index = strings.size();
+  strings[value] = index;
+  writeVarint(0);
+  writeVarint(value.size());
+  buffer.append(value);
+};
+
+void AltaCore::Serialization::Writer::writeStrings(const std::vector<std::string>& values) {
+  writeVarint(values.size());
+  for (auto& value: values) {
+    writeString(value);
+  }
+};
+
+AltaCore::Serialization::Reader::Reader(const char* _data, size_t _size):
+  data(_data),
+  size(_size)
+  {};
+
+void AltaCore::Serialization::Reader::ensure(size_t count) {
+  if (count > size - offset) {
+    throw FormatError("unexpected end of serialized data");
+  }
+};
+
+size_t AltaCore::Serialization::Reader::readStringIndex() {
+  auto tag = readVarint();
+  if (tag == 0) {
+    auto length = readVarint();
+    ensure(length);
+    strings.emplace_back(data + offset, length);
+    paths.push_back(nullptr);
+    offset += length;
+    return strings.size() - 1;
+  }
+  if (tag > strings.size()) {
+    throw FormatError("invalid string reference in serialized data");
+  }
+  return tag - 1;
+};
+
+bool AltaCore::Serialization::Reader::atEnd() const {
+  return offset == size;
+};
+
+uint64_t AltaCore::Serialization::Reader::readVarint() {
+  uint64_t result = 0;
+  for (size_t shift = 0; shift < 64; shift += 7) {
+    ensure(1);
+    auto byte = static_cast<uint8_t>(data[offset++]);
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return result;
+    }
+  }
+  throw FormatError("malformed integer in serialized data");
+};
+
+bool AltaCore::Serialization::Reader::readBool() {
+  ensure(1);
+  return data[offset++] != 0;
+};
+
+void AltaCore::Serialization::Reader::readRaw(char* destination, size_t count) {
+  ensure(count);
+  std::memcpy(destination, data + offset, count);
+  offset += count;
+};
+
+std::string AltaCore::Serialization::Reader::readString() {
+  return strings[readStringIndex()];
+};
+
+std::vector<std::string> AltaCore::Serialization::Reader::readStrings() {
+  std::vector<std::string> values;
+  auto count = readVarint();
+  for (uint64_t i = 0; i < count; i++) {
+    values.push_back(readString());
+  }
+  return values;
+};
+
+AltaCore::Filesystem::Path AltaCore::Serialization::Reader::readPath() {
+  auto index = readStringIndex();
+  if (!paths[index]) {
+    paths[index] = std::make_shared<Filesystem::Path>(strings[index]);
+  }
+  return *paths[index];
+};
+
+bool AltaCore::Serialization::readFile(AltaCore::Filesystem::Path path, std::function<void(const char* data, size_t size)> reader) {
+  auto filePath = path.toString();
+
+#if defined(_WIN32) || defined(_WIN64)
+  std::ifstream file(filePath, std::ios::binary);
+  if (!file.is_open()) return false;
+  std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (contents.size() == 0) return false;
+  reader(contents.data(), contents.size());
+  return true;
+#else
+  auto fd = open(filePath.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat buf;
+  if (fstat(fd, &buf) != 0 || buf.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+
+  size_t size = buf.st_size;
+  auto mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) return false;
+
+  try {
+    reader(static_cast<const char*>(mapping), size);
+  } catch (...) {
+    munmap(mapping, size);
+    throw;
+  }
+
+  munmap(mapping, size);
+  return true;
+#endif
+};
+
+bool AltaCore::Serialization::writeFileAtomically(AltaCore::Filesystem::Path path, const std::string& data) {
+  auto finalPath = path.toString();
+  std::stringstream tempPath;
+  tempPath << finalPath << ".tmp" << std::hex << hash(data);
+
+  {
+    std::ofstream file(tempPath.str(), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file.write(data.data(), data.size());
+    if (!file.good()) {
+      file.close();
+      std::remove(tempPath.str().c_str());
+      return false;
+    }
+  }
+
+#if defined(_WIN32) || defined(_WIN64)
+  // `rename` won't replace an existing file on Windows
+  std::remove(finalPath.c_str());
+#endif
+  if (std::rename(tempPath.str().c_str(), finalPath.c_str()) != 0) {
+    std::remove(tempPath.str().c_str());
+    return false;
+  }
+
+  Filesystem::StatCache::invalidate(path);
+
+  return true;
+};
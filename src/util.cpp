@@ -26,107 +26,28 @@ std::weak_ptr<AltaCore::DET::Module> AltaCore::Util::getModule(const AltaCore::D
   if (scope == nullptr) {
     return std::weak_ptr<AltaCore::DET::Module>();
   }
-  if (!scope->parentModule.expired()) {
-    return scope->parentModule;
-  }
-  if (!scope->parentFunction.expired()) {
-    auto func = scope->parentFunction.lock();
-    if (!func->parentScope.expired()) {
-      return getModule(func->parentScope.lock().get());
-    }
-  }
-  if (!scope->parent.expired()) {
-    return getModule(scope->parent.lock().get());
-  }
-  if (auto ns = scope->parentNamespace.lock()) {
-    if (auto parent = ns->parentScope.lock()) {
-      return getModule(parent.get());
-    }
-  }
-  if (auto klass = scope->parentClass.lock()) {
-    if (auto parent = klass->parentScope.lock()) {
-      return getModule(parent.get());
-    }
-  }
-  return std::weak_ptr<AltaCore::DET::Module>();
+  return scope->parentChain().module;
 };
 
 std::weak_ptr<AltaCore::DET::Function> AltaCore::Util::getFunction(std::shared_ptr<const AltaCore::DET::Scope> scope) {
   if (scope == nullptr) {
     return std::weak_ptr<AltaCore::DET::Function>();
   }
-  if (!scope->parentFunction.expired()) {
-    return scope->parentFunction;
-  }
-  if (!scope->parentModule.expired()) {
-    return std::weak_ptr<AltaCore::DET::Function>();
-  }
-  if (!scope->parent.expired()) {
-    return getFunction(scope->parent.lock());
-  }
-  if (auto ns = scope->parentNamespace.lock()) {
-    if (auto parent = ns->parentScope.lock()) {
-      return getFunction(parent);
-    }
-  }
-  if (auto klass = scope->parentClass.lock()) {
-    if (auto parent = klass->parentScope.lock()) {
-      return getFunction(parent);
-    }
-  }
-  return std::weak_ptr<AltaCore::DET::Function>();
+  return scope->parentChain().function;
 };
 
 std::weak_ptr<AltaCore::DET::Class> AltaCore::Util::getClass(std::shared_ptr<const AltaCore::DET::Scope> scope) {
   if (scope == nullptr) {
     return std::weak_ptr<AltaCore::DET::Class>();
   }
-  if (!scope->parentClass.expired()) {
-    return scope->parentClass;
-  }
-  if (!scope->parentModule.expired()) {
-    return std::weak_ptr<AltaCore::DET::Class>();
-  }
-  if (!scope->parent.expired()) {
-    return getClass(scope->parent.lock());
-  }
-  if (auto ns = scope->parentNamespace.lock()) {
-    if (auto parent = ns->parentScope.lock()) {
-      return getClass(parent);
-    }
-  }
-  if (auto func = scope->parentFunction.lock()) {
-    if (auto parent = func->parentScope.lock()) {
-      return getClass(parent);
-    }
-  }
-  return std::weak_ptr<AltaCore::DET::Class>();
+  return scope->parentChain().klass;
 };
 
 std::weak_ptr<AltaCore::DET::Namespace> AltaCore::Util::getNamespace(std::shared_ptr<const AltaCore::DET::Scope> scope) {
   if (scope == nullptr) {
     return std::weak_ptr<AltaCore::DET::Namespace>();
   }
-  if (!scope->parentNamespace.expired()) {
-    return scope->parentNamespace;
-  }
-  if (!scope->parentModule.expired()) {
-    return std::weak_ptr<AltaCore::DET::Namespace>();
-  }
-  if (!scope->parent.expired()) {
-    return getNamespace(scope->parent.lock());
-  }
-  if (auto klass = scope->parentClass.lock()) {
-    if (auto parent = klass->parentScope.lock()) {
-      return getNamespace(parent);
-    }
-  }
-  if (auto func = scope->parentFunction.lock()) {
-    if (auto parent = func->parentScope.lock()) {
-      return getNamespace(parent);
-    }
-  }
-  return std::weak_ptr<AltaCore::DET::Namespace>();
+  return scope->parentChain().ns;
 };
 
 std::weak_ptr<AltaCore::DET::Namespace> AltaCore::Util::getEnum(std::shared_ptr<const AltaCore::DET::Scope> scope) {
@@ -0,0 +1,495 @@
+#include "../include/altacore/visitor.hpp"
+#include "../include/altacore/ast.hpp"
+#include "../include/altacore/detail-handles.hpp"
+
+namespace {
+  template<typename NodeT>
+  class ChildList {
+    public:
+      std::vector<std::shared_ptr<NodeT>> list;
+
+      template<typename T>
+      void add(const std::shared_ptr<T>& child) {
+        list.push_back(child);
+      };
+      template<typename T>
+      void add(const std::vector<std::shared_ptr<T>>& children) {
+        list.insert(list.end(), children.begin(), children.end());
+      };
+  };
+};
+
+#define AC_CHILDREN_OF(x) case AST::NodeType::x: { auto target = std::static_pointer_cast<AST::x>(node);
+#define AC_END_CHILDREN_OF } break;
+#define AC_DH_CHILDREN_OF(x) if (auto target = std::dynamic_pointer_cast<DH::x>(node))
+
+std::vector<std::shared_ptr<AltaCore::AST::Node>> AltaCore::Visiting::ChildTraits<AltaCore::AST::Node>::children(std::shared_ptr<AltaCore::AST::Node> node) {
+  ChildList<AST::Node> children;
+
+  if (!node) return children.list;
+
+  switch (node->nodeType()) {
+    AC_CHILDREN_OF(RootNode)
+      children.add(target->statements);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(BlockNode)
+      children.add(target->statements);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ExpressionStatement)
+      children.add(target->expression);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(Type)
+      children.add(target->returnType);
+      for (auto& [type, isVariable, name]: target->parameters) {
+        children.add(type);
+      }
+      children.add(target->lookup);
+      children.add(target->unionOf);
+      children.add(target->optionalTarget);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(Parameter)
+      children.add(target->attributes);
+      children.add(target->type);
+      children.add(target->defaultValue);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(FunctionDefinitionNode)
+      children.add(target->attributes);
+      children.add(target->generics);
+      children.add(target->parameters);
+      children.add(target->returnType);
+      children.add(target->generatorParameter);
+      children.add(target->body);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(FunctionDeclarationNode)
+      children.add(target->attributes);
+      children.add(target->parameters);
+      children.add(target->returnType);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ReturnDirectiveNode)
+      children.add(target->expression);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(VariableDefinitionExpression)
+      children.add(target->attributes);
+      children.add(target->type);
+      children.add(target->initializationExpression);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(Accessor)
+      children.add(target->attributes);
+      children.add(target->target);
+      children.add(target->genericArguments);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(Fetch)
+      children.add(target->attributes);
+      children.add(target->genericArguments);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(AssignmentExpression)
+      children.add(target->attributes);
+      children.add(target->target);
+      children.add(target->value);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(BinaryOperation)
+      children.add(target->attributes);
+      children.add(target->left);
+      children.add(target->right);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(UnaryOperation)
+      children.add(target->attributes);
+      children.add(target->target);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(FunctionCallExpression)
+      children.add(target->attributes);
+      children.add(target->target);
+      for (auto& [name, argument]: target->arguments) {
+        children.add(argument);
+      }
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(AttributeNode)
+      children.add(target->arguments);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(AttributeStatement)
+      children.add(target->attribute);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ConditionalStatement)
+      children.add(target->primaryTest);
+      children.add(target->primaryResult);
+      for (auto& [test, result]: target->alternatives) {
+        children.add(test);
+        children.add(result);
+      }
+      children.add(target->finalResult);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ConditionalExpression)
+      children.add(target->attributes);
+      children.add(target->test);
+      children.add(target->primaryResult);
+      children.add(target->secondaryResult);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ClassDefinitionNode)
+      children.add(target->attributes);
+      children.add(target->generics);
+      children.add(target->parents);
+      children.add(target->statements);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ClassMemberDefinitionStatement)
+      children.add(target->varDef);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ClassMethodDefinitionStatement)
+      children.add(target->funcDef);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ClassSpecialMethodDefinitionStatement)
+      children.add(target->attributes);
+      children.add(target->parameters);
+      children.add(target->specialType);
+      children.add(target->body);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ClassReadAccessorDefinitionStatement)
+      children.add(target->type);
+      children.add(target->body);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ClassOperatorDefinitionStatement)
+      children.add(target->argumentType);
+      children.add(target->returnType);
+      children.add(target->block);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ClassInstantiationExpression)
+      children.add(target->attributes);
+      children.add(target->target);
+      for (auto& [name, argument]: target->arguments) {
+        children.add(argument);
+      }
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(PointerExpression)
+      children.add(target->attributes);
+      children.add(target->target);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(DereferenceExpression)
+      children.add(target->attributes);
+      children.add(target->target);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(WhileLoopStatement)
+      children.add(target->test);
+      children.add(target->body);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ForLoopStatement)
+      children.add(target->initializer);
+      children.add(target->condition);
+      children.add(target->increment);
+      children.add(target->body);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(RangedForLoopStatement)
+      children.add(target->counterType);
+      children.add(target->start);
+      children.add(target->end);
+      children.add(target->body);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(CastExpression)
+      children.add(target->attributes);
+      children.add(target->target);
+      children.add(target->type);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(TypeAliasStatement)
+      children.add(target->attributes);
+      children.add(target->type);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(SubscriptExpression)
+      children.add(target->attributes);
+      children.add(target->target);
+      children.add(target->index);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(SuperClassFetch)
+      children.add(target->attributes);
+      children.add(target->fetch);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(InstanceofExpression)
+      children.add(target->attributes);
+      children.add(target->target);
+      children.add(target->type);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(SizeofOperation)
+      children.add(target->attributes);
+      children.add(target->target);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(StructureDefinitionStatement)
+      children.add(target->attributes);
+      for (auto& [type, name]: target->members) {
+        children.add(type);
+      }
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ExportStatement)
+      for (auto& [retrieval, alias]: target->localTargets) {
+        children.add(retrieval);
+      }
+      children.add(target->externalTarget);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(VariableDeclarationStatement)
+      children.add(target->attributes);
+      children.add(target->type);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(AliasStatement)
+      children.add(target->target);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(DeleteStatement)
+      children.add(target->target);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(TryCatchBlock)
+      children.add(target->tryBlock);
+      for (auto& [type, block]: target->catchBlocks) {
+        children.add(type);
+        children.add(block);
+      }
+      children.add(target->catchAllBlock);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(ThrowStatement)
+      children.add(target->expression);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(CodeLiteralNode)
+      children.add(target->attributes);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(BitfieldDefinitionNode)
+      children.add(target->attributes);
+      children.add(target->underlyingType);
+      for (auto& member: target->members) {
+        children.add(std::get<0>(member));
+      }
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(LambdaExpression)
+      children.add(target->attributes);
+      children.add(target->parameters);
+      children.add(target->returnType);
+      children.add(target->generatorParameter);
+      children.add(target->body);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(EnumerationDefinitionNode)
+      children.add(target->underlyingType);
+      for (auto& [name, value]: target->members) {
+        children.add(value);
+      }
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(YieldExpression)
+      children.add(target->attributes);
+      children.add(target->target);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(AssertionStatement)
+      children.add(target->test);
+    AC_END_CHILDREN_OF
+    AC_CHILDREN_OF(AwaitExpression)
+      children.add(target->attributes);
+      children.add(target->target);
+    AC_END_CHILDREN_OF
+    default: {
+      // literals, `nullptr`, `void`, special fetches, etc.
+      if (auto target = std::dynamic_pointer_cast<AST::ExpressionNode>(node)) {
+        children.add(target->attributes);
+      }
+    } break;
+  }
+
+  return children.list;
+};
+
+std::vector<std::shared_ptr<AltaCore::DH::Node>> AltaCore::Visiting::ChildTraits<AltaCore::DH::Node>::children(std::shared_ptr<AltaCore::DH::Node> node) {
+  ChildList<DH::Node> children;
+
+  if (!node) return children.list;
+
+  // detail handles don't know their own node type, so these have to be checked in order;
+  // derived classes must be checked before their bases
+
+  AC_DH_CHILDREN_OF(RootNode) {
+    children.add(target->statements);
+  } else AC_DH_CHILDREN_OF(BlockNode) {
+    children.add(target->statements);
+  } else AC_DH_CHILDREN_OF(ExpressionStatement) {
+    children.add(target->expression);
+  } else AC_DH_CHILDREN_OF(Type) {
+    children.add(target->returnType);
+    children.add(target->parameters);
+    children.add(target->lookup);
+    children.add(target->unionOf);
+    children.add(target->optionalTarget);
+  } else AC_DH_CHILDREN_OF(Parameter) {
+    children.add(target->attributes);
+    children.add(target->type);
+    children.add(target->defaultValue);
+  } else AC_DH_CHILDREN_OF(FunctionDefinitionNode) {
+    // this also covers `GenericFunctionInstantiationDefinitionNode`s
+    children.add(target->attributes);
+    children.add(target->genericDetails);
+    children.add(target->parameters);
+    children.add(target->returnType);
+    children.add(target->generatorParameter);
+    children.add(target->body);
+    children.add(target->genericInstantiations);
+  } else AC_DH_CHILDREN_OF(FunctionDeclarationNode) {
+    children.add(target->attributes);
+    children.add(target->parameters);
+    children.add(target->returnType);
+  } else AC_DH_CHILDREN_OF(ReturnDirectiveNode) {
+    children.add(target->expression);
+  } else AC_DH_CHILDREN_OF(VariableDefinitionExpression) {
+    children.add(target->attributes);
+    children.add(target->type);
+    children.add(target->initializationExpression);
+  } else AC_DH_CHILDREN_OF(Accessor) {
+    children.add(target->attributes);
+    children.add(target->target);
+    children.add(target->genericArgumentDetails);
+  } else AC_DH_CHILDREN_OF(Fetch) {
+    children.add(target->attributes);
+    children.add(target->genericArgumentDetails);
+  } else AC_DH_CHILDREN_OF(AssignmentExpression) {
+    children.add(target->attributes);
+    children.add(target->target);
+    children.add(target->value);
+  } else AC_DH_CHILDREN_OF(BinaryOperation) {
+    children.add(target->attributes);
+    children.add(target->left);
+    children.add(target->right);
+  } else AC_DH_CHILDREN_OF(UnaryOperation) {
+    children.add(target->attributes);
+    children.add(target->target);
+  } else AC_DH_CHILDREN_OF(FunctionCallExpression) {
+    children.add(target->attributes);
+    children.add(target->target);
+    children.add(target->arguments);
+  } else AC_DH_CHILDREN_OF(AttributeNode) {
+    children.add(target->arguments);
+  } else AC_DH_CHILDREN_OF(AttributeStatement) {
+    children.add(target->attribute);
+  } else AC_DH_CHILDREN_OF(ConditionalStatement) {
+    children.add(target->primaryTest);
+    children.add(target->primaryResult);
+    for (auto& [test, result]: target->alternatives) {
+      children.add(test);
+      children.add(result);
+    }
+    children.add(target->finalResult);
+  } else AC_DH_CHILDREN_OF(ConditionalExpression) {
+    children.add(target->attributes);
+    children.add(target->test);
+    children.add(target->primaryResult);
+    children.add(target->secondaryResult);
+  } else AC_DH_CHILDREN_OF(ClassDefinitionNode) {
+    // this also covers `GenericClassInstantiationDefinitionNode`s
+    children.add(target->attributes);
+    children.add(target->genericDetails);
+    children.add(target->parents);
+    children.add(target->statements);
+    children.add(target->defaultConstructorDetail);
+    children.add(target->defaultDestructorDetail);
+    children.add(target->defaultCopyConstructorDetail);
+    children.add(target->genericInstantiations);
+  } else AC_DH_CHILDREN_OF(ClassMemberDefinitionStatement) {
+    children.add(target->varDef);
+  } else AC_DH_CHILDREN_OF(ClassMethodDefinitionStatement) {
+    children.add(target->funcDef);
+  } else AC_DH_CHILDREN_OF(ClassSpecialMethodDefinitionStatement) {
+    children.add(target->attributes);
+    children.add(target->parameters);
+    children.add(target->specialType);
+    children.add(target->body);
+  } else AC_DH_CHILDREN_OF(ClassReadAccessorDefinitionStatement) {
+    children.add(target->type);
+    children.add(target->body);
+  } else AC_DH_CHILDREN_OF(ClassOperatorDefinitionStatement) {
+    children.add(target->argumentType);
+    children.add(target->returnType);
+    children.add(target->block);
+  } else AC_DH_CHILDREN_OF(ClassInstantiationExpression) {
+    children.add(target->attributes);
+    children.add(target->target);
+    children.add(target->arguments);
+  } else AC_DH_CHILDREN_OF(PointerExpression) {
+    children.add(target->attributes);
+    children.add(target->target);
+  } else AC_DH_CHILDREN_OF(DereferenceExpression) {
+    children.add(target->attributes);
+    children.add(target->target);
+  } else AC_DH_CHILDREN_OF(WhileLoopStatement) {
+    children.add(target->test);
+    children.add(target->body);
+  } else AC_DH_CHILDREN_OF(ForLoopStatement) {
+    children.add(target->initializer);
+    children.add(target->condition);
+    children.add(target->increment);
+    children.add(target->body);
+  } else AC_DH_CHILDREN_OF(RangedForLoopStatement) {
+    children.add(target->counterType);
+    children.add(target->start);
+    children.add(target->end);
+    children.add(target->body);
+  } else AC_DH_CHILDREN_OF(CastExpression) {
+    children.add(target->attributes);
+    children.add(target->target);
+    children.add(target->type);
+  } else AC_DH_CHILDREN_OF(TypeAliasStatement) {
+    children.add(target->attributes);
+    children.add(target->type);
+  } else AC_DH_CHILDREN_OF(SubscriptExpression) {
+    children.add(target->attributes);
+    children.add(target->target);
+    children.add(target->index);
+  } else AC_DH_CHILDREN_OF(InstanceofExpression) {
+    children.add(target->attributes);
+    children.add(target->target);
+    children.add(target->type);
+  } else AC_DH_CHILDREN_OF(SizeofOperation) {
+    children.add(target->attributes);
+    children.add(target->target);
+  } else AC_DH_CHILDREN_OF(StructureDefinitionStatement) {
+    children.add(target->attributes);
+    children.add(target->memberTypes);
+  } else AC_DH_CHILDREN_OF(ExportStatement) {
+    children.add(target->localTargets);
+    children.add(target->externalTarget);
+  } else AC_DH_CHILDREN_OF(VariableDeclarationStatement) {
+    children.add(target->attributes);
+    children.add(target->type);
+  } else AC_DH_CHILDREN_OF(AliasStatement) {
+    children.add(target->target);
+  } else AC_DH_CHILDREN_OF(DeleteStatement) {
+    children.add(target->target);
+  } else AC_DH_CHILDREN_OF(TryCatchBlock) {
+    children.add(target->tryBlock);
+    for (auto& [type, block]: target->catchBlocks) {
+      children.add(type);
+      children.add(block);
+    }
+    children.add(target->catchAllBlock);
+  } else AC_DH_CHILDREN_OF(ThrowStatement) {
+    children.add(target->expression);
+  } else AC_DH_CHILDREN_OF(CodeLiteralNode) {
+    children.add(target->attributes);
+  } else AC_DH_CHILDREN_OF(BitfieldDefinitionNode) {
+    children.add(target->attributes);
+    children.add(target->underlyingType);
+    children.add(target->memberTypes);
+  } else AC_DH_CHILDREN_OF(LambdaExpression) {
+    children.add(target->attributes);
+    children.add(target->parameters);
+    children.add(target->returnType);
+    children.add(target->generatorParameter);
+    children.add(target->body);
+  } else AC_DH_CHILDREN_OF(EnumerationDefinitionNode) {
+    children.add(target->underlyingType);
+    for (auto& [name, value]: target->memberDetails) {
+      children.add(value);
+    }
+  } else AC_DH_CHILDREN_OF(YieldExpression) {
+    children.add(target->attributes);
+    children.add(target->target);
+  } else AC_DH_CHILDREN_OF(AssertionStatement) {
+    children.add(target->test);
+  } else AC_DH_CHILDREN_OF(AwaitExpression) {
+    children.add(target->attributes);
+    children.add(target->target);
+  } else AC_DH_CHILDREN_OF(ExpressionNode) {
+    children.add(target->attributes);
+  }
+
+  return children.list;
+};
+
+#undef AC_CHILDREN_OF
+#undef AC_END_CHILDREN_OF
+#undef AC_DH_CHILDREN_OF